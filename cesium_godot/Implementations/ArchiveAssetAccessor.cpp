@@ -0,0 +1,145 @@
+#include "ArchiveAssetAccessor.h"
+#include "LocalAssetAccesor.h"
+#include "../Models/LocalAssetResponse.h"
+#include "../Models/LocalAssetRequest.h"
+#include "CesiumAsync/AsyncSystem.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using FutureResult_t = std::shared_ptr<CesiumAsync::IAssetRequest>;
+
+constexpr uint16_t ARCHIVE_OK_STATUS = 200;
+constexpr uint16_t ARCHIVE_NOT_FOUND_STATUS = 404;
+constexpr uint16_t ARCHIVE_CORRUPT_ENTRY_STATUS = 500;
+
+namespace {
+	int32_t hex_value(char c)
+	{
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+
+	std::string percent_decode(std::string_view text)
+	{
+		std::string result;
+		result.reserve(text.size());
+		for (size_t i = 0; i < text.size(); i++) {
+			if (text[i] == '%' && i + 2 < text.size() && hex_value(text[i + 1]) >= 0 && hex_value(text[i + 2]) >= 0) {
+				result.push_back(static_cast<char>(hex_value(text[i + 1]) * 16 + hex_value(text[i + 2])));
+				i += 2;
+				continue;
+			}
+			result.push_back(text[i]);
+		}
+		return result;
+	}
+
+	/// @brief Only what would otherwise end or break the path, cesium's URI parser normalizes the rest
+	std::string percent_encode_path(std::string_view path)
+	{
+		constexpr char hexDigits[] = "0123456789ABCDEF";
+		std::string result;
+		result.reserve(path.size());
+		for (const char c : path) {
+			const unsigned char byte = static_cast<unsigned char>(c);
+			if (byte <= 0x20 || byte >= 0x7F || c == '%' || c == '?' || c == '#') {
+				result.push_back('%');
+				result.push_back(hexDigits[byte >> 4]);
+				result.push_back(hexDigits[byte & 0xF]);
+				continue;
+			}
+			result.push_back(c);
+		}
+		return result;
+	}
+
+	std::shared_ptr<CesiumAsync::IAssetRequest> make_request(const std::string& url, std::unique_ptr<LocalAssetResponse> response)
+	{
+		return std::make_shared<LocalAssetRequest>("GET", url, CesiumAsync::HttpHeaders{}, std::move(response));
+	}
+
+	CesiumAsync::HttpHeaders make_headers(const std::string& contentType)
+	{
+		CesiumAsync::HttpHeaders headers;
+		headers.insert({ "content-type", contentType });
+		return headers;
+	}
+}
+
+ArchiveAssetAccessor::ArchiveAssetAccessor(std::shared_ptr<const CesiumTileArchive> archive, const std::string& archivePath)
+	: m_archive{ std::move(archive) }
+{
+	std::string path = archivePath;
+	std::replace(path.begin(), path.end(), '\\', '/');
+	// Windows paths (C:/...) need the slash an absolute POSIX path already starts with
+	this->m_baseUrl = "file://" + std::string(path.starts_with("/") ? "" : "/") + path + "/";
+}
+
+std::string ArchiveAssetAccessor::get_root_url() const
+{
+	const std::string rootDocument = this->m_archive->find_root_document();
+	if (rootDocument.empty()) return std::string();
+	return percent_encode_path(this->m_baseUrl + rootDocument);
+}
+
+bool ArchiveAssetAccessor::contains_url(const std::string& url) const
+{
+	return !this->to_entry_path(url).empty();
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> ArchiveAssetAccessor::get(const CesiumAsync::AsyncSystem& asyncSystem, const std::string& url, const std::vector<THeader>& headers /*= {}*/)
+{
+	const std::string entryPath = this->to_entry_path(url);
+	const CesiumTileArchive::Entry_t* entry = entryPath.empty() ? nullptr : this->m_archive->find(entryPath);
+	if (entry == nullptr) {
+		// A missing file is a 404 like on a server, implicit tilesets probe for subtrees that may not exist
+		auto response = std::make_unique<LocalAssetResponse>(ARCHIVE_NOT_FOUND_STATUS, "text/plain", make_headers("text/plain"), PackedByteArray());
+		return asyncSystem.createResolvedFuture<FutureResult_t>(make_request(url, std::move(response)));
+	}
+
+	const std::string contentType = LocalAssetAccessor::get_content_type(entryPath);
+	if (entry->method == CesiumTileArchive::CompressionMethod::Stored) {
+		const std::span<const std::byte> bytes = this->m_archive->get_raw_bytes(*entry);
+		if (bytes.size() == entry->uncompressedSize) {
+			auto response = std::make_unique<LocalAssetResponse>(ARCHIVE_OK_STATUS, contentType, make_headers(contentType), this->m_archive->get_mapped_file(), bytes);
+			return asyncSystem.createResolvedFuture<FutureResult_t>(make_request(url, std::move(response)));
+		}
+	}
+
+	// Entries are immutable once the archive is open, any number of them can be inflated at the same time
+	return asyncSystem.runInWorkerThread([archive = this->m_archive, entry, url, contentType]() -> FutureResult_t {
+		PackedByteArray data;
+		if (!archive->extract(*entry, &data)) {
+			// Corrupt data or an unsupported compression method, cesium reports the tile as failed like any server error
+			auto response = std::make_unique<LocalAssetResponse>(ARCHIVE_CORRUPT_ENTRY_STATUS, "text/plain", make_headers("text/plain"), PackedByteArray());
+			return make_request(url, std::move(response));
+		}
+		auto response = std::make_unique<LocalAssetResponse>(ARCHIVE_OK_STATUS, contentType, make_headers(contentType), data);
+		return make_request(url, std::move(response));
+	});
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> ArchiveAssetAccessor::request(const CesiumAsync::AsyncSystem& asyncSystem, const std::string& verb, const std::string& url, const std::vector<THeader>& headers /*= std::vector<THeader>()*/, const std::span<const std::byte>& contentPayload /*= {}*/)
+{
+	if (verb == "GET") {
+		return this->get(asyncSystem, url, headers);
+	}
+	CesiumAsync::Promise<FutureResult_t> promise = asyncSystem.createPromise<FutureResult_t>();
+	promise.reject(std::runtime_error("Archives only support GET requests, got " + verb));
+	return promise.getFuture();
+}
+
+void ArchiveAssetAccessor::tick() noexcept
+{
+}
+
+std::string ArchiveAssetAccessor::to_entry_path(const std::string& url) const
+{
+	// Query and fragment go before decoding, an encoded '?' belongs to the file name
+	const std::string path = percent_decode(std::string_view(url).substr(0, url.find_first_of("?#")));
+	if (!path.starts_with(this->m_baseUrl)) return std::string();
+	return path.substr(this->m_baseUrl.size());
+}
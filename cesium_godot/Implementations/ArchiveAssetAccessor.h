@@ -0,0 +1,51 @@
+#ifndef ARCHIVE_ASSET_ACCESSOR_H
+#define ARCHIVE_ASSET_ACCESSOR_H
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include "../Utils/CesiumTileArchive.h"
+#include <memory>
+#include <string>
+
+/**
+ * @brief Serves a tileset packed in a 3TZ / zip archive
+ * The archive is exposed as a folder under file:// (file:///data/city.3tz/tileset.json), so cesium resolves relative
+ * content URIs the usual way and tile URLs stay unique across archives. Stored entries are returned as views over the
+ * mapped archive without leaving the calling thread, compressed ones are inflated on a worker thread
+ */
+class ArchiveAssetAccessor final : public CesiumAsync::IAssetAccessor {
+public:
+	/// @brief archivePath is an OS path, the archive has to be open already
+	ArchiveAssetAccessor(std::shared_ptr<const CesiumTileArchive> archive, const std::string& archivePath);
+
+	/// @brief URL of the archive's root tileset.json / layer.json, empty when it has none
+	std::string get_root_url() const;
+
+	/// @brief Whether the URL points inside the archive, entries missing from it included
+	bool contains_url(const std::string& url) const;
+
+	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+		get(const CesiumAsync::AsyncSystem& asyncSystem,
+			const std::string& url,
+			const std::vector<THeader>& headers = {}) override;
+
+	/// @brief Only GET means something for an archive
+	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+		const CesiumAsync::AsyncSystem& asyncSystem,
+		const std::string& verb,
+		const std::string& url,
+		const std::vector<THeader>& headers = std::vector<THeader>(),
+		const std::span<const std::byte>& contentPayload = {}) override;
+
+	void tick() noexcept override;
+
+private:
+	/// @brief Path of the URL inside the archive, empty when the URL points somewhere else
+	std::string to_entry_path(const std::string& url) const;
+
+	std::shared_ptr<const CesiumTileArchive> m_archive;
+
+	/// @brief file:// URL of the archive itself followed by a slash, percent decoded
+	std::string m_baseUrl;
+};
+
+#endif // !ARCHIVE_ASSET_ACCESSOR_H
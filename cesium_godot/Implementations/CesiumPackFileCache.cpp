@@ -0,0 +1,549 @@
+#include "CesiumPackFileCache.h"
+#include "CesiumSqliteCache.h"
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/variant/string.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "core/error/error_macros.h"
+#endif
+
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+constexpr uint32_t RECORD_MAGIC = 0x4B504352; // "RCPK"
+constexpr uint32_t INDEX_MAGIC = 0x49504352; // "RCPI"
+constexpr uint32_t INDEX_VERSION = 1;
+// Records written since the last save are recovered by scanning, this only bounds how much has to be scanned after a crash
+constexpr uint32_t INDEX_SAVE_INTERVAL = 256;
+// Small packs are not worth rewriting, whatever their dead share
+constexpr uint64_t MIN_COMPACTION_BYTES = 16ull * 1024ull * 1024ull;
+
+namespace {
+	struct RecordHeader_t {
+		uint32_t magic;
+		uint32_t crc;
+		uint32_t keySize;
+		uint32_t urlSize;
+		uint32_t methodSize;
+		uint32_t requestHeadersSize;
+		uint32_t responseHeadersSize;
+		uint16_t statusCode;
+		uint16_t reserved;
+		int64_t expiryTime;
+		uint64_t dataSize;
+	};
+	static_assert(sizeof(RecordHeader_t) == 48, "Pack records are read straight from the mapping, the layout must not be padded");
+
+	struct IndexHeader_t {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t packSize;
+		uint64_t entryCount;
+		uint64_t accessClock;
+		uint32_t bodyCrc;
+		uint32_t reserved;
+	};
+	static_assert(sizeof(IndexHeader_t) == 40, "The index header is written as is");
+
+	struct RecordView_t {
+		RecordHeader_t header;
+		std::string_view key;
+		std::string_view url;
+		std::string_view method;
+		std::span<const std::byte> requestHeaders;
+		std::span<const std::byte> responseHeaders;
+		std::span<const std::byte> data;
+		uint64_t totalSize;
+	};
+
+	uint32_t update_crc(uint32_t crc, const void* data, size_t size)
+	{
+		// zlib takes 32 bit lengths, bodies can be larger
+		const auto* bytes = static_cast<const Bytef*>(data);
+		while (size > 0) {
+			const uInt chunk = static_cast<uInt>(std::min<size_t>(size, 1u << 30));
+			crc = static_cast<uint32_t>(crc32(crc, bytes, chunk));
+			bytes += chunk;
+			size -= chunk;
+		}
+		return crc;
+	}
+
+	uint32_t compute_record_crc(RecordHeader_t header, const std::byte* payload, size_t payloadSize)
+	{
+		header.crc = 0;
+		uint32_t crc = update_crc(static_cast<uint32_t>(crc32(0L, Z_NULL, 0)), &header, sizeof(header));
+		return update_crc(crc, payload, payloadSize);
+	}
+
+	bool parse_record(std::span<const std::byte> pack, uint64_t offset, bool verifyCrc, RecordView_t* out)
+	{
+		if (offset > pack.size() || pack.size() - offset < sizeof(RecordHeader_t)) return false;
+		RecordHeader_t header;
+		memcpy(&header, pack.data() + offset, sizeof(header));
+		if (header.magic != RECORD_MAGIC) return false;
+
+		const uint64_t payloadSize = static_cast<uint64_t>(header.keySize) + header.urlSize + header.methodSize +
+			header.requestHeadersSize + header.responseHeadersSize + header.dataSize;
+		if (header.dataSize > pack.size() || payloadSize > pack.size() - offset - sizeof(RecordHeader_t)) return false;
+
+		const std::byte* payload = pack.data() + offset + sizeof(RecordHeader_t);
+		if (verifyCrc && compute_record_crc(header, payload, payloadSize) != header.crc) return false;
+
+		const std::byte* cursor = payload;
+		auto take = [&cursor](uint64_t size) {
+			std::span<const std::byte> part(cursor, static_cast<size_t>(size));
+			cursor += size;
+			return part;
+		};
+		auto asText = [](std::span<const std::byte> part) {
+			return std::string_view(reinterpret_cast<const char*>(part.data()), part.size());
+		};
+		out->header = header;
+		out->key = asText(take(header.keySize));
+		out->url = asText(take(header.urlSize));
+		out->method = asText(take(header.methodSize));
+		out->requestHeaders = take(header.requestHeadersSize);
+		out->responseHeaders = take(header.responseHeadersSize);
+		out->data = take(header.dataSize);
+		out->totalSize = sizeof(RecordHeader_t) + payloadSize;
+		return true;
+	}
+
+	bool seek_to(std::FILE* file, uint64_t offset)
+	{
+#ifdef _WIN32
+		return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+		return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+	}
+
+	std::filesystem::path to_filesystem_path(const std::string& utf8Path)
+	{
+		return std::filesystem::path(std::u8string(utf8Path.begin(), utf8Path.end()));
+	}
+
+	std::FILE* open_file(const std::filesystem::path& path, const char* mode)
+	{
+#ifdef _WIN32
+		// fopen reads the name in the ANSI code page
+		const std::wstring wideMode(mode, mode + strlen(mode));
+		return _wfopen(path.c_str(), wideMode.c_str());
+#else
+		return std::fopen(path.c_str(), mode);
+#endif
+	}
+
+	template<class T>
+	void append_value(std::string& buffer, const T& value)
+	{
+		buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template<class T>
+	bool read_value(const std::string& buffer, size_t* cursor, T* out)
+	{
+		if (buffer.size() - *cursor < sizeof(T)) return false;
+		memcpy(out, buffer.data() + *cursor, sizeof(T));
+		*cursor += sizeof(T);
+		return true;
+	}
+}
+
+CesiumPackFileCache::CesiumPackFileCache(const CesiumPackFileCacheOptions_t& options) : m_options(options)
+{
+	this->m_packPath = to_filesystem_path(options.path);
+	this->m_indexPath = std::filesystem::path(this->m_packPath).replace_extension(".idx");
+	std::unique_lock lock(this->m_mutex);
+	if (!this->open_pack()) {
+		ERR_PRINT(String("Could not open the tile pack at ") + String(options.path.c_str()));
+	}
+}
+
+CesiumPackFileCache::~CesiumPackFileCache()
+{
+	std::unique_lock lock(this->m_mutex);
+	if (this->m_appendFile != nullptr) {
+		this->save_index();
+	}
+	this->close_pack();
+}
+
+std::shared_ptr<CesiumPackFileCache> CesiumPackFileCache::get_shared(const CesiumPackFileCacheOptions_t& options)
+{
+	std::string key = options.path;
+	std::replace(key.begin(), key.end(), '\\', '/');
+
+	std::scoped_lock lock(s_sharedMutex);
+	SharedPack_t& shared = s_sharedPacks[key];
+	if (shared.cache == nullptr) {
+		shared.cache = new CesiumPackFileCache(options);
+	}
+	shared.users++;
+	// Every handle counts as one user, the last one saves the index and closes the pack while no other caller can open it
+	return std::shared_ptr<CesiumPackFileCache>(shared.cache, [key](CesiumPackFileCache* cache) {
+		std::scoped_lock releaseLock(s_sharedMutex);
+		auto it = s_sharedPacks.find(key);
+		if (it == s_sharedPacks.end() || --it->second.users > 0) return;
+		s_sharedPacks.erase(it);
+		delete cache;
+	});
+}
+
+std::optional<CesiumAsync::CacheItem> CesiumPackFileCache::getEntry(const std::string& key) const
+{
+	std::shared_lock lock(this->m_mutex);
+	auto it = this->m_index.find(key);
+	if (it == this->m_index.end()) return std::nullopt;
+
+	// Stored after the pack was last mapped, map it again to see the new tail
+	if (it->second.offset + it->second.size > this->m_mapping.size()) {
+		lock.unlock();
+		{
+			std::unique_lock writeLock(this->m_mutex);
+			if (this->m_mapping.size() < this->m_packSize) {
+				this->m_mapping.open(this->m_options.path);
+			}
+		}
+		lock.lock();
+		it = this->m_index.find(key);
+		if (it == this->m_index.end() || it->second.offset + it->second.size > this->m_mapping.size()) return std::nullopt;
+	}
+
+	RecordView_t record;
+	if (!parse_record(this->m_mapping.get_bytes(), it->second.offset, false, &record) || record.key != key) {
+		return std::nullopt;
+	}
+	it->second.lastAccess = ++this->m_accessClock;
+
+	return CesiumAsync::CacheItem(
+		static_cast<std::time_t>(record.header.expiryTime),
+		CesiumAsync::CacheRequest(
+			CesiumSqliteCache::deserialize_headers(record.requestHeaders.data(), static_cast<int>(record.requestHeaders.size())),
+			std::string(record.method),
+			std::string(record.url)),
+		CesiumAsync::CacheResponse(
+			record.header.statusCode,
+			CesiumSqliteCache::deserialize_headers(record.responseHeaders.data(), static_cast<int>(record.responseHeaders.size())),
+			std::vector<std::byte>(record.data.begin(), record.data.end())));
+}
+
+bool CesiumPackFileCache::storeEntry(
+	const std::string& key,
+	std::time_t expiryTime,
+	const std::string& url,
+	const std::string& requestMethod,
+	const CesiumAsync::HttpHeaders& requestHeaders,
+	uint16_t statusCode,
+	const CesiumAsync::HttpHeaders& responseHeaders,
+	const std::span<const std::byte>& responseData)
+{
+	// Everything but the body is small, assemble it up front and keep the exclusive section to the writes
+	const std::string encodedRequestHeaders = CesiumSqliteCache::serialize_headers(requestHeaders);
+	const std::string encodedResponseHeaders = CesiumSqliteCache::serialize_headers(responseHeaders);
+	std::string prefix;
+	prefix.reserve(key.size() + url.size() + requestMethod.size() + encodedRequestHeaders.size() + encodedResponseHeaders.size());
+	prefix += key;
+	prefix += url;
+	prefix += requestMethod;
+	prefix += encodedRequestHeaders;
+	prefix += encodedResponseHeaders;
+
+	RecordHeader_t header{};
+	header.magic = RECORD_MAGIC;
+	header.keySize = static_cast<uint32_t>(key.size());
+	header.urlSize = static_cast<uint32_t>(url.size());
+	header.methodSize = static_cast<uint32_t>(requestMethod.size());
+	header.requestHeadersSize = static_cast<uint32_t>(encodedRequestHeaders.size());
+	header.responseHeadersSize = static_cast<uint32_t>(encodedResponseHeaders.size());
+	header.statusCode = statusCode;
+	header.expiryTime = static_cast<int64_t>(expiryTime);
+	header.dataSize = responseData.size();
+	// Same CRC as compute_record_crc, continued over the body instead of copying it next to the prefix
+	uint32_t crc = compute_record_crc(header, reinterpret_cast<const std::byte*>(prefix.data()), prefix.size());
+	header.crc = update_crc(crc, responseData.data(), responseData.size());
+	const uint64_t recordSize = sizeof(RecordHeader_t) + prefix.size() + responseData.size();
+
+	std::unique_lock lock(this->m_mutex);
+	if (this->m_appendFile == nullptr) return false;
+
+	// Writes start at the end of the last valid record, a previous failed write is simply overwritten
+	const uint64_t offset = this->m_packSize;
+	const bool written = seek_to(this->m_appendFile, offset) &&
+		std::fwrite(&header, sizeof(header), 1, this->m_appendFile) == 1 &&
+		std::fwrite(prefix.data(), 1, prefix.size(), this->m_appendFile) == prefix.size() &&
+		std::fwrite(responseData.data(), 1, responseData.size(), this->m_appendFile) == responseData.size() &&
+		std::fflush(this->m_appendFile) == 0;
+	if (!written) {
+		ERR_PRINT(String("Could not append ") + String(url.c_str()) + String(" to the tile pack"));
+		return false;
+	}
+
+	this->insert_locked(key, offset, recordSize, ++this->m_accessClock);
+	this->m_packSize += recordSize;
+	if (++this->m_writesSinceIndexSave >= INDEX_SAVE_INTERVAL) {
+		this->save_index();
+	}
+	return true;
+}
+
+bool CesiumPackFileCache::prune()
+{
+	std::unique_lock lock(this->m_mutex);
+	if (this->m_appendFile == nullptr) return false;
+	this->evict_locked(this->m_options.maxItems, this->m_options.maxBytes);
+
+	const uint64_t deadBytes = this->m_packSize - this->m_liveBytes;
+	if (this->m_packSize >= MIN_COMPACTION_BYTES && static_cast<double>(deadBytes) > static_cast<double>(this->m_packSize) * this->m_options.compactionRatio) {
+		return this->compact_locked();
+	}
+	return this->save_index();
+}
+
+bool CesiumPackFileCache::clearAll()
+{
+	std::unique_lock lock(this->m_mutex);
+	this->close_pack();
+	std::error_code error;
+	std::filesystem::resize_file(this->m_packPath, 0, error);
+	this->m_index.clear();
+	this->m_packSize = 0;
+	this->m_liveBytes = 0;
+	if (error || !this->open_pack()) return false;
+	return this->save_index();
+}
+
+bool CesiumPackFileCache::compact()
+{
+	std::unique_lock lock(this->m_mutex);
+	if (this->m_appendFile == nullptr) return false;
+	return this->compact_locked();
+}
+
+bool CesiumPackFileCache::load_index()
+{
+	this->m_index.clear();
+	this->m_liveBytes = 0;
+	this->m_packSize = 0;
+
+	std::ifstream file(this->m_indexPath, std::ios::binary);
+	std::string buffer;
+	if (file) {
+		buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	size_t cursor = 0;
+	IndexHeader_t header{};
+	const bool headerValid = read_value(buffer, &cursor, &header) &&
+		header.magic == INDEX_MAGIC &&
+		header.version == INDEX_VERSION &&
+		header.packSize <= this->m_mapping.size() &&
+		update_crc(static_cast<uint32_t>(crc32(0L, Z_NULL, 0)), buffer.data() + cursor, buffer.size() - cursor) == header.bodyCrc;
+	if (!headerValid) {
+		// Missing, stale or torn index, everything can be found again from the records themselves
+		this->recover_tail(0);
+		return false;
+	}
+
+	for (uint64_t i = 0; i < header.entryCount; i++) {
+		uint32_t keySize = 0;
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint64_t lastAccess = 0;
+		if (!read_value(buffer, &cursor, &keySize) || buffer.size() - cursor < keySize) break;
+		std::string key = buffer.substr(cursor, keySize);
+		cursor += keySize;
+		if (!read_value(buffer, &cursor, &offset) || !read_value(buffer, &cursor, &size) || !read_value(buffer, &cursor, &lastAccess)) break;
+		if (offset + size > header.packSize) continue;
+		this->insert_locked(key, offset, size, lastAccess);
+	}
+	this->m_accessClock = header.accessClock;
+	this->m_packSize = header.packSize;
+	this->recover_tail(header.packSize);
+	return true;
+}
+
+void CesiumPackFileCache::recover_tail(uint64_t offset)
+{
+	const std::span<const std::byte> pack = this->m_mapping.get_bytes();
+	RecordView_t record;
+	while (parse_record(pack, offset, true, &record)) {
+		this->insert_locked(std::string(record.key), offset, record.totalSize, ++this->m_accessClock);
+		offset += record.totalSize;
+	}
+	this->m_packSize = offset;
+
+	// A torn record at the end (crash mid write), drop it so the next record doesn't follow garbage
+	if (this->m_mapping.size() > offset) {
+		this->m_mapping.close();
+		std::error_code error;
+		std::filesystem::resize_file(this->m_packPath, offset, error);
+		this->m_mapping.open(this->m_options.path);
+	}
+}
+
+bool CesiumPackFileCache::save_index() const
+{
+	std::string body;
+	body.reserve(this->m_index.size() * 64);
+	for (const auto& [key, entry] : this->m_index) {
+		append_value(body, static_cast<uint32_t>(key.size()));
+		body += key;
+		append_value(body, entry.offset);
+		append_value(body, entry.size);
+		append_value(body, entry.lastAccess.load());
+	}
+
+	IndexHeader_t header{};
+	header.magic = INDEX_MAGIC;
+	header.version = INDEX_VERSION;
+	header.packSize = this->m_packSize;
+	header.entryCount = this->m_index.size();
+	header.accessClock = this->m_accessClock;
+	header.bodyCrc = update_crc(static_cast<uint32_t>(crc32(0L, Z_NULL, 0)), body.data(), body.size());
+
+	// Written aside and renamed over the old one, a crash leaves either index complete
+	std::filesystem::path temporaryPath = this->m_indexPath;
+	temporaryPath += ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(body.data(), static_cast<std::streamsize>(body.size()));
+		if (!file) return false;
+	}
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, this->m_indexPath, error);
+	const_cast<CesiumPackFileCache*>(this)->m_writesSinceIndexSave = 0;
+	return !error;
+}
+
+bool CesiumPackFileCache::open_pack()
+{
+	// Create the pack if needed, without touching an existing one
+	if (std::FILE* create = open_file(this->m_packPath, "ab")) {
+		std::fclose(create);
+	}
+	if (!this->m_mapping.open(this->m_options.path)) return false;
+	this->load_index();
+	this->m_appendFile = open_file(this->m_packPath, "r+b");
+	return this->m_appendFile != nullptr;
+}
+
+void CesiumPackFileCache::close_pack()
+{
+	if (this->m_appendFile != nullptr) {
+		std::fclose(this->m_appendFile);
+		this->m_appendFile = nullptr;
+	}
+	this->m_mapping.close();
+}
+
+bool CesiumPackFileCache::compact_locked()
+{
+	if (this->m_mapping.size() < this->m_packSize) {
+		this->m_mapping.open(this->m_options.path);
+	}
+	const std::span<const std::byte> pack = this->m_mapping.get_bytes();
+
+	// Keep the records in pack order, a replayed region then reads the file front to back
+	std::vector<Index_t::iterator> entries;
+	entries.reserve(this->m_index.size());
+	for (auto it = this->m_index.begin(); it != this->m_index.end(); ++it) {
+		entries.push_back(it);
+	}
+	std::sort(entries.begin(), entries.end(), [](const Index_t::iterator& a, const Index_t::iterator& b) {
+		return a->second.offset < b->second.offset;
+	});
+
+	std::filesystem::path compactPath = this->m_packPath;
+	compactPath += ".compact";
+	std::FILE* output = open_file(compactPath, "wb");
+	if (output == nullptr) return false;
+	std::vector<uint64_t> newOffsets;
+	newOffsets.reserve(entries.size());
+	uint64_t newSize = 0;
+	bool written = true;
+	for (const Index_t::iterator& it : entries) {
+		const IndexEntry_t& entry = it->second;
+		if (entry.offset + entry.size > pack.size() ||
+				std::fwrite(pack.data() + entry.offset, 1, entry.size, output) != entry.size) {
+			written = false;
+			break;
+		}
+		newOffsets.push_back(newSize);
+		newSize += entry.size;
+	}
+	written = std::fclose(output) == 0 && written;
+	if (!written) {
+		std::error_code removeError;
+		std::filesystem::remove(compactPath, removeError);
+		ERR_PRINT("Could not compact the tile pack");
+		return false;
+	}
+
+	this->close_pack();
+	std::error_code error;
+	std::filesystem::rename(compactPath, this->m_packPath, error);
+	if (error) {
+		std::error_code removeError;
+		std::filesystem::remove(compactPath, removeError);
+	}
+	else {
+		for (size_t i = 0; i < entries.size(); i++) {
+			entries[i]->second.offset = newOffsets[i];
+		}
+		this->m_packSize = newSize;
+		this->m_liveBytes = newSize;
+	}
+	// On failure the old pack and index are still valid, reopen them as they were
+	this->m_mapping.open(this->m_options.path);
+	this->m_appendFile = open_file(this->m_packPath, "r+b");
+	return !error && this->m_appendFile != nullptr && this->save_index();
+}
+
+void CesiumPackFileCache::evict_locked(uint64_t maxItems, uint64_t maxBytes)
+{
+	const bool overItems = maxItems > 0 && this->m_index.size() > maxItems;
+	const bool overBytes = maxBytes > 0 && this->m_liveBytes > maxBytes;
+	if (!overItems && !overBytes) return;
+
+	std::vector<std::pair<uint64_t, Index_t::iterator>> byAccess;
+	byAccess.reserve(this->m_index.size());
+	for (auto it = this->m_index.begin(); it != this->m_index.end(); ++it) {
+		byAccess.emplace_back(it->second.lastAccess.load(), it);
+	}
+	std::sort(byAccess.begin(), byAccess.end(), [](const auto& a, const auto& b) {
+		return a.first < b.first;
+	});
+	for (const auto& [lastAccess, it] : byAccess) {
+		const bool stillOverItems = maxItems > 0 && this->m_index.size() > maxItems;
+		const bool stillOverBytes = maxBytes > 0 && this->m_liveBytes > maxBytes;
+		if (!stillOverItems && !stillOverBytes) break;
+		this->erase_locked(it);
+	}
+}
+
+void CesiumPackFileCache::insert_locked(const std::string& key, uint64_t offset, uint64_t size, uint64_t lastAccess)
+{
+	IndexEntry_t& entry = this->m_index[key];
+	// Overwritten records stay in the pack as dead bytes until the next compaction
+	this->m_liveBytes -= entry.size;
+	entry.offset = offset;
+	entry.size = size;
+	entry.lastAccess = lastAccess;
+	this->m_liveBytes += size;
+}
+
+void CesiumPackFileCache::erase_locked(Index_t::iterator it)
+{
+	this->m_liveBytes -= it->second.size;
+	this->m_index.erase(it);
+}
@@ -0,0 +1,133 @@
+#ifndef CESIUM_PACK_FILE_CACHE_H
+#define CESIUM_PACK_FILE_CACHE_H
+
+#include "../Utils/MappedFile.h"
+#include <CesiumAsync/ICacheDatabase.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+struct CesiumPackFileCacheOptions_t {
+	/// @brief Absolute path of the pack, the index lives next to it with an .idx extension
+	std::string path;
+	/// @brief 0 removes the limit
+	uint64_t maxItems = 4096 * 5;
+	/// @brief Sum of the live records, 0 removes the limit
+	uint64_t maxBytes = 0;
+	/// @brief prune compacts the pack once this share of it is taken by overwritten or evicted records
+	double compactionRatio = 0.5;
+};
+
+/**
+ * @brief Request cache for read-mostly deployments (kiosks, simulators replaying the same region)
+ * Responses are appended to a single pack file that is read through a memory mapping, lookups go through an in-memory
+ * hash index instead of a database query. The index is saved with a checksum next to the pack, records appended after
+ * the last save are recovered by scanning the tail of the pack, each record carries its own CRC32
+ * @note ICacheDatabase hands out owning CacheItems, so a hit still copies the body once out of the mapping
+ */
+class CesiumPackFileCache final : public CesiumAsync::ICacheDatabase {
+public:
+	explicit CesiumPackFileCache(const CesiumPackFileCacheOptions_t& options);
+
+	/// @brief The cache of the pack at options.path, opened by the first caller and closed once the last one releases it
+	/// Two instances appending to the same pack would overwrite each other's records and indices, tilesets share one instead
+	/// @note The limits of the caller that opened the pack apply until it is closed
+	static std::shared_ptr<CesiumPackFileCache> get_shared(const CesiumPackFileCacheOptions_t& options);
+
+	/// @brief Saves the index
+	~CesiumPackFileCache() override;
+
+	std::optional<CesiumAsync::CacheItem> getEntry(const std::string& key) const override;
+
+	bool storeEntry(
+		const std::string& key,
+		std::time_t expiryTime,
+		const std::string& url,
+		const std::string& requestMethod,
+		const CesiumAsync::HttpHeaders& requestHeaders,
+		uint16_t statusCode,
+		const CesiumAsync::HttpHeaders& responseHeaders,
+		const std::span<const std::byte>& responseData) override;
+
+	/// @brief Evicts least recently used records past the limits and compacts the pack when enough of it is dead
+	bool prune() override;
+
+	bool clearAll() override;
+
+	/// @brief Rewrites the pack with the live records only
+	bool compact();
+
+private:
+	struct IndexEntry_t {
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		/// @brief Bumped by lookups under the shared lock
+		mutable std::atomic<uint64_t> lastAccess{ 0 };
+	};
+
+	using Index_t = std::unordered_map<std::string, IndexEntry_t>;
+
+	/// @brief Expects m_mutex to be held exclusively
+	bool load_index();
+
+	/// @brief Indexes the valid records from offset on and cuts the pack after the last one
+	void recover_tail(uint64_t offset);
+
+	bool save_index() const;
+
+	bool open_pack();
+
+	void close_pack();
+
+	bool compact_locked();
+
+	void evict_locked(uint64_t maxItems, uint64_t maxBytes);
+
+	void insert_locked(const std::string& key, uint64_t offset, uint64_t size, uint64_t lastAccess);
+
+	void erase_locked(Index_t::iterator it);
+
+	CesiumPackFileCacheOptions_t m_options;
+
+	/// @brief The pack as a filesystem path, options.path is UTF-8 which std::string paths don't mean on Windows
+	std::filesystem::path m_packPath;
+
+	std::filesystem::path m_indexPath;
+
+	/// @brief Guards the index, the mapping and the append handle. Lookups share it, writes take it exclusively
+	mutable std::shared_mutex m_mutex;
+
+	Index_t m_index;
+
+	mutable MappedFile m_mapping;
+
+	std::FILE* m_appendFile = nullptr;
+
+	/// @brief Bytes of the pack covered by valid records
+	uint64_t m_packSize = 0;
+
+	uint64_t m_liveBytes = 0;
+
+	uint32_t m_writesSinceIndexSave = 0;
+
+	mutable std::atomic<uint64_t> m_accessClock{ 0 };
+
+	struct SharedPack_t {
+		CesiumPackFileCache* cache = nullptr;
+		uint32_t users = 0;
+	};
+
+	/// @brief Guards s_sharedPacks, opening and closing a shared pack happen under it so they never overlap
+	static inline std::mutex s_sharedMutex;
+
+	/// @brief Keyed by the pack path with forward slashes
+	static inline std::unordered_map<std::string, SharedPack_t> s_sharedPacks;
+};
+
+#endif // !CESIUM_PACK_FILE_CACHE_H
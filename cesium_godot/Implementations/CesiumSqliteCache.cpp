@@ -0,0 +1,518 @@
+#include "CesiumSqliteCache.h"
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/variant/string.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "core/error/error_macros.h"
+#endif
+
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+// Own table name, so a database file left behind by CesiumAsync::SqliteCache is never misread
+constexpr const char* CREATE_TABLE_SQL =
+	"CREATE TABLE IF NOT EXISTS TileCache ("
+	"key TEXT PRIMARY KEY NOT NULL, "
+	"expiryTime INTEGER NOT NULL, "
+	"lastAccessedTime INTEGER NOT NULL, "
+	"url TEXT NOT NULL, "
+	"requestMethod TEXT NOT NULL, "
+	"requestHeaders BLOB, "
+	"statusCode INTEGER NOT NULL, "
+	"responseHeaders BLOB, "
+	"responseData BLOB, "
+	"responseSize INTEGER NOT NULL, "
+	"encoding INTEGER NOT NULL DEFAULT 0, "
+	"dictionaryId INTEGER NOT NULL DEFAULT 0);"
+	"CREATE INDEX IF NOT EXISTS TileCacheLastAccessed ON TileCache(lastAccessedTime);"
+	"CREATE TABLE IF NOT EXISTS TileCacheDictionary ("
+	"id INTEGER PRIMARY KEY AUTOINCREMENT, "
+	"contentType INTEGER NOT NULL, "
+	"data BLOB NOT NULL);";
+constexpr const char* MIGRATE_ENCODING_SQL =
+	"ALTER TABLE TileCache ADD COLUMN encoding INTEGER NOT NULL DEFAULT 0;"
+	"ALTER TABLE TileCache ADD COLUMN dictionaryId INTEGER NOT NULL DEFAULT 0;";
+constexpr const char* SELECT_SQL = "SELECT expiryTime, url, requestMethod, requestHeaders, statusCode, responseHeaders, responseData, encoding, dictionaryId FROM TileCache WHERE key = ?";
+constexpr const char* INSERT_SQL =
+	"INSERT OR REPLACE INTO TileCache (key, expiryTime, lastAccessedTime, url, requestMethod, requestHeaders, statusCode, responseHeaders, responseData, responseSize, encoding, dictionaryId) "
+	"VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+constexpr const char* INSERT_DICTIONARY_SQL = "INSERT INTO TileCacheDictionary (contentType, data) VALUES (?, ?)";
+// Oldest first, the newest dictionary of each content type ends up used for compression
+constexpr const char* SELECT_DICTIONARIES_SQL = "SELECT id, contentType, data FROM TileCacheDictionary ORDER BY id ASC";
+constexpr const char* TOUCH_SQL = "UPDATE TileCache SET lastAccessedTime = ? WHERE key = ?";
+constexpr const char* COUNT_SQL = "SELECT COUNT(*), COALESCE(SUM(responseSize), 0) FROM TileCache";
+constexpr const char* EVICT_OLDEST_ITEMS_SQL = "DELETE FROM TileCache WHERE key IN (SELECT key FROM TileCache ORDER BY lastAccessedTime ASC LIMIT ?)";
+// Keeps the most recently used entries whose bodies add up to at most the bound byte budget
+constexpr const char* EVICT_OLDEST_BYTES_SQL =
+	"DELETE FROM TileCache WHERE key IN (SELECT key FROM ("
+	"SELECT key, SUM(responseSize) OVER (ORDER BY lastAccessedTime DESC, rowid DESC) AS keptBytes FROM TileCache"
+	") WHERE keptBytes > ?)";
+constexpr int32_t ENCODING_IDENTITY = 0;
+constexpr int32_t ENCODING_ZSTD = 1;
+// Reads run next to the writer, only the writer ever has to wait for a lock and it does so on its own thread
+constexpr int32_t BUSY_TIMEOUT_MS = 5000;
+
+namespace {
+	bool exec_sql(sqlite3* database, const char* sql)
+	{
+		char* errorMessage = nullptr;
+		if (sqlite3_exec(database, sql, nullptr, nullptr, &errorMessage) == SQLITE_OK) return true;
+		ERR_PRINT(String("Tile cache query failed: ") + String(errorMessage != nullptr ? errorMessage : sql));
+		sqlite3_free(errorMessage);
+		return false;
+	}
+
+	sqlite3* open_connection(const std::string& path)
+	{
+		sqlite3* database = nullptr;
+		const int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX;
+		if (sqlite3_open_v2(path.c_str(), &database, flags, nullptr) != SQLITE_OK) {
+			ERR_PRINT(String("Could not open the tile cache at ") + String(path.c_str()) + String(": ") + String(sqlite3_errmsg(database)));
+			sqlite3_close(database);
+			return nullptr;
+		}
+		sqlite3_busy_timeout(database, BUSY_TIMEOUT_MS);
+		return database;
+	}
+
+	int64_t now_seconds()
+	{
+		return static_cast<int64_t>(std::time(nullptr));
+	}
+
+	std::string column_text(sqlite3_stmt* statement, int column)
+	{
+		const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(statement, column));
+		return text != nullptr ? std::string(text, sqlite3_column_bytes(statement, column)) : std::string();
+	}
+}
+
+CesiumSqliteCache::CesiumSqliteCache(const CesiumSqliteCacheOptions_t& options) : m_options(options)
+{
+	if (!this->open_database()) return;
+	this->m_writerThread = std::thread([this] {
+		this->run_writer();
+	});
+}
+
+CesiumSqliteCache::~CesiumSqliteCache()
+{
+	{
+		std::scoped_lock lock(this->m_queueMutex);
+		this->m_stopping = true;
+	}
+	this->m_queueChanged.notify_all();
+	if (this->m_writerThread.joinable()) {
+		this->m_writerThread.join();
+	}
+	sqlite3_finalize(this->m_selectStatement);
+	sqlite3_finalize(this->m_insertStatement);
+	sqlite3_finalize(this->m_touchStatement);
+	sqlite3_finalize(this->m_insertDictionaryStatement);
+	sqlite3_close(this->m_readDatabase);
+	sqlite3_close(this->m_writeDatabase);
+}
+
+std::optional<CesiumAsync::CacheItem> CesiumSqliteCache::getEntry(const std::string& key) const
+{
+	{
+		std::scoped_lock lock(this->m_queueMutex);
+		auto it = this->m_pendingEntries.find(key);
+		if (it != this->m_pendingEntries.end()) {
+			return make_cache_item(*it->second);
+		}
+	}
+
+	std::unique_lock lock(this->m_readMutex);
+	if (this->m_selectStatement == nullptr) return std::nullopt;
+	sqlite3_stmt* statement = this->m_selectStatement;
+	sqlite3_reset(statement);
+	sqlite3_bind_text(statement, 1, key.c_str(), static_cast<int>(key.size()), SQLITE_TRANSIENT);
+	if (sqlite3_step(statement) != SQLITE_ROW) {
+		sqlite3_reset(statement);
+		return std::nullopt;
+	}
+
+	const std::time_t expiryTime = static_cast<std::time_t>(sqlite3_column_int64(statement, 0));
+	std::string url = column_text(statement, 1);
+	std::string requestMethod = column_text(statement, 2);
+	CesiumAsync::HttpHeaders requestHeaders = deserialize_headers(sqlite3_column_blob(statement, 3), sqlite3_column_bytes(statement, 3));
+	const uint16_t statusCode = static_cast<uint16_t>(sqlite3_column_int(statement, 4));
+	CesiumAsync::HttpHeaders responseHeaders = deserialize_headers(sqlite3_column_blob(statement, 5), sqlite3_column_bytes(statement, 5));
+	const auto* data = reinterpret_cast<const std::byte*>(sqlite3_column_blob(statement, 6));
+	std::vector<std::byte> responseData(data, data + sqlite3_column_bytes(statement, 6));
+	const int32_t encoding = sqlite3_column_int(statement, 7);
+	const int64_t dictionaryId = sqlite3_column_int64(statement, 8);
+	sqlite3_reset(statement);
+	lock.unlock();
+
+	if (encoding == ENCODING_ZSTD) {
+		std::vector<std::byte> decompressed;
+		if (!this->m_compressor.decompress(responseData, dictionaryId, &decompressed)) {
+			// Treated as a miss, the response fetched instead overwrites the entry
+			ERR_PRINT(String("Could not decompress the cached ") + String(url.c_str()));
+			return std::nullopt;
+		}
+		responseData = std::move(decompressed);
+	}
+
+	// The access time only drives eviction, it can wait for the next batch
+	this->enqueue({ OperationType::Touch, key, nullptr });
+
+	return CesiumAsync::CacheItem(
+		expiryTime,
+		CesiumAsync::CacheRequest(std::move(requestHeaders), std::move(requestMethod), std::move(url)),
+		CesiumAsync::CacheResponse(statusCode, std::move(responseHeaders), std::move(responseData)));
+}
+
+bool CesiumSqliteCache::storeEntry(
+	const std::string& key,
+	std::time_t expiryTime,
+	const std::string& url,
+	const std::string& requestMethod,
+	const CesiumAsync::HttpHeaders& requestHeaders,
+	uint16_t statusCode,
+	const CesiumAsync::HttpHeaders& responseHeaders,
+	const std::span<const std::byte>& responseData)
+{
+	if (this->m_writeDatabase == nullptr) return false;
+	auto entry = std::make_shared<PendingEntry_t>(PendingEntry_t{
+		expiryTime,
+		url,
+		requestMethod,
+		requestHeaders,
+		statusCode,
+		responseHeaders,
+		std::vector<std::byte>(responseData.begin(), responseData.end())
+	});
+	{
+		std::scoped_lock lock(this->m_queueMutex);
+		this->m_pendingEntries[key] = entry;
+	}
+	this->enqueue({ OperationType::Store, key, std::move(entry) });
+	return true;
+}
+
+bool CesiumSqliteCache::prune()
+{
+	if (this->m_writeDatabase == nullptr) return false;
+	this->enqueue({ OperationType::Prune, std::string(), nullptr });
+	return true;
+}
+
+bool CesiumSqliteCache::clearAll()
+{
+	if (this->m_writeDatabase == nullptr) return false;
+	{
+		// Writes queued before the clear would bring entries back afterwards
+		std::scoped_lock lock(this->m_queueMutex);
+		std::erase_if(this->m_queue, [](const Operation_t& operation) {
+			return operation.type == OperationType::Store || operation.type == OperationType::Touch;
+		});
+		this->m_pendingEntries.clear();
+	}
+	this->enqueue({ OperationType::Clear, std::string(), nullptr });
+	return true;
+}
+
+void CesiumSqliteCache::flush()
+{
+	std::unique_lock lock(this->m_queueMutex);
+	this->m_queueDrained.wait(lock, [this] {
+		return (this->m_queue.empty() && !this->m_writing) || !this->m_writerThread.joinable();
+	});
+}
+
+void CesiumSqliteCache::run_writer()
+{
+	const size_t batchSize = std::max<uint32_t>(this->m_options.writeBatchSize, 1);
+	std::unique_lock lock(this->m_queueMutex);
+	while (true) {
+		this->m_queueChanged.wait(lock, [this] { return this->m_stopping || !this->m_queue.empty(); });
+		if (this->m_queue.empty()) break;
+
+		// Let a burst of tile responses fill up the batch, a single transaction is far cheaper than one per insert
+		if (!this->m_stopping && this->m_queue.size() < batchSize) {
+			this->m_queueChanged.wait_for(lock, std::chrono::milliseconds(this->m_options.writeDelayMs), [this, batchSize] {
+				return this->m_stopping || this->m_queue.size() >= batchSize;
+			});
+		}
+
+		std::deque<Operation_t> batch;
+		while (!this->m_queue.empty() && batch.size() < batchSize) {
+			batch.push_back(std::move(this->m_queue.front()));
+			this->m_queue.pop_front();
+		}
+		this->m_writing = true;
+		lock.unlock();
+
+		this->commit_batch(batch);
+
+		lock.lock();
+		this->m_writing = false;
+		// Written entries are served by the database from now on, unless a newer write for the key came in
+		for (const Operation_t& operation : batch) {
+			if (operation.type != OperationType::Store) continue;
+			auto it = this->m_pendingEntries.find(operation.key);
+			if (it != this->m_pendingEntries.end() && it->second == operation.entry) {
+				this->m_pendingEntries.erase(it);
+			}
+		}
+		if (this->m_queue.empty()) {
+			this->m_queueDrained.notify_all();
+		}
+	}
+	this->m_queueDrained.notify_all();
+}
+
+void CesiumSqliteCache::commit_batch(std::deque<Operation_t>& batch)
+{
+	const bool inTransaction = exec_sql(this->m_writeDatabase, "BEGIN IMMEDIATE");
+	for (const Operation_t& operation : batch) {
+		switch (operation.type) {
+			case OperationType::Store:
+				this->write_entry(operation.key, *operation.entry);
+				break;
+			case OperationType::Touch:
+				this->touch_entry(operation.key);
+				break;
+			case OperationType::Prune:
+				this->prune_entries();
+				break;
+			case OperationType::Clear:
+				this->clear_entries();
+				break;
+		}
+	}
+	if (inTransaction) {
+		exec_sql(this->m_writeDatabase, "COMMIT");
+	}
+}
+
+void CesiumSqliteCache::write_entry(const std::string& key, const PendingEntry_t& entry)
+{
+	std::vector<std::byte> compressedData;
+	int64_t dictionaryId = 0;
+	bool compressed = false;
+	if (this->m_options.compressionEnabled) {
+		const CesiumCacheCompressor::ContentType type = CesiumCacheCompressor::classify(entry.url, entry.responseHeaders, entry.responseData);
+		if (this->m_compressor.add_sample(type, entry.responseData)) {
+			this->store_dictionary(type);
+		}
+		compressed = this->m_compressor.compress(type, entry.responseData, &compressedData, &dictionaryId);
+	}
+	const std::span<const std::byte> storedData = compressed ? std::span<const std::byte>(compressedData) : std::span<const std::byte>(entry.responseData);
+
+	sqlite3_stmt* statement = this->m_insertStatement;
+	const std::string requestHeaders = serialize_headers(entry.requestHeaders);
+	const std::string responseHeaders = serialize_headers(entry.responseHeaders);
+	sqlite3_reset(statement);
+	sqlite3_bind_text(statement, 1, key.c_str(), static_cast<int>(key.size()), SQLITE_STATIC);
+	sqlite3_bind_int64(statement, 2, static_cast<sqlite3_int64>(entry.expiryTime));
+	sqlite3_bind_int64(statement, 3, now_seconds());
+	sqlite3_bind_text(statement, 4, entry.url.c_str(), static_cast<int>(entry.url.size()), SQLITE_STATIC);
+	sqlite3_bind_text(statement, 5, entry.requestMethod.c_str(), static_cast<int>(entry.requestMethod.size()), SQLITE_STATIC);
+	sqlite3_bind_blob(statement, 6, requestHeaders.data(), static_cast<int>(requestHeaders.size()), SQLITE_STATIC);
+	sqlite3_bind_int(statement, 7, entry.statusCode);
+	sqlite3_bind_blob(statement, 8, responseHeaders.data(), static_cast<int>(responseHeaders.size()), SQLITE_STATIC);
+	sqlite3_bind_blob(statement, 9, storedData.data(), static_cast<int>(storedData.size()), SQLITE_STATIC);
+	// The byte budget is about disk space, count what is stored
+	sqlite3_bind_int64(statement, 10, static_cast<sqlite3_int64>(storedData.size()));
+	sqlite3_bind_int(statement, 11, compressed ? ENCODING_ZSTD : ENCODING_IDENTITY);
+	sqlite3_bind_int64(statement, 12, dictionaryId);
+	if (sqlite3_step(statement) != SQLITE_DONE) {
+		ERR_PRINT(String("Could not store ") + String(entry.url.c_str()) + String(" in the tile cache: ") + String(sqlite3_errmsg(this->m_writeDatabase)));
+	}
+	// Bound with SQLITE_STATIC, drop the references before the buffers go away
+	sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+}
+
+void CesiumSqliteCache::store_dictionary(CesiumCacheCompressor::ContentType type)
+{
+	const std::vector<std::byte> dictionary = this->m_compressor.train_dictionary(type);
+	if (dictionary.empty()) return;
+	sqlite3_stmt* statement = this->m_insertDictionaryStatement;
+	sqlite3_reset(statement);
+	sqlite3_bind_int(statement, 1, static_cast<int>(type));
+	sqlite3_bind_blob(statement, 2, dictionary.data(), static_cast<int>(dictionary.size()), SQLITE_STATIC);
+	const bool stored = sqlite3_step(statement) == SQLITE_DONE;
+	sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+	// Entries must never reference a dictionary the database doesn't have
+	if (!stored) {
+		ERR_PRINT(String("Could not store a tile cache dictionary: ") + String(sqlite3_errmsg(this->m_writeDatabase)));
+		return;
+	}
+	this->m_compressor.set_compression_dictionary(type, sqlite3_last_insert_rowid(this->m_writeDatabase), dictionary);
+}
+
+void CesiumSqliteCache::touch_entry(const std::string& key)
+{
+	sqlite3_stmt* statement = this->m_touchStatement;
+	sqlite3_reset(statement);
+	sqlite3_bind_int64(statement, 1, now_seconds());
+	sqlite3_bind_text(statement, 2, key.c_str(), static_cast<int>(key.size()), SQLITE_STATIC);
+	sqlite3_step(statement);
+	sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+}
+
+void CesiumSqliteCache::prune_entries()
+{
+	// Expired entries are kept, CachingAssetAccessor revalidates them with their ETag / Last-Modified
+	sqlite3_stmt* countStatement = nullptr;
+	if (sqlite3_prepare_v2(this->m_writeDatabase, COUNT_SQL, -1, &countStatement, nullptr) != SQLITE_OK) return;
+	int64_t itemCount = 0;
+	int64_t totalBytes = 0;
+	if (sqlite3_step(countStatement) == SQLITE_ROW) {
+		itemCount = sqlite3_column_int64(countStatement, 0);
+		totalBytes = sqlite3_column_int64(countStatement, 1);
+	}
+	sqlite3_finalize(countStatement);
+
+	const int64_t maxItems = static_cast<int64_t>(this->m_options.maxItems);
+	if (maxItems > 0 && itemCount > maxItems) {
+		this->evict_oldest(EVICT_OLDEST_ITEMS_SQL, itemCount - maxItems);
+	}
+	// Works on whatever the item eviction left, no need to count again
+	const int64_t maxBytes = static_cast<int64_t>(this->m_options.maxBytes);
+	if (maxBytes > 0 && totalBytes > maxBytes) {
+		this->evict_oldest(EVICT_OLDEST_BYTES_SQL, maxBytes);
+	}
+}
+
+void CesiumSqliteCache::evict_oldest(const char* sql, int64_t parameter)
+{
+	sqlite3_stmt* statement = nullptr;
+	if (sqlite3_prepare_v2(this->m_writeDatabase, sql, -1, &statement, nullptr) != SQLITE_OK) {
+		ERR_PRINT(String("Could not prune the tile cache: ") + String(sqlite3_errmsg(this->m_writeDatabase)));
+		return;
+	}
+	sqlite3_bind_int64(statement, 1, parameter);
+	sqlite3_step(statement);
+	sqlite3_finalize(statement);
+}
+
+void CesiumSqliteCache::clear_entries()
+{
+	// Dictionaries stay, they describe the content rather than the entries and the next ones compress right away
+	exec_sql(this->m_writeDatabase, "DELETE FROM TileCache");
+}
+
+void CesiumSqliteCache::enqueue(Operation_t&& operation) const
+{
+	{
+		std::scoped_lock lock(this->m_queueMutex);
+		if (this->m_stopping) return;
+		this->m_queue.push_back(std::move(operation));
+	}
+	this->m_queueChanged.notify_one();
+}
+
+bool CesiumSqliteCache::open_database()
+{
+	this->m_writeDatabase = open_connection(this->m_options.path);
+	if (this->m_writeDatabase == nullptr) return false;
+	// WAL lets the read connection see committed batches while the next one is being written
+	exec_sql(this->m_writeDatabase, "PRAGMA journal_mode=WAL");
+	exec_sql(this->m_writeDatabase, "PRAGMA synchronous=NORMAL");
+	if (!exec_sql(this->m_writeDatabase, CREATE_TABLE_SQL) ||
+			!this->migrate_schema() ||
+			sqlite3_prepare_v2(this->m_writeDatabase, INSERT_SQL, -1, &this->m_insertStatement, nullptr) != SQLITE_OK ||
+			sqlite3_prepare_v2(this->m_writeDatabase, TOUCH_SQL, -1, &this->m_touchStatement, nullptr) != SQLITE_OK ||
+			sqlite3_prepare_v2(this->m_writeDatabase, INSERT_DICTIONARY_SQL, -1, &this->m_insertDictionaryStatement, nullptr) != SQLITE_OK) {
+		ERR_PRINT(String("Could not prepare the tile cache: ") + String(sqlite3_errmsg(this->m_writeDatabase)));
+		sqlite3_finalize(this->m_insertStatement);
+		sqlite3_finalize(this->m_touchStatement);
+		sqlite3_finalize(this->m_insertDictionaryStatement);
+		this->m_insertStatement = nullptr;
+		this->m_touchStatement = nullptr;
+		this->m_insertDictionaryStatement = nullptr;
+		sqlite3_close(this->m_writeDatabase);
+		this->m_writeDatabase = nullptr;
+		return false;
+	}
+
+	this->m_readDatabase = open_connection(this->m_options.path);
+	if (this->m_readDatabase != nullptr && sqlite3_prepare_v2(this->m_readDatabase, SELECT_SQL, -1, &this->m_selectStatement, nullptr) != SQLITE_OK) {
+		ERR_PRINT(String("Could not prepare the tile cache reads: ") + String(sqlite3_errmsg(this->m_readDatabase)));
+	}
+	this->load_dictionaries();
+	return true;
+}
+
+bool CesiumSqliteCache::migrate_schema()
+{
+	sqlite3_stmt* statement = nullptr;
+	if (sqlite3_prepare_v2(this->m_writeDatabase, "PRAGMA table_info(TileCache)", -1, &statement, nullptr) != SQLITE_OK) return false;
+	bool hasEncoding = false;
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		if (column_text(statement, 1) == "encoding") {
+			hasEncoding = true;
+		}
+	}
+	sqlite3_finalize(statement);
+	// Existing rows were stored as received, the column defaults say just that
+	return hasEncoding || exec_sql(this->m_writeDatabase, MIGRATE_ENCODING_SQL);
+}
+
+void CesiumSqliteCache::load_dictionaries()
+{
+	sqlite3_stmt* statement = nullptr;
+	if (sqlite3_prepare_v2(this->m_writeDatabase, SELECT_DICTIONARIES_SQL, -1, &statement, nullptr) != SQLITE_OK) return;
+	while (sqlite3_step(statement) == SQLITE_ROW) {
+		const int64_t id = sqlite3_column_int64(statement, 0);
+		const int contentType = sqlite3_column_int(statement, 1);
+		const auto* data = reinterpret_cast<const std::byte*>(sqlite3_column_blob(statement, 2));
+		const std::span<const std::byte> dictionary(data, static_cast<size_t>(sqlite3_column_bytes(statement, 2)));
+		if (contentType >= 0 && contentType < static_cast<int>(CesiumCacheCompressor::ContentType::Count)) {
+			this->m_compressor.set_compression_dictionary(static_cast<CesiumCacheCompressor::ContentType>(contentType), id, dictionary);
+		}
+		else {
+			this->m_compressor.add_decompression_dictionary(id, dictionary);
+		}
+	}
+	sqlite3_finalize(statement);
+}
+
+std::string CesiumSqliteCache::serialize_headers(const CesiumAsync::HttpHeaders& headers)
+{
+	// Names and values can't contain NUL, so it works as a separator
+	std::string result;
+	for (const auto& [name, value] : headers) {
+		result += name;
+		result += '\0';
+		result += value;
+		result += '\0';
+	}
+	return result;
+}
+
+CesiumAsync::HttpHeaders CesiumSqliteCache::deserialize_headers(const void* data, int size)
+{
+	CesiumAsync::HttpHeaders headers;
+	if (data == nullptr || size <= 0) return headers;
+	const char* cursor = static_cast<const char*>(data);
+	const char* end = cursor + size;
+	while (cursor < end) {
+		const char* nameEnd = std::find(cursor, end, '\0');
+		if (nameEnd == end) break;
+		const char* valueEnd = std::find(nameEnd + 1, end, '\0');
+		headers.emplace(std::string(cursor, nameEnd), std::string(nameEnd + 1, valueEnd));
+		cursor = valueEnd + 1;
+	}
+	return headers;
+}
+
+CesiumAsync::CacheItem CesiumSqliteCache::make_cache_item(const PendingEntry_t& entry)
+{
+	return CesiumAsync::CacheItem(
+		entry.expiryTime,
+		CesiumAsync::CacheRequest(entry.requestHeaders, entry.requestMethod, entry.url),
+		CesiumAsync::CacheResponse(entry.statusCode, entry.responseHeaders, entry.responseData));
+}
@@ -0,0 +1,164 @@
+#ifndef CESIUM_SQLITE_CACHE_H
+#define CESIUM_SQLITE_CACHE_H
+
+#include "../Utils/CesiumCacheCompressor.h"
+#include <CesiumAsync/ICacheDatabase.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+struct CesiumSqliteCacheOptions_t {
+	/// @brief Absolute path of the database file
+	std::string path;
+	/// @brief 0 removes the limit
+	uint64_t maxItems = 4096 * 5;
+	/// @brief Sum of the cached response bodies as stored (compressed), 0 removes the limit
+	uint64_t maxBytes = 0;
+	/// @brief Writes committed together in one transaction
+	uint32_t writeBatchSize = 64;
+	/// @brief How long the writer waits for a batch to fill up before committing what it has
+	uint32_t writeDelayMs = 100;
+	/// @brief zstd compresses new bodies, entries already compressed are read either way
+	bool compressionEnabled = true;
+};
+
+/**
+ * @brief Request cache for CachingAssetAccessor that never writes on the caller's thread
+ * storeEntry, prune and clearAll only queue the work, a dedicated writer thread commits it in batched transactions.
+ * Entries still waiting to be written are served from the queue, so a tile can be read back right after it was stored
+ * Bodies are zstd compressed by the writer thread with a dictionary per kind of content (see CesiumCacheCompressor),
+ * getEntry decompresses them on the calling thread, which is one of CachingAssetAccessor's worker threads
+ * @note The database runs in WAL mode, reads on the request path don't wait for the writer
+ */
+class CesiumSqliteCache final : public CesiumAsync::ICacheDatabase {
+public:
+	explicit CesiumSqliteCache(const CesiumSqliteCacheOptions_t& options);
+
+	/// @brief Commits everything still queued before closing the database
+	~CesiumSqliteCache() override;
+
+	std::optional<CesiumAsync::CacheItem> getEntry(const std::string& key) const override;
+
+	bool storeEntry(
+		const std::string& key,
+		std::time_t expiryTime,
+		const std::string& url,
+		const std::string& requestMethod,
+		const CesiumAsync::HttpHeaders& requestHeaders,
+		uint16_t statusCode,
+		const CesiumAsync::HttpHeaders& responseHeaders,
+		const std::span<const std::byte>& responseData) override;
+
+	bool prune() override;
+
+	bool clearAll() override;
+
+	/// @brief Blocks until every write queued so far is committed
+	void flush();
+
+	/// @brief Flat NUL separated encoding of a header map, also used by CesiumPackFileCache
+	static std::string serialize_headers(const CesiumAsync::HttpHeaders& headers);
+
+	static CesiumAsync::HttpHeaders deserialize_headers(const void* data, int size);
+
+private:
+	struct PendingEntry_t {
+		std::time_t expiryTime;
+		std::string url;
+		std::string requestMethod;
+		CesiumAsync::HttpHeaders requestHeaders;
+		uint16_t statusCode;
+		CesiumAsync::HttpHeaders responseHeaders;
+		std::vector<std::byte> responseData;
+	};
+
+	enum class OperationType : uint8_t {
+		Store,
+		Touch,
+		Prune,
+		Clear
+	};
+
+	struct Operation_t {
+		OperationType type;
+		std::string key;
+		std::shared_ptr<const PendingEntry_t> entry;
+	};
+
+	void run_writer();
+
+	void commit_batch(std::deque<Operation_t>& batch);
+
+	void write_entry(const std::string& key, const PendingEntry_t& entry);
+
+	/// @brief Trains a dictionary on the samples collected for the type and stores it with the current batch
+	void store_dictionary(CesiumCacheCompressor::ContentType type);
+
+	/// @brief Adds the compression columns to databases created before they existed
+	bool migrate_schema();
+
+	void load_dictionaries();
+
+	void touch_entry(const std::string& key);
+
+	void prune_entries();
+
+	void evict_oldest(const char* sql, int64_t parameter);
+
+	void clear_entries();
+
+	void enqueue(Operation_t&& operation) const;
+
+	bool open_database();
+
+	static CesiumAsync::CacheItem make_cache_item(const PendingEntry_t& entry);
+
+	CesiumSqliteCacheOptions_t m_options;
+
+	/// @brief Read connection, used by getEntry under m_readMutex
+	sqlite3* m_readDatabase = nullptr;
+
+	sqlite3_stmt* m_selectStatement = nullptr;
+
+	mutable std::mutex m_readMutex;
+
+	/// @brief Write connection, only used by the writer thread
+	sqlite3* m_writeDatabase = nullptr;
+
+	sqlite3_stmt* m_insertStatement = nullptr;
+
+	sqlite3_stmt* m_touchStatement = nullptr;
+
+	sqlite3_stmt* m_insertDictionaryStatement = nullptr;
+
+	/// @brief Compression and training run on the writer thread, decompression on the readers
+	CesiumCacheCompressor m_compressor;
+
+	/// @brief Protects everything below, reads queue touches too so these are mutable
+	mutable std::mutex m_queueMutex;
+
+	mutable std::condition_variable m_queueChanged;
+
+	std::condition_variable m_queueDrained;
+
+	mutable std::deque<Operation_t> m_queue;
+
+	/// @brief Entries queued or being written, newest per key
+	std::unordered_map<std::string, std::shared_ptr<const PendingEntry_t>> m_pendingEntries;
+
+	bool m_writing = false;
+
+	bool m_stopping = false;
+
+	std::thread m_writerThread;
+};
+
+#endif // !CESIUM_SQLITE_CACHE_H
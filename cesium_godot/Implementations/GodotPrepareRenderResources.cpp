@@ -19,12 +19,18 @@ using namespace godot;
 #include "Cesium3DTilesSelection/Tile.h"
 #include "../CesiumGDModelLoader.h"
 #include "../Utils/CesiumGDTextureLoader.h"
+#include "../Utils/CesiumMipChainBuilder.h"
+#include "../Utils/LocalCacheManager.h"
+#include "../Utils/CesiumTileMeshCache.h"
+#include "CesiumAsync/IAssetRequest.h"
+#include "CesiumAsync/IAssetResponse.h"
 #include "CesiumRasterOverlays/RasterOverlayTile.h"
 #include "CesiumRasterOverlays/RasterOverlay.h"
 #include "../Utils/CesiumMathUtils.h"
 #include "CesiumGltf/Node.h"
 #include "CesiumGltf/ExtensionModelExtStructuralMetadata.h"
 #include <glm/gtc/quaternion.hpp>
+#include <variant>
 #include "../Models/CesiumGDTileset.h"
 
 using namespace CesiumAsync;
@@ -39,8 +45,20 @@ CesiumAsync::Future<Cesium3DTilesSelection::TileLoadResultAndRenderResources> Go
 	}
 
 	return asyncSystem.createFuture<TileLoadResultAndRenderResources>([=, this](Promise<TileLoadResultAndRenderResources> p_promise) {
-		Error err;
-		Ref<ArrayMesh> meshData = CesiumGDModelLoader::generate_meshes_from_model(*model, &err);
+		Error err = Error::OK;
+		// Recreated tilesets find the converted tile in memory, warm starts on disk. The glTF still went through cesium-native but not through the mesh loader
+		const bool diskCacheEnabled = this->m_tileset->get_render_cache_enabled();
+		const uint64_t renderKey = diskCacheEnabled || CesiumTileMeshCache::is_enabled() ? get_render_cache_key(tileLoadResult, *model) : 0;
+		PackedVector3Array collisionFaces;
+		Ref<ArrayMesh> meshData = renderKey != 0 ? CesiumTileMeshCache::get(renderKey, &collisionFaces) : Ref<ArrayMesh>();
+		const bool fromMemoryCache = meshData.is_valid();
+		if (!fromMemoryCache && renderKey != 0 && diskCacheEnabled) {
+			meshData = LocalCacheManager::read_render_resource(renderKey, &collisionFaces);
+		}
+		const bool fromRenderCache = meshData.is_valid();
+		if (!fromRenderCache) {
+			meshData = CesiumGDModelLoader::generate_meshes_from_model(*model, &err);
+		}
 
 		Cesium3DTile* instance = memnew(Cesium3DTile);
 		instance->set_mesh(meshData);
@@ -107,7 +125,18 @@ CesiumAsync::Future<Cesium3DTilesSelection::TileLoadResultAndRenderResources> Go
 		instance->set_position(translation);
 		instance->set_rotation(eulerAngles);
 		if (this->m_tileset->get_create_physics_meshes()) {
-			instance->generate_tile_collision();
+			if (!fromRenderCache || collisionFaces.size() == 0) {
+				collisionFaces = instance->get_collision_faces();
+			}
+			instance->generate_tile_collision_from_faces(collisionFaces);
+		}
+		if (renderKey != 0 && err == Error::OK) {
+			if (!fromRenderCache && diskCacheEnabled) {
+				LocalCacheManager::write_render_resource(renderKey, meshData, collisionFaces);
+			}
+			if (!fromMemoryCache) {
+				CesiumTileMeshCache::put(renderKey, meshData, collisionFaces);
+			}
 		}
 
 		// Metadata extraction
@@ -161,64 +190,121 @@ void GodotPrepareRenderResources::attachRasterInMainThread(const Tile& tile, int
 	auto* meshInstance = static_cast<Cesium3DTile*>(rawRenderResources);
 	if (meshInstance == nullptr) return;
 
-	Ref<ImageTexture> godotTexture = static_cast<ImageTexture*>(pMainThreadRendererResources);
-	std::string key = rasterTile.getOverlay().getName();
-
-	//Get all primitives (surfaces) in the mesh tile
-	uint32_t primitiveIndex = 0;
+	//Get all primitives (surfaces) in the mesh tile that carry the texcoords for this overlay
 	const CesiumGltf::Model& model = content.getRenderContent()->getModel();
 	std::string overlayAttributeName = "_CESIUMOVERLAY_" + std::to_string(overlayTextureCoordinateID);
 
-	Ref<ArrayMesh> arrayMesh = meshInstance->get_mesh();
-
-	const Vector2 scaleFactors = CesiumMathUtils::from_glm_vec2(scale);
-	const Vector2 translationOffsets = CesiumMathUtils::from_glm_vec2(translation);
-	
+	std::vector<int32_t> surfaceIndices;
+	int32_t surfaceIndex = 0;
 	for (const CesiumGltf::Mesh& mesh : model.meshes) {
 		for (const CesiumGltf::MeshPrimitive& primitive : mesh.primitives) {
-			std::_List_const_iterator attributeIt = primitive.attributes.find(overlayAttributeName);
-			if (attributeIt == primitive.attributes.end()) {
-				continue;
+			if (primitive.attributes.find(overlayAttributeName) != primitive.attributes.end()) {
+				surfaceIndices.push_back(surfaceIndex);
 			}
+			surfaceIndex++;
+		}
+	}
 
-			Array arrays = arrayMesh->surface_get_arrays(primitiveIndex);
+	if (surfaceIndices.empty()) return;
 
-			int32_t uvIndex = attributeIt->second;
+	OverlayLayerOptions_t layerOptions = get_overlay_layer_options(rasterTile, overlayTextureCoordinateID);
 
-			Ref<StandardMaterial3D> godotMaterial = memnew(StandardMaterial3D);
-			const CesiumGltf::Material& mat = model.materials.at(primitive.material);
-			Error err = CesiumGDModelLoader::copy_material_properties(mat, godotMaterial, model);
-			godotMaterial->set_texture(BaseMaterial3D::TEXTURE_ALBEDO, godotTexture);
-			godotMaterial->set_uv1_scale(Vector3(scale.x, -scale.y, 1.0));
-			godotMaterial->set_uv1_offset(Vector3(translation.x, 1 - translation.y, 1.0));
-			if (err != Error::OK) {
-				ERR_PRINT(String("Could not set texture for Raster Overlay, error: ") + REFLECT_ERR_NAME(err));
-				continue;
-			}
+	const auto* overlayResource = static_cast<const OverlayTextureResource_t*>(pMainThreadRendererResources);
+	if (overlayResource == nullptr) return;
 
-			//Apply the texture to the surface
-			err = CesiumGDModelLoader::apply_surface_to_mesh(primitive, arrayMesh, arrays);
-			if (err != Error::OK) {
-				ERR_PRINT(String("Could not set texture for Raster Overlay, error: ") + REFLECT_ERR_NAME(err));
-				continue;
-			}
+	OverlayLayer_t layer;
+	layer.texture = overlayResource->texture;
+	layer.uvRect = overlayResource->uvRect;
+	layer.maxLod = overlayResource->maxLod;
+	layer.scale = CesiumMathUtils::from_glm_vec2(scale);
+	layer.translation = CesiumMathUtils::from_glm_vec2(translation);
+	layer.alpha = layerOptions.alpha;
+	// The mesh loader places overlay 0 on UV and overlay 1 on UV2
+	layer.uvChannel = overlayTextureCoordinateID == 0 ? 0 : 1;
+
+	meshInstance->set_overlay_layer(layerOptions.layerIndex, layer, surfaceIndices);
+}
 
-			arrayMesh->surface_set_material(primitiveIndex, godotMaterial);
+void GodotPrepareRenderResources::detachRasterInMainThread(const Tile& tile, int32_t overlayTextureCoordinateID, const CesiumRasterOverlays::RasterOverlayTile& rasterTile, void* pMainThreadRendererResources) noexcept
+{
+	const Cesium3DTilesSelection::TileRenderContent* renderContent = tile.getContent().getRenderContent();
+	if (renderContent == nullptr) return;
+	auto* meshInstance = static_cast<Cesium3DTile*>(renderContent->getRenderResources());
+	if (meshInstance == nullptr) return;
 
-			primitiveIndex++;
+	OverlayLayerOptions_t layerOptions = get_overlay_layer_options(rasterTile, overlayTextureCoordinateID);
+	meshInstance->clear_overlay_layer(layerOptions.layerIndex);
+}
+
+uint64_t GodotPrepareRenderResources::get_render_cache_key(const Cesium3DTilesSelection::TileLoadResult& tileLoadResult, const CesiumGltf::Model& model)
+{
+	// Tiles that did not come from a request (e.g. upsampled for raster overlays) have nothing stable to key on
+	const std::shared_ptr<CesiumAsync::IAssetRequest>& request = tileLoadResult.pCompletedRequest;
+	if (request == nullptr || request->response() == nullptr) return 0;
+	const std::span<const std::byte> content = request->response()->data();
+	if (content.empty()) return 0;
+
+	// Attributes added after parsing (overlay texture coordinates, generated normals) change the converted mesh too
+	std::string layout;
+	for (const CesiumGltf::Mesh& mesh : model.meshes) {
+		for (const CesiumGltf::MeshPrimitive& primitive : mesh.primitives) {
+			for (const auto& [attributeName, accessorIndex] : primitive.attributes) {
+				layout += attributeName;
+				layout += ';';
+			}
+			layout += '|';
+		}
+	}
+	// The overlay texture coordinates are derived from each projection and the tile's rectangle in it,
+	// a different overlay projection (or overlay set) produces different values under the same attribute names
+	if (tileLoadResult.rasterOverlayDetails.has_value()) {
+		const auto appendDouble = [&layout](double value) {
+			layout.append(reinterpret_cast<const char*>(&value), sizeof(value));
+		};
+		const auto& overlayDetails = *tileLoadResult.rasterOverlayDetails;
+		for (const CesiumGeospatial::Projection& projection : overlayDetails.rasterOverlayProjections) {
+			layout += 'P';
+			layout += static_cast<char>('0' + projection.index());
+			const glm::dvec3 radii = std::visit([](const auto& value) { return value.getEllipsoid().getRadii(); }, projection);
+			appendDouble(radii.x);
+			appendDouble(radii.y);
+			appendDouble(radii.z);
+		}
+		for (const CesiumGeometry::Rectangle& rectangle : overlayDetails.rasterOverlayRectangles) {
+			layout += 'R';
+			appendDouble(rectangle.minimumX);
+			appendDouble(rectangle.minimumY);
+			appendDouble(rectangle.maximumX);
+			appendDouble(rectangle.maximumY);
 		}
 	}
-	meshInstance->set_mesh(arrayMesh);
+	return LocalCacheManager::compute_render_key(request->url(), content, layout);
 }
 
-void GodotPrepareRenderResources::detachRasterInMainThread(const Tile& tile, int32_t overlayTextureCoordinateID, const CesiumRasterOverlays::RasterOverlayTile& rasterTile, void* pMainThreadRendererResources) noexcept
+OverlayLayerOptions_t GodotPrepareRenderResources::get_overlay_layer_options(const CesiumRasterOverlays::RasterOverlayTile& rasterTile, int32_t overlayTextureCoordinateID)
 {
-
+	const std::any& rendererOptions = rasterTile.getOverlay().getOptions().rendererOptions;
+	const OverlayLayerOptions_t* layerOptions = std::any_cast<OverlayLayerOptions_t>(&rendererOptions);
+	if (layerOptions != nullptr) {
+		return *layerOptions;
+	}
+	// Overlays not created by our nodes, fallback to one layer per texture coordinate set
+	return OverlayLayerOptions_t{ overlayTextureCoordinateID, 1.0 };
 }
 
 void* GodotPrepareRenderResources::prepareRasterInLoadThread(CesiumGltf::ImageAsset& image, const std::any& rendererOptions)
 {
-	//I guess we just generate mip maps here (?
+	// Tiles headed for the overlay atlas are laid out as a cell with its mips here, the main thread only copies them in
+	if (image.mipPositions.empty() && CesiumOverlayAtlas::is_packable(image)) {
+		return static_cast<void*>(CesiumOverlayAtlas::prepare_cell(image).release());
+	}
+
+	if (CesiumMipChainBuilder::is_supported(image.channels, image.bytesPerChannel) &&
+			image.compressedPixelFormat == CesiumGltf::GpuCompressedPixelFormat::NONE) {
+		CesiumMipChainBuilder::generate_mipmaps(image, true);
+		return nullptr;
+	}
+
 	CesiumGltfReader::ImageDecoder::generateMipMaps(image);
 	return nullptr;
 }
@@ -226,14 +312,41 @@ void* GodotPrepareRenderResources::prepareRasterInLoadThread(CesiumGltf::ImageAs
 void* GodotPrepareRenderResources::prepareRasterInMainThread(CesiumRasterOverlays::RasterOverlayTile& rasterTile, void* pLoadThreadResult)
 {
 	const CesiumGltf::ImageAsset& imageCesium = *rasterTile.getImage().get();
-	Ref<ImageTexture> godotTexture = CesiumGDTextureLoader::load_image_texture(imageCesium, false, true);
-	godotTexture->reference();
-	return static_cast<void*>(godotTexture.ptr());
+	std::unique_ptr<OverlayAtlasCell_t> preparedCell(static_cast<OverlayAtlasCell_t*>(pLoadThreadResult));
+	auto* overlayResource = new OverlayTextureResource_t();
+	if (this->m_overlayAtlas.allocate(imageCesium, preparedCell.get(), overlayResource)) {
+		return static_cast<void*>(overlayResource);
+	}
+
+	overlayResource->texture = CesiumGDTextureLoader::load_image_texture(imageCesium, false, !imageCesium.mipPositions.empty());
+	this->m_standaloneOverlayTextures++;
+	return static_cast<void*>(overlayResource);
 }
 
 void GodotPrepareRenderResources::freeRaster(const CesiumRasterOverlays::RasterOverlayTile& rasterTile, void* pLoadThreadResult, void* pMainThreadResult) noexcept
 {
-	auto* rasterMainThreadTexture = static_cast<ImageTexture*>(pMainThreadResult);
-	if (rasterMainThreadTexture == nullptr) return;
-	rasterMainThreadTexture->unreference();
+	// Prepared for the atlas but never made it to the main thread
+	delete static_cast<OverlayAtlasCell_t*>(pLoadThreadResult);
+
+	auto* overlayResource = static_cast<OverlayTextureResource_t*>(pMainThreadResult);
+	if (overlayResource == nullptr) return;
+	if (overlayResource->atlasHandle.is_valid()) {
+		this->m_overlayAtlas.release(overlayResource->atlasHandle);
+	}
+	else {
+		this->m_standaloneOverlayTextures--;
+	}
+	delete overlayResource;
+}
+
+void GodotPrepareRenderResources::flush_overlay_atlas()
+{
+	this->m_overlayAtlas.flush();
+}
+
+Dictionary GodotPrepareRenderResources::get_overlay_atlas_statistics() const
+{
+	Dictionary stats = this->m_overlayAtlas.get_statistics();
+	stats["standalone_textures"] = this->m_standaloneOverlayTextures;
+	return stats;
 }
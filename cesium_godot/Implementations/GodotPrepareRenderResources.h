@@ -5,6 +5,8 @@
 #include "../Models/CesiumDataSource.h"
 #include "../Utils/BRThreadPool.h"
 #include "CesiumGltf/ImageAsset.h"
+#include "../Utils/CesiumOverlayMaterial.h"
+#include "../Utils/CesiumOverlayAtlas.h"
 
 class Cesium3DTileset;
 
@@ -88,9 +90,22 @@ public:
 		void* pLoadThreadResult,
 		void* pMainThreadResult) noexcept override;
 
+	/// @brief Uploads the overlay atlas pages touched since their last upload, within the per frame budget
+	void flush_overlay_atlas();
+
+	Dictionary get_overlay_atlas_statistics() const;
+
 private:
+	/// @brief 0 when the tile can't be cached
+	static uint64_t get_render_cache_key(const Cesium3DTilesSelection::TileLoadResult& tileLoadResult, const CesiumGltf::Model& model);
+
+	static OverlayLayerOptions_t get_overlay_layer_options(const CesiumRasterOverlays::RasterOverlayTile& rasterTile, int32_t overlayTextureCoordinateID);
+
 	Cesium3DTileset* m_tileset;
 	BRThreadPool m_physicsMeshThread;
+	CesiumOverlayAtlas m_overlayAtlas;
+	/// @brief Raster tiles that could not be packed in the atlas
+	int32_t m_standaloneOverlayTextures = 0;
 };
 
 #endif // !GODOT_PREPARE_RENDER_RESOURCES_H
@@ -0,0 +1,228 @@
+#include "IonStartupAssetAccessor.h"
+#include "../Models/LocalAssetResponse.h"
+#include "../Models/LocalAssetRequest.h"
+#include "CesiumAsync/AsyncSystem.h"
+#include "CesiumAsync/IAssetResponse.h"
+#include "CesiumUtility/Uri.h"
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/json.hpp>
+#include <godot_cpp/classes/marshalls.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#elif defined(CESIUM_GD_MODULE)
+#include "core/core_bind.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+using Marshalls = core_bind::Marshalls;
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+using FutureResult_t = std::shared_ptr<CesiumAsync::IAssetRequest>;
+
+// Bump whenever the stored layout changes, older entries are then ignored and overwritten
+constexpr int64_t STARTUP_CACHE_VERSION = 1;
+// The first tiles have to load with the stored token, one that's about to expire would only get them rejected
+constexpr int64_t TOKEN_EXPIRY_MARGIN_SECONDS = 10 * 60;
+// Root documents change along with the ?v= version in their URL, the endpoint names a new URL when the asset is reprocessed
+constexpr int64_t ROOT_DOCUMENT_MAX_AGE_SECONDS = 7 * 24 * 60 * 60;
+constexpr uint16_t STORED_RESPONSE_STATUS = 200;
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+namespace {
+	struct StoredEntry_t {
+		std::string contentType;
+		int64_t expiresAt = 0;
+		PackedByteArray body;
+	};
+
+	int64_t get_unix_time()
+	{
+		return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+
+	String get_entry_path(const String& directory, const std::string& url)
+	{
+		uint64_t hash = FNV_OFFSET_BASIS;
+		for (const char c : url) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= FNV_PRIME;
+		}
+		return directory.path_join(String::num_uint64(hash, 16) + ".startup");
+	}
+
+	bool read_entry(const String& directory, const std::string& url, StoredEntry_t* outEntry)
+	{
+		const String path = get_entry_path(directory, url);
+		if (!FileAccess::file_exists(path)) return false;
+		Ref<FileAccess> file = FileAccess::open(path, FileAccess::READ);
+		if (file.is_null()) return false;
+		const Variant stored = file->get_var();
+		if (stored.get_type() != Variant::DICTIONARY) return false;
+		const Dictionary entry = stored;
+		// The URL guards against hash collisions
+		if (static_cast<int64_t>(entry.get("version", 0)) != STARTUP_CACHE_VERSION || String(entry.get("url", "")) != String::utf8(url.c_str())) {
+			return false;
+		}
+		outEntry->contentType = String(entry.get("content_type", "")).utf8().get_data();
+		outEntry->expiresAt = entry.get("expires_at", 0);
+		outEntry->body = entry.get("body", PackedByteArray());
+		return true;
+	}
+
+	void write_entry(const String& directory, const std::string& url, const std::string& contentType, int64_t expiresAt, std::span<const std::byte> data)
+	{
+		if (!DirAccess::dir_exists_absolute(directory)) {
+			DirAccess::make_dir_recursive_absolute(directory);
+		}
+		PackedByteArray body;
+		body.resize(static_cast<int64_t>(data.size()));
+		if (!data.empty()) {
+			memcpy(body.ptrw(), data.data(), data.size());
+		}
+		Dictionary entry;
+		entry["version"] = STARTUP_CACHE_VERSION;
+		entry["url"] = String::utf8(url.c_str());
+		entry["content_type"] = String::utf8(contentType.c_str());
+		entry["expires_at"] = expiresAt;
+		entry["body"] = body;
+
+		const String path = get_entry_path(directory, url);
+		// Revalidations of two tilesets may finish at the same time, each one writes its own temporary file
+		static std::atomic<uint64_t> s_temporaryCounter{ 0 };
+		const String temporaryPath = path + "-" + String::num_uint64(s_temporaryCounter.fetch_add(1), 16) + ".tmp";
+		{
+			Ref<FileAccess> file = FileAccess::open(temporaryPath, FileAccess::WRITE);
+			if (file.is_null()) return;
+			file->store_var(entry);
+		}
+		if (DirAccess::rename_absolute(temporaryPath, path) != Error::OK) {
+			DirAccess::remove_absolute(temporaryPath);
+		}
+	}
+
+	/// @brief The exp claim of a JWT, 0 when the token is not one
+	int64_t get_token_expiry(const String& token)
+	{
+		const PackedStringArray parts = token.split(".");
+		if (parts.size() != 3) return 0;
+		// base64url without padding to plain base64
+		String payload = parts[1].replace("-", "+").replace("_", "/");
+		while (payload.length() % 4 != 0) {
+			payload += "=";
+		}
+		const PackedByteArray decoded = Marshalls::get_singleton()->base64_to_raw(payload);
+		const Variant claims = JSON::parse_string(decoded.get_string_from_utf8());
+		if (claims.get_type() != Variant::DICTIONARY) return 0;
+		return static_cast<int64_t>(static_cast<Dictionary>(claims).get("exp", 0));
+	}
+
+	Dictionary parse_endpoint(std::span<const std::byte> data)
+	{
+		const Variant endpoint = JSON::parse_string(String::utf8(reinterpret_cast<const char*>(data.data()), static_cast<int64_t>(data.size())));
+		return endpoint.get_type() == Variant::DICTIONARY ? static_cast<Dictionary>(endpoint) : Dictionary();
+	}
+}
+
+IonStartupAssetAccessor::IonStartupAssetAccessor(std::shared_ptr<CesiumAsync::IAssetAccessor> assetAccessor, const String& directory)
+	: m_assetAccessor{ std::move(assetAccessor) },
+	m_state{ std::make_shared<SharedState_t>() }
+{
+	this->m_state->directory = directory;
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> IonStartupAssetAccessor::get(const CesiumAsync::AsyncSystem& asyncSystem, const std::string& url, const std::vector<THeader>& headers /*= {}*/)
+{
+	const bool isEndpoint = is_endpoint_url(url);
+	bool isTracked;
+	bool isFirstRequest = false;
+	{
+		std::scoped_lock lock(this->m_state->mutex);
+		isTracked = isEndpoint || this->m_state->rootUrls.contains(url);
+		if (isTracked) {
+			isFirstRequest = this->m_state->servedUrls.insert(url).second;
+		}
+	}
+	if (!isTracked) return this->m_assetAccessor->get(asyncSystem, url, headers);
+
+	std::shared_ptr<SharedState_t> state = this->m_state;
+	StoredEntry_t entry;
+	if (isFirstRequest && read_entry(state->directory, url, &entry) && entry.expiresAt > get_unix_time()) {
+		if (isEndpoint) {
+			register_root_urls(*state, parse_endpoint(std::span<const std::byte>(reinterpret_cast<const std::byte*>(entry.body.ptr()), entry.body.size())));
+		}
+		// Revalidate in the background, the running tileset keeps the stored copy and the next launch starts from the new one
+		this->m_assetAccessor->get(asyncSystem, url, headers).thenImmediately([state, url](FutureResult_t&& request) {
+			on_response(state, url, *request);
+		});
+
+		CesiumAsync::HttpHeaders responseHeaders;
+		responseHeaders.insert({ "content-type", entry.contentType });
+		auto response = std::make_unique<LocalAssetResponse>(STORED_RESPONSE_STATUS, entry.contentType, responseHeaders, entry.body);
+		return asyncSystem.createResolvedFuture<FutureResult_t>(std::make_shared<LocalAssetRequest>(
+			"GET",
+			url,
+			CesiumAsync::HttpHeaders(headers.begin(), headers.end()),
+			std::move(response)
+		));
+	}
+
+	return this->m_assetAccessor->get(asyncSystem, url, headers).thenImmediately([state, url](FutureResult_t&& request) {
+		on_response(state, url, *request);
+		return std::move(request);
+	});
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> IonStartupAssetAccessor::request(const CesiumAsync::AsyncSystem& asyncSystem, const std::string& verb, const std::string& url, const std::vector<THeader>& headers /*= std::vector<THeader>()*/, const std::span<const std::byte>& contentPayload /*= {}*/)
+{
+	return this->m_assetAccessor->request(asyncSystem, verb, url, headers, contentPayload);
+}
+
+void IonStartupAssetAccessor::tick() noexcept
+{
+	this->m_assetAccessor->tick();
+}
+
+bool IonStartupAssetAccessor::is_endpoint_url(const std::string& url)
+{
+	// https://api.cesium.com/v1/assets/<id>/endpoint?access_token=..., self-hosted Ion servers share the path
+	const std::string_view path = std::string_view(url).substr(0, url.find_first_of("?#"));
+	return path.find("/v1/assets/") != std::string_view::npos && path.ends_with("/endpoint");
+}
+
+void IonStartupAssetAccessor::register_root_urls(SharedState_t& state, const Dictionary& endpoint)
+{
+	const std::string rootUrl = String(endpoint.get("url", "")).utf8().get_data();
+	if (rootUrl.empty()) return;
+	std::scoped_lock lock(state.mutex);
+	state.rootUrls.insert(rootUrl);
+	// Terrain endpoints name the folder, cesium asks for its layer.json
+	if (String(endpoint.get("type", "")) == "TERRAIN") {
+		state.rootUrls.insert(CesiumUtility::Uri::resolve(rootUrl, "layer.json", true));
+	}
+}
+
+void IonStartupAssetAccessor::on_response(const std::shared_ptr<SharedState_t>& state, const std::string& url, const CesiumAsync::IAssetRequest& request)
+{
+	const CesiumAsync::IAssetResponse* response = request.response();
+	if (response == nullptr || response->statusCode() < 200 || response->statusCode() >= 300) return;
+
+	if (!is_endpoint_url(url)) {
+		write_entry(state->directory, url, response->contentType(), get_unix_time() + ROOT_DOCUMENT_MAX_AGE_SECONDS, response->data());
+		return;
+	}
+
+	const Dictionary endpoint = parse_endpoint(response->data());
+	register_root_urls(*state, endpoint);
+	// Without a token expiry there's no telling how long the endpoint stays valid, external assets (Google, Bing) land here
+	const int64_t tokenExpiry = get_token_expiry(endpoint.get("accessToken", ""));
+	if (tokenExpiry <= 0) return;
+	write_entry(state->directory, url, response->contentType(), tokenExpiry - TOKEN_EXPIRY_MARGIN_SECONDS, response->data());
+}
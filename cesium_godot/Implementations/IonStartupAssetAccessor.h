@@ -0,0 +1,75 @@
+#ifndef ION_STARTUP_ASSET_ACCESSOR_H
+#define ION_STARTUP_ASSET_ACCESSOR_H
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/string.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "core/string/ustring.h"
+#include "core/variant/dictionary.h"
+#endif
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+/**
+ * @brief Stale-while-revalidate cache for the round trips an Ion tileset makes before its first tile: the asset's endpoint
+ * (root URL plus a short lived access token) and the root tileset.json / layer.json it points to
+ * A stored endpoint is served as long as its token has not expired, the root documents it references come from the store
+ * as well. Each one is still requested in the background and the store updated for the next launch, the running tileset
+ * keeps what it started with. Only the first request of each URL is served from the store, cesium asks for the endpoint
+ * again when the token it got is rejected and that request has to reach Ion
+ * @note A stored endpoint contains its access token in plain text under the directory, readable by anything with
+ * access to the user data folder until the token expires
+ */
+class IonStartupAssetAccessor final : public CesiumAsync::IAssetAccessor {
+public:
+	/// @brief directory is a Godot path, created on the first write
+	IonStartupAssetAccessor(std::shared_ptr<CesiumAsync::IAssetAccessor> assetAccessor, const String& directory);
+
+	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+		get(const CesiumAsync::AsyncSystem& asyncSystem,
+			const std::string& url,
+			const std::vector<THeader>& headers = {}) override;
+
+	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+		const CesiumAsync::AsyncSystem& asyncSystem,
+		const std::string& verb,
+		const std::string& url,
+		const std::vector<THeader>& headers = std::vector<THeader>(),
+		const std::span<const std::byte>& contentPayload = {}) override;
+
+	void tick() noexcept override;
+
+private:
+	/// @brief Continuations outlive neither the accessor's store nor its bookkeeping, they share this with it
+	struct SharedState_t {
+		String directory;
+
+		std::mutex mutex;
+
+		/// @brief Root documents announced by an endpoint response, stored or fresh
+		std::unordered_set<std::string> rootUrls;
+
+		/// @brief URLs already answered from the store in this session
+		std::unordered_set<std::string> servedUrls;
+	};
+
+	static bool is_endpoint_url(const std::string& url);
+
+	/// @brief The endpoint's root document, plus its layer.json for terrain
+	static void register_root_urls(SharedState_t& state, const Dictionary& endpoint);
+
+	/// @brief Stores a successful response and, for an endpoint, registers the root documents it announces
+	static void on_response(const std::shared_ptr<SharedState_t>& state, const std::string& url, const CesiumAsync::IAssetRequest& request);
+
+	std::shared_ptr<CesiumAsync::IAssetAccessor> m_assetAccessor;
+
+	std::shared_ptr<SharedState_t> m_state;
+};
+
+#endif // !ION_STARTUP_ASSET_ACCESSOR_H
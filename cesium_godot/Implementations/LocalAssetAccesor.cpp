@@ -0,0 +1,218 @@
+#include "LocalAssetAccesor.h"
+#include "missing_functions.hpp"
+#include "../Models/LocalAssetResponse.h"
+#include "../Models/LocalAssetRequest.h"
+#include "../Utils/MappedFile.h"
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#elif defined(CESIUM_GD_MODULE)
+#include "core/config/project_settings.h"
+#include "core/io/file_access.h"
+#endif
+
+#include "CesiumUtility/Uri.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <stdexcept>
+
+using FutureResult_t = std::shared_ptr<CesiumAsync::IAssetRequest>;
+
+// Below this, mapping and unmapping the file costs more than copying it out in a single read
+constexpr uint64_t MIN_MAPPED_FILE_BYTES = 64 * 1024;
+
+LocalAssetAccessor::LocalAssetAccessor(uint32_t ioThreadCount /*= 0*/, uint32_t maxQueuedReads /*= 1024*/)
+	: m_maxQueuedReads{ std::max<size_t>(maxQueuedReads, 1) }
+{
+	if (ioThreadCount == 0) {
+		// NVMe drives only reach their throughput with several reads in flight, the threads mostly wait on the disk
+		ioThreadCount = std::clamp(std::thread::hardware_concurrency() / 2, 2u, 8u);
+	}
+	this->m_ioThreads.reserve(ioThreadCount);
+	for (uint32_t i = 0; i < ioThreadCount; i++) {
+		this->m_ioThreads.emplace_back([this]() { this->run_io_thread(); });
+	}
+}
+
+LocalAssetAccessor::~LocalAssetAccessor()
+{
+	{
+		std::scoped_lock lock(this->m_queueMutex);
+		this->m_stopping = true;
+	}
+	this->m_jobAvailable.notify_all();
+	// Reads still queued are served before the threads exit, nobody is left waiting on a promise
+	for (std::thread& ioThread : this->m_ioThreads) {
+		ioThread.join();
+	}
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> LocalAssetAccessor::get(const CesiumAsync::AsyncSystem& asyncSystem, const std::string& url, const std::vector<THeader>& headers /*= {}*/)
+{
+	//Get the asset from the local file system instead of a web request
+	CesiumAsync::Promise<FutureResult_t> promise = asyncSystem.createPromise<FutureResult_t>();
+	CesiumAsync::Future<FutureResult_t> future = promise.getFuture();
+	String godotPath;
+	std::string nativePath;
+	if (!resolve_url(url, &godotPath, &nativePath)) {
+		promise.reject(std::runtime_error("Not a local file URL: " + url));
+		return future;
+	}
+	ReadJob_t job{
+		url,
+		get_content_type(std::string_view(url).substr(0, url.find_first_of("?#"))),
+		godotPath,
+		std::move(nativePath),
+		std::move(promise)
+	};
+
+	{
+		// Cesium calls this from the main thread, waiting for room here would stall the frame
+		std::scoped_lock lock(this->m_queueMutex);
+		if (this->m_stopping) {
+			job.promise.reject(std::runtime_error("The local asset accessor is shutting down"));
+			return future;
+		}
+		if (this->m_pendingReads.size() < this->m_maxQueuedReads) {
+			this->m_pendingReads.push_back(std::move(job));
+			this->m_jobAvailable.notify_one();
+			return future;
+		}
+	}
+	// The queue is full, read on one of cesium's workers instead of growing it
+	asyncSystem.runInWorkerThread([job = std::move(job)]() mutable {
+		read_file(job);
+	});
+	return future;
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> LocalAssetAccessor::request(const CesiumAsync::AsyncSystem& asyncSystem, const std::string& verb, const std::string& url, const std::vector<THeader>& headers /*= std::vector<THeader>()*/, const std::span<const std::byte>& contentPayload /*= {}*/)
+{
+	if (verb == "GET") {
+		return this->get(asyncSystem, url, headers);
+	}
+	CesiumAsync::Promise<FutureResult_t> promise = asyncSystem.createPromise<FutureResult_t>();
+	promise.reject(std::runtime_error("Local assets only support GET requests, got " + verb));
+	return promise.getFuture();
+}
+
+void LocalAssetAccessor::tick() noexcept
+{
+}
+
+bool LocalAssetAccessor::is_local_url(const std::string& url)
+{
+	if (url.starts_with("file:") || url.starts_with("res://") || url.starts_with("user://")) return true;
+	// No scheme at all, a path on the file system
+	return url.find("://") == std::string::npos;
+}
+
+std::string LocalAssetAccessor::to_url(const std::string& pathOrUrl)
+{
+	if (pathOrUrl.find("://") != std::string::npos || pathOrUrl.starts_with("file:")) return pathOrUrl;
+	// C:\data\tileset.json becomes /C:/data/tileset.json, the extra slash makes it file:///C:/...
+	const std::string uriPath = CesiumUtility::Uri::nativePathToUriPath(pathOrUrl);
+	return "file://" + std::string(uriPath.starts_with("/") ? "" : "/") + uriPath;
+}
+
+std::string LocalAssetAccessor::get_content_type(std::string_view path)
+{
+	const size_t dot = path.find_last_of('.');
+	if (dot == std::string_view::npos || path.find_first_of("/\\", dot) != std::string_view::npos) return "application/octet-stream";
+	std::string extension(path.substr(dot + 1));
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	if (extension == "json") return "application/json";
+	if (extension == "glb") return "model/gltf-binary";
+	if (extension == "gltf") return "model/gltf+json";
+	if (extension == "terrain") return "application/vnd.quantized-mesh";
+	if (extension == "png") return "image/png";
+	if (extension == "jpg" || extension == "jpeg") return "image/jpeg";
+	if (extension == "webp") return "image/webp";
+	if (extension == "ktx2") return "image/ktx2";
+	// b3dm, i3dm, pnts, cmpt, subtree and anything else
+	return "application/octet-stream";
+}
+
+bool LocalAssetAccessor::resolve_url(const std::string& url, String* outGodotPath, std::string* outNativePath)
+{
+	if (url.starts_with("file:")) {
+		*outNativePath = CesiumUtility::Uri::uriPathToNativePath(CesiumUtility::Uri::getPath(url));
+		*outGodotPath = String::utf8(outNativePath->c_str());
+		return !outNativePath->empty();
+	}
+	if (url.starts_with("res://") || url.starts_with("user://")) {
+		// Godot paths aren't URLs to cesium's parser, take the whole thing minus query and fragment
+		*outGodotPath = String::utf8(url.substr(0, url.find_first_of("?#")).c_str()).uri_decode();
+		// Only paths on the OS file system can be mapped, globalize_path only reads settings fixed at startup
+		*outNativePath = ProjectSettings::get_singleton()->globalize_path(*outGodotPath).utf8().get_data();
+		return true;
+	}
+	return false;
+}
+
+void LocalAssetAccessor::run_io_thread()
+{
+	for (;;) {
+		std::unique_lock lock(this->m_queueMutex);
+		this->m_jobAvailable.wait(lock, [this]() {
+			return this->m_stopping || !this->m_pendingReads.empty();
+		});
+		if (this->m_pendingReads.empty()) return;
+		ReadJob_t job = std::move(this->m_pendingReads.front());
+		this->m_pendingReads.pop_front();
+		lock.unlock();
+
+		read_file(job);
+	}
+}
+
+void LocalAssetAccessor::read_file(ReadJob_t& job)
+{
+	CesiumAsync::HttpHeaders headers;
+	headers.insert({ "content-type", job.contentType });
+
+	std::unique_ptr<LocalAssetResponse> assetResponse;
+	if (!job.nativePath.empty()) {
+		// A stat decides between mapping and reading, so the file is only opened once either way
+		std::error_code error;
+		const uint64_t length = std::filesystem::file_size(std::filesystem::path(reinterpret_cast<const char8_t*>(job.nativePath.c_str())), error);
+		if (!error && length >= MIN_MAPPED_FILE_BYTES) {
+			auto mappedFile = std::make_shared<MappedFile>();
+			if (mappedFile->open(job.nativePath)) {
+				// Pages fault in on whichever thread parses the tile, start the readahead from here so that thread rarely waits
+				mappedFile->advise_will_need();
+				const std::span<const std::byte> bytes = mappedFile->get_bytes();
+				assetResponse = std::make_unique<LocalAssetResponse>(OK_STATUS, job.contentType, headers, std::move(mappedFile), bytes);
+			}
+		}
+	}
+
+	if (assetResponse == nullptr) {
+		// Small files, missing ones, and res:// paths living inside a .pck, which have nothing to map
+		Error err;
+		Ref<FileAccess> assetRef = open_file_access_with_err(job.godotPath, FileAccess::READ, &err);
+		if (err == Error::ERR_FILE_NOT_FOUND) {
+			// Like a server would, implicit tilesets probe for subtrees that may not exist
+			auto notFoundResponse = std::make_unique<LocalAssetResponse>(NOT_FOUND_STATUS, job.contentType, headers, PackedByteArray());
+			job.promise.resolve(std::make_shared<LocalAssetRequest>("GET", job.url, headers, std::move(notFoundResponse)));
+			return;
+		}
+		if (err != Error::OK) {
+			job.promise.reject(std::runtime_error(std::string(FILE_ACCESS_ERR) + " " + job.url));
+			return;
+		}
+		assetResponse = std::make_unique<LocalAssetResponse>(OK_STATUS, job.contentType, headers, assetRef->get_buffer(assetRef->get_length()));
+	}
+
+	auto assetRequest = std::make_shared<LocalAssetRequest>(
+		"GET",
+		job.url,
+		headers,
+		std::move(assetResponse)
+	);
+	job.promise.resolve(assetRequest);
+}
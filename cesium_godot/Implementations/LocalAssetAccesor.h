@@ -3,116 +3,100 @@
 
 #include "CesiumAsync/AsyncSystem.h"
 #include "CesiumAsync/Promise.h"
-#include "missing_functions.hpp"
 #include <cstdint>
 #if defined(CESIUM_GD_EXT)
-#include "godot_cpp/variant/packed_byte_array.hpp"
-//#include <godot_cpp/core/error_macros.hpp>
+#include "godot_cpp/variant/string.hpp"
+using namespace godot;
 #elif defined(CESIUM_GD_MODULE)
-#include "core/error/error_list.h"
-#include "core/io/file_access.h"
+#include "core/string/ustring.h"
 #endif
 
 #include "CesiumAsync/IAssetAccessor.h"
 #include "CesiumAsync/IAssetRequest.h"
 #include "CesiumAsync/Future.h"
+#include <condition_variable>
+#include <deque>
 #include <memory>
-#include "../Models/LocalAssetResponse.h"
-#include "../Models/LocalAssetRequest.h"
-#include "CesiumUtility/Uri.h"
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 
 constexpr uint16_t OK_STATUS = 200;
 
+constexpr uint16_t NOT_FOUND_STATUS = 404;
+
 constexpr std::string_view FILE_ACCESS_ERR = "Could not read the given 3D Tileset!";
 
+/**
+ * @brief Serves tilesets from the local file system (file://, res:// and user://)
+ * Every URL is resolved on its own, cesium already resolved it against the tileset.json that referenced it, so nested
+ * tilesets and concurrent requests need no shared state. Reads run on the accessor's own I/O threads, large files are
+ * memory mapped and handed to cesium as a view over the mapped pages instead of being copied into a buffer. Paths packed
+ * into a .pck (exported res://) fall back to FileAccess
+ * @note get() never blocks. The queue of pending reads is bounded, past the cap a read runs on one of cesium's worker threads instead
+ */
 class LocalAssetAccessor final : public CesiumAsync::IAssetAccessor {
 public:
+	/// @brief 0 I/O threads picks a count from the hardware concurrency
+	explicit LocalAssetAccessor(uint32_t ioThreadCount = 0, uint32_t maxQueuedReads = 1024);
+
+	~LocalAssetAccessor() override;
 
 	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
 		get(const CesiumAsync::AsyncSystem& asyncSystem,
 			const std::string& url,
-			const std::vector<THeader>& headers = {}) override {
-		//Get the asset from the local file system instead of a web request
-		return asyncSystem.createFuture<std::shared_ptr<CesiumAsync::IAssetRequest>>([=](CesiumAsync::Promise<std::shared_ptr<CesiumAsync::IAssetRequest>> p_promise) {
-			Error err;
-			String pathToSearch;
-			std::string contentType;
-			contentType.reserve(50);
-
-			if (m_relativeStartPath.is_empty()) {
-				contentType = "application/json";
-				pathToSearch = url.c_str();
-				constexpr int32_t offsetToKeepSlash = 1;
-				m_relativeStartPath = pathToSearch.substr(0, pathToSearch.rfind("/") + offsetToKeepSlash);
-			}
-			else {
-				contentType = "application/octet-stream";
-				pathToSearch = m_relativeStartPath + url.c_str();
-			}
-
-			const String godotFriendlyPath = pathToSearch.substr(strlen("file:///"));
-			Ref<FileAccess> assetRef = open_file_access_with_err(godotFriendlyPath, FileAccess::READ, &err);
-
-			if (err != Error::OK) {
-				std::exception exc(FILE_ACCESS_ERR.data());
-				return p_promise.reject(&exc);
-			}
-
-
-Vector<uint8_t> data;
-#if defined(CESIUM_GD_EXT)
-			PackedByteArray internalBuffer = assetRef->get_buffer(assetRef->get_length());
-			
-			data.resize(internalBuffer.size());
-			//I really really wanted to avoid a memcpy... tough luck
-			//TODO: Change internal holding type of LocalAssetResponse to a PackedByteArray
-			memcpy(data.ptrw(), internalBuffer.ptr(), internalBuffer.size());
-#elif defined(CESIUM_GD_MODULE)
-			data = assetRef->get_buffer(assetRef->get_length());
-#endif
-
-			CesiumAsync::HttpHeaders headers;
-			headers.insert({ "content-type", contentType });
-
-			auto assetResponse = std::make_unique<LocalAssetResponse>(
-				OK_STATUS,
-				contentType,
-				headers,
-				data
-			);
-			constexpr size_t resOffset = 6;
-			//std::string acceptedUri = "file:///" + CesiumUtility::Uri::uriPathToNativePath(url.substr(resOffset));
-			auto assetRequest = std::make_shared<LocalAssetRequest>(
-				"GET",
-				url,
-				headers,
-				std::move(assetResponse)
-			);
-
-			return p_promise.resolve(assetRequest);
-		});
-	}
+			const std::vector<THeader>& headers = {}) override;
 
+	/// @brief Only GET means something for local files
 	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
 		const CesiumAsync::AsyncSystem& asyncSystem,
 		const std::string& verb,
 		const std::string& url,
 		const std::vector<THeader>& headers = std::vector<THeader>(),
-		const std::span<const std::byte>& contentPayload = {}) override {
+		const std::span<const std::byte>& contentPayload = {}) override;
+
+	void tick() noexcept override;
 
-		return asyncSystem.createFuture<std::shared_ptr<CesiumAsync::IAssetRequest>>([=](CesiumAsync::Promise<std::shared_ptr<CesiumAsync::IAssetRequest>> p_promise) {
-			std::exception notImplemented("Method not implemented yet!");
-			return p_promise.reject(&notImplemented);
-		});
-	}
+	/// @brief file://, res:// and user:// URLs as well as plain OS paths
+	static bool is_local_url(const std::string& url);
 
-	void tick() noexcept override {
-		(void)0;
-	}
+	/// @brief OS paths become file:// URLs so cesium can resolve relative content against them, URLs are kept as they are
+	static std::string to_url(const std::string& pathOrUrl);
+
+	/// @brief Content type of a local file from its extension, files carry no headers to tell it
+	static std::string get_content_type(std::string_view path);
 
 private:
-	String m_relativeStartPath;
+	struct ReadJob_t {
+		std::string url;
+		std::string contentType;
+		/// @brief Godot path, used when the file can't be mapped
+		String godotPath;
+		/// @brief Same file as an OS path, empty when it has none
+		std::string nativePath;
+		CesiumAsync::Promise<std::shared_ptr<CesiumAsync::IAssetRequest>> promise;
+	};
+
+	/// @brief False when the URL doesn't point to the local file system
+	static bool resolve_url(const std::string& url, String* outGodotPath, std::string* outNativePath);
+
+	void run_io_thread();
+
+	static void read_file(ReadJob_t& job);
+
+	std::mutex m_queueMutex;
+
+	std::condition_variable m_jobAvailable;
+
+	std::deque<ReadJob_t> m_pendingReads;
+
+	size_t m_maxQueuedReads;
+
+	bool m_stopping = false;
+
+	std::vector<std::thread> m_ioThreads;
 };
 
 #endif // !LOCAL_ASSET_ACCESSOR_H
@@ -1,12 +1,15 @@
 #include "NetworkAssetAccessor.h"
 #include "../Models/LocalAssetResponse.h"
 #include "../Models/LocalAssetRequest.h"
+#include "RequestCoalescer.h"
 #include "CesiumAsync/AsyncSystem.h"
 #include "godot_cpp/classes/engine.hpp"
 #include "godot_cpp/templates/vector.hpp"
 #include "godot_cpp/variant/packed_byte_array.hpp"
 #include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <stdexcept>
 
 #if defined (CESIUM_GD_EXT)
 #include <godot_cpp/classes/http_client.hpp>
@@ -23,6 +26,24 @@ constexpr std::string_view COMPLETED_REQ_EVENT_NAME = "request_completed";
 
 using FutureResult_t = std::shared_ptr<CesiumAsync::IAssetRequest>;
 
+namespace {
+	/// @brief Takes the tag of a PriorityAssetAccessor off the headers, without one the calling thread's priority applies
+	CurlRequestPriority take_priority(std::vector<IAssetAccessor::THeader>& headers)
+	{
+		CurlRequestPriority priority = CurlBandwidthGovernor::get_thread_priority();
+		for (auto it = headers.begin(); it != headers.end(); ++it) {
+			if (it->first != CurlBandwidthGovernor::PRIORITY_HEADER) continue;
+			const int32_t value = std::atoi(it->second.c_str());
+			if (value >= 0 && value < static_cast<int32_t>(CurlRequestPriority::Count)) {
+				priority = static_cast<CurlRequestPriority>(value);
+			}
+			headers.erase(it);
+			break;
+		}
+		return priority;
+	}
+}
+
 NetworkAssetAccessor::NetworkAssetAccessor()
 {
 	constexpr size_t maxThreadsPerClient = 16;
@@ -36,8 +57,12 @@ NetworkAssetAccessor::NetworkAssetAccessor()
 
 CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> NetworkAssetAccessor::get(const CesiumAsync::AsyncSystem& asyncSystem, const std::string& url, const std::vector<THeader>& headers /*= {}*/)
 {
+	// The priority hint lives on the calling thread (or in a header when it came through the request cache),
+	// the request itself is issued from a worker
+	std::vector<THeader> requestHeaders = headers;
+	const CurlRequestPriority priority = take_priority(requestHeaders);
 	return asyncSystem.runInWorkerThread([=, this]() {
-		return process_request(HTTPClient::METHOD_GET, asyncSystem, url, headers);
+		return process_request(HTTPClient::METHOD_GET, asyncSystem, url, requestHeaders, priority);
 	});
 }
 
@@ -88,8 +113,10 @@ CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> NetworkAssetAcc
 	}
 
 	//Check what the method is and then request it accordingly
+	std::vector<THeader> requestHeaders = headers;
+	const CurlRequestPriority priority = take_priority(requestHeaders);
 	return asyncSystem.runInWorkerThread([=, this]() {
-		return process_request(ENUM_METHODS[idx], asyncSystem, url, headers);
+		return process_request(ENUM_METHODS[idx], asyncSystem, url, requestHeaders, priority);
 	});
 }
 
@@ -97,48 +124,73 @@ void NetworkAssetAccessor::tick() noexcept
 {
 }
 
-CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> NetworkAssetAccessor::process_request(HTTPClient::Method method, const CesiumAsync::AsyncSystem& asyncSystem, const std::string& url, const std::vector<THeader>& headers /*= {}*/)
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> NetworkAssetAccessor::process_request(HTTPClient::Method method, const CesiumAsync::AsyncSystem& asyncSystem, const std::string& url, const std::vector<THeader>& headers /*= {}*/, CurlRequestPriority priority /*= CurlRequestPriority::Normal*/)
 {
 	CesiumAsync::Promise<FutureResult_t> p_promise = asyncSystem.createPromise<FutureResult_t>();
 	CesiumAsync::Future<FutureResult_t> future = p_promise.getFuture();
+
+	// Identical GETs already in flight (from any tileset or overlay) share that transfer's response
+	std::string coalescingKey;
+	if (method == HTTPClient::METHOD_GET) {
+		coalescingKey = RequestCoalescer::make_key(url, headers);
+		if (!RequestCoalescer::join(coalescingKey, p_promise)) {
+			return future;
+		}
+	}
+
 	this->m_curlClient.send_request(
 			url.c_str(),
 			method,
-			[url, p_promise = std::move(p_promise)](int32_t responseCode, const PackedByteArray &body) {
+			[url, headers, coalescingKey, p_promise = std::move(p_promise)](int32_t responseCode, const PackedByteArray &body, const CurlResponseHeaders_t &responseHeaders) {
 				if (responseCode >= HTTPClient::ResponseCode::RESPONSE_BAD_REQUEST || responseCode == 0 /* Invalid request will yield 0 */) {
 					const String errorMessage = String("The underlying request failed with code: ") + itos(responseCode);
-					const char *strPtr = reinterpret_cast<const char *>(body.ptr());
-					String bodyStr = strPtr;
-					ERR_PRINT(errorMessage + String("\nURL: ") + String(url.c_str()) + String("\nFailed request's body: ") + bodyStr);
+					std::string bodyStr(reinterpret_cast<const char *>(body.ptr()), body.size());
+					ERR_PRINT(errorMessage + String("\nURL: ") + String(url.c_str()) + String("\nFailed request's body: ") + String(bodyStr.c_str()));
 					if (responseCode == HTTPClient::ResponseCode::RESPONSE_UNAUTHORIZED) {
 						ERR_PRINT("Access to data denied, make sure you're logged into CesiumION and your token has access to the desired asset!");
 					}
-					std::exception exc(errorMessage.utf8().get_data());
-					p_promise.reject(&exc);
+					if (!coalescingKey.empty()) {
+						RequestCoalescer::reject(coalescingKey, errorMessage.utf8().get_data());
+						return;
+					}
+					p_promise.reject(std::runtime_error(errorMessage.utf8().get_data()));
 					return;
 				}
 
-				std::string contentType = "application/octet-stream";
-				CesiumAsync::HttpHeaders headers = { { "content-type", contentType } };
+				// The caching accessor needs Cache-Control, Expires, ETag and Last-Modified to store and revalidate the response
+				CesiumAsync::HttpHeaders cesiumResponseHeaders;
+				for (const auto& [name, value] : responseHeaders) {
+					// curl already decoded the body, these would describe the bytes on the wire
+					if (name == "content-encoding" || name == "content-length") continue;
+					cesiumResponseHeaders.emplace(name, value);
+				}
+				auto contentTypeIt = cesiumResponseHeaders.find("content-type");
+				if (contentTypeIt == cesiumResponseHeaders.end()) {
+					contentTypeIt = cesiumResponseHeaders.emplace("content-type", "application/octet-stream").first;
+				}
+				const std::string contentType = contentTypeIt->second;
 
-				// const char *strPtr = reinterpret_cast<const char *>(body.ptr());
-				// printf("%s\n", strPtr);
-				
-				//Convert the body to a Cesium readable format
+				//Convert the body to a Cesium readable format, a 304 carries no body and is resolved by the caching accessor
 				auto assetResponse = std::make_unique<LocalAssetResponse>(
 						responseCode,
 						contentType,
-						headers,
+						cesiumResponseHeaders,
 						body);
 
+				CesiumAsync::HttpHeaders cesiumRequestHeaders(headers.begin(), headers.end());
 				auto assetRequest = std::make_shared<LocalAssetRequest>(
 						"GET",
 						url,
-						headers,
+						cesiumRequestHeaders,
 						std::move(assetResponse));
+				if (!coalescingKey.empty()) {
+					RequestCoalescer::resolve(coalescingKey, assetRequest);
+					return;
+				}
 				p_promise.resolve(assetRequest);
 			},
-			headers
+			headers,
+			priority
 	);
 	return future;
 }
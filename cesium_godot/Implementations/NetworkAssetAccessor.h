@@ -35,7 +35,7 @@ public:
 	void tick() noexcept override;
 
 private:
-	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> process_request(HTTPClient::Method method, const CesiumAsync::AsyncSystem &asyncSystem, const std::string &url, const std::vector<THeader> &headers = {});
+	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> process_request(HTTPClient::Method method, const CesiumAsync::AsyncSystem &asyncSystem, const std::string &url, const std::vector<THeader> &headers = {}, CurlRequestPriority priority = CurlRequestPriority::Normal);
 
 	CurlHttpClient<100> m_curlClient{};
 };
@@ -0,0 +1,38 @@
+#include "PriorityAssetAccessor.h"
+#include "../Utils/CurlBandwidthGovernor.h"
+#include "CesiumAsync/AsyncSystem.h"
+#include <string>
+
+namespace {
+	std::vector<CesiumAsync::IAssetAccessor::THeader> tag_headers(const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers, CurlRequestPriority priority)
+	{
+		std::vector<CesiumAsync::IAssetAccessor::THeader> tagged = headers;
+		tagged.emplace_back(CurlBandwidthGovernor::PRIORITY_HEADER, std::to_string(static_cast<int32_t>(priority)));
+		return tagged;
+	}
+}
+
+PriorityAssetAccessor::PriorityAssetAccessor(std::shared_ptr<CesiumAsync::IAssetAccessor> assetAccessor)
+	: m_assetAccessor{ std::move(assetAccessor) }
+{
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> PriorityAssetAccessor::get(const CesiumAsync::AsyncSystem& asyncSystem, const std::string& url, const std::vector<THeader>& headers /*= {}*/)
+{
+	const CurlRequestPriority priority = CurlBandwidthGovernor::get_thread_priority();
+	// Most requests run at the default priority, those are passed on untouched
+	if (priority == CurlRequestPriority::Normal) return this->m_assetAccessor->get(asyncSystem, url, headers);
+	return this->m_assetAccessor->get(asyncSystem, url, tag_headers(headers, priority));
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> PriorityAssetAccessor::request(const CesiumAsync::AsyncSystem& asyncSystem, const std::string& verb, const std::string& url, const std::vector<THeader>& headers /*= std::vector<THeader>()*/, const std::span<const std::byte>& contentPayload /*= {}*/)
+{
+	const CurlRequestPriority priority = CurlBandwidthGovernor::get_thread_priority();
+	if (priority == CurlRequestPriority::Normal) return this->m_assetAccessor->request(asyncSystem, verb, url, headers, contentPayload);
+	return this->m_assetAccessor->request(asyncSystem, verb, url, tag_headers(headers, priority), contentPayload);
+}
+
+void PriorityAssetAccessor::tick() noexcept
+{
+	this->m_assetAccessor->tick();
+}
@@ -0,0 +1,34 @@
+#ifndef PRIORITY_ASSET_ACCESSOR_H
+#define PRIORITY_ASSET_ACCESSOR_H
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <memory>
+
+/**
+ * @brief Tags requests with the calling thread's CurlBandwidthGovernor priority
+ * The request cache looks up and forwards requests from its own threads, where a ScopedPriority of the caller
+ * no longer applies. Placed above it, this carries the priority down to the network accessor in a request header
+ */
+class PriorityAssetAccessor final : public CesiumAsync::IAssetAccessor {
+public:
+	explicit PriorityAssetAccessor(std::shared_ptr<CesiumAsync::IAssetAccessor> assetAccessor);
+
+	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+		get(const CesiumAsync::AsyncSystem& asyncSystem,
+			const std::string& url,
+			const std::vector<THeader>& headers = {}) override;
+
+	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+		const CesiumAsync::AsyncSystem& asyncSystem,
+		const std::string& verb,
+		const std::string& url,
+		const std::vector<THeader>& headers = std::vector<THeader>(),
+		const std::span<const std::byte>& contentPayload = {}) override;
+
+	void tick() noexcept override;
+
+private:
+	std::shared_ptr<CesiumAsync::IAssetAccessor> m_assetAccessor;
+};
+
+#endif // !PRIORITY_ASSET_ACCESSOR_H
@@ -0,0 +1,80 @@
+#include "RequestCoalescer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+std::string RequestCoalescer::make_key(const std::string& url, const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
+{
+	std::vector<CesiumAsync::IAssetAccessor::THeader> sortedHeaders = headers;
+	std::sort(sortedHeaders.begin(), sortedHeaders.end());
+
+	std::string key = url;
+	for (const auto& [name, value] : sortedHeaders) {
+		key += '\n';
+		key += name;
+		key += ':';
+		key += value;
+	}
+	return key;
+}
+
+bool RequestCoalescer::join(const std::string& key, const Promise_t& promise)
+{
+	s_requestCount++;
+	std::scoped_lock lock(s_mutex);
+	std::vector<Promise_t>& waiters = s_inFlight[key];
+	waiters.push_back(promise);
+	if (waiters.size() == 1) return true;
+	s_coalescedCount++;
+	return false;
+}
+
+void RequestCoalescer::resolve(const std::string& key, const Request_t& request)
+{
+	for (const Promise_t& promise : take_waiters(key)) {
+		promise.resolve(Request_t(request));
+	}
+}
+
+void RequestCoalescer::reject(const std::string& key, const std::string& errorMessage)
+{
+	for (const Promise_t& promise : take_waiters(key)) {
+		promise.reject(std::runtime_error(errorMessage));
+	}
+}
+
+Dictionary RequestCoalescer::get_statistics()
+{
+	const uint64_t requests = s_requestCount.load();
+	const uint64_t coalesced = s_coalescedCount.load();
+	size_t inFlight = 0;
+	{
+		std::scoped_lock lock(s_mutex);
+		inFlight = s_inFlight.size();
+	}
+
+	Dictionary stats;
+	stats["requests"] = static_cast<int64_t>(requests);
+	stats["transfers"] = static_cast<int64_t>(requests - coalesced);
+	stats["coalesced"] = static_cast<int64_t>(coalesced);
+	stats["in_flight"] = static_cast<int64_t>(inFlight);
+	stats["hit_rate"] = requests == 0 ? 0.0 : static_cast<double>(coalesced) / requests;
+	return stats;
+}
+
+void RequestCoalescer::reset_statistics()
+{
+	s_requestCount = 0;
+	s_coalescedCount = 0;
+}
+
+std::vector<RequestCoalescer::Promise_t> RequestCoalescer::take_waiters(const std::string& key)
+{
+	std::vector<Promise_t> waiters;
+	std::scoped_lock lock(s_mutex);
+	auto it = s_inFlight.find(key);
+	if (it == s_inFlight.end()) return waiters;
+	waiters = std::move(it->second);
+	s_inFlight.erase(it);
+	return waiters;
+}
@@ -0,0 +1,59 @@
+#ifndef REQUEST_COALESCER_H
+#define REQUEST_COALESCER_H
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/variant/dictionary.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "core/variant/dictionary.h"
+#endif
+
+#include <CesiumAsync/AsyncSystem.h>
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Process wide map of in-flight GET requests, identical requests wait on the first transfer instead of starting their own
+ * Shared by every NetworkAssetAccessor, so tilesets, overlays and the credit panel asking for the same
+ * layer.json, texture or Ion endpoint at the same time only pay for one transfer
+ */
+class RequestCoalescer {
+public:
+	using Request_t = std::shared_ptr<CesiumAsync::IAssetRequest>;
+	using Promise_t = CesiumAsync::Promise<Request_t>;
+
+	/// @brief Identity of a request, the URL plus its headers in a canonical order
+	static std::string make_key(const std::string& url, const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers);
+
+	/// @brief Registers the promise under key, returns true if the caller is the first one and has to start the transfer
+	static bool join(const std::string& key, const Promise_t& promise);
+
+	/// @brief Settles every promise waiting on key with the same (immutable) request
+	static void resolve(const std::string& key, const Request_t& request);
+
+	static void reject(const std::string& key, const std::string& errorMessage);
+
+	/// @brief requests, transfers, coalesced, in_flight and hit_rate since the last reset
+	static Dictionary get_statistics();
+
+	static void reset_statistics();
+
+private:
+	static std::vector<Promise_t> take_waiters(const std::string& key);
+
+	static inline std::mutex s_mutex;
+
+	static inline std::unordered_map<std::string, std::vector<Promise_t>> s_inFlight;
+
+	static inline std::atomic<uint64_t> s_requestCount{ 0 };
+
+	static inline std::atomic<uint64_t> s_coalescedCount{ 0 };
+};
+
+#endif // !REQUEST_COALESCER_H
@@ -0,0 +1,30 @@
+#include "RoutingAssetAccessor.h"
+#include "CesiumAsync/AsyncSystem.h"
+
+RoutingAssetAccessor::RoutingAssetAccessor(UrlPredicate_t isLocal, std::shared_ptr<CesiumAsync::IAssetAccessor> localAccessor, std::shared_ptr<CesiumAsync::IAssetAccessor> remoteAccessor)
+	: m_isLocal{ std::move(isLocal) },
+	m_localAccessor{ std::move(localAccessor) },
+	m_remoteAccessor{ std::move(remoteAccessor) }
+{
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> RoutingAssetAccessor::get(const CesiumAsync::AsyncSystem& asyncSystem, const std::string& url, const std::vector<THeader>& headers /*= {}*/)
+{
+	return this->route(url)->get(asyncSystem, url, headers);
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> RoutingAssetAccessor::request(const CesiumAsync::AsyncSystem& asyncSystem, const std::string& verb, const std::string& url, const std::vector<THeader>& headers /*= std::vector<THeader>()*/, const std::span<const std::byte>& contentPayload /*= {}*/)
+{
+	return this->route(url)->request(asyncSystem, verb, url, headers, contentPayload);
+}
+
+void RoutingAssetAccessor::tick() noexcept
+{
+	this->m_localAccessor->tick();
+	this->m_remoteAccessor->tick();
+}
+
+const std::shared_ptr<CesiumAsync::IAssetAccessor>& RoutingAssetAccessor::route(const std::string& url) const
+{
+	return this->m_isLocal(url) ? this->m_localAccessor : this->m_remoteAccessor;
+}
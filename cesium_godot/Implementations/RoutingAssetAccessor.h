@@ -0,0 +1,45 @@
+#ifndef ROUTING_ASSET_ACCESSOR_H
+#define ROUTING_ASSET_ACCESSOR_H
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Sends the URLs a tileset serves itself (local files, archive entries) to one accessor and everything else to another
+ * Raster overlays go through their tileset's accessor, imagery from Ion or a URL template on top of a local tileset
+ * still has to reach the network
+ */
+class RoutingAssetAccessor final : public CesiumAsync::IAssetAccessor {
+public:
+	using UrlPredicate_t = std::function<bool(const std::string&)>;
+
+	/// @brief isLocal is called from whichever thread makes the request
+	RoutingAssetAccessor(UrlPredicate_t isLocal, std::shared_ptr<CesiumAsync::IAssetAccessor> localAccessor, std::shared_ptr<CesiumAsync::IAssetAccessor> remoteAccessor);
+
+	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+		get(const CesiumAsync::AsyncSystem& asyncSystem,
+			const std::string& url,
+			const std::vector<THeader>& headers = {}) override;
+
+	CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+		const CesiumAsync::AsyncSystem& asyncSystem,
+		const std::string& verb,
+		const std::string& url,
+		const std::vector<THeader>& headers = std::vector<THeader>(),
+		const std::span<const std::byte>& contentPayload = {}) override;
+
+	void tick() noexcept override;
+
+private:
+	const std::shared_ptr<CesiumAsync::IAssetAccessor>& route(const std::string& url) const;
+
+	UrlPredicate_t m_isLocal;
+
+	std::shared_ptr<CesiumAsync::IAssetAccessor> m_localAccessor;
+
+	std::shared_ptr<CesiumAsync::IAssetAccessor> m_remoteAccessor;
+};
+
+#endif // !ROUTING_ASSET_ACCESSOR_H
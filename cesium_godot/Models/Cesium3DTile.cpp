@@ -33,8 +33,12 @@ void Cesium3DTile::apply_position_on_globe(const glm::dvec3& engineOrigin) {
 
 
 void Cesium3DTile::generate_tile_collision() {
+	this->generate_tile_collision_from_faces(this->get_collision_faces());
+}
+
+void Cesium3DTile::generate_tile_collision_from_faces(const PackedVector3Array& faces) {
 	// Get our static body and add it as a child of the mesh
-	StaticBody3D* staticBody = Object::cast_to<StaticBody3D>(this->create_collision_node_custom_trimesh());
+	StaticBody3D* staticBody = Object::cast_to<StaticBody3D>(this->create_collision_node_custom_trimesh(faces));
 	ERR_FAIL_NULL_MSG(staticBody, "Unable to generate tile collision, failed to create the tile's shape");
 	staticBody->set_name(String(this->get_name()) + "_col");
 
@@ -69,12 +73,8 @@ void Cesium3DTile::add_metadata(const CesiumGltf::Model* model, const CesiumGltf
 	}
 }
 
-Ref<ConcavePolygonShape3D> Cesium3DTile::create_trimesh_shape_inverse_winding()  {
+PackedVector3Array Cesium3DTile::get_collision_faces() {
 	const auto& faces = this->get_mesh()->get_faces();
-	if (faces.size() == 0) {
-		return Ref<ConcavePolygonShape3D>();
-	}
-
 	PackedVector3Array facePoints;
 	facePoints.resize(faces.size());
 
@@ -84,15 +84,22 @@ Ref<ConcavePolygonShape3D> Cesium3DTile::create_trimesh_shape_inverse_winding()
 		facePoints.set(i + 1, faces.get(i + 1));
 		facePoints.set(i + 2, faces.get(i));
 	}
+	return facePoints;
+}
+
+Ref<ConcavePolygonShape3D> Cesium3DTile::create_trimesh_shape_inverse_winding(const PackedVector3Array& faces)  {
+	if (faces.size() == 0) {
+		return Ref<ConcavePolygonShape3D>();
+	}
 
 	Ref<ConcavePolygonShape3D> shape = memnew(ConcavePolygonShape3D);
-	shape->set_faces(facePoints);
+	shape->set_faces(faces);
 	return shape;
 }
 
 
-Node* Cesium3DTile::create_collision_node_custom_trimesh() {
-	Ref<ConcavePolygonShape3D> shape = this->create_trimesh_shape_inverse_winding();
+Node* Cesium3DTile::create_collision_node_custom_trimesh(const PackedVector3Array& faces) {
+	Ref<ConcavePolygonShape3D> shape = this->create_trimesh_shape_inverse_winding(faces);
 	if (shape.is_null()) {
 		return nullptr;
 	}
@@ -114,6 +121,45 @@ int32_t Cesium3DTile::get_table_count() const {
 	return this->m_metadata.get_table_count();
 }
 
+void Cesium3DTile::set_overlay_layer(int32_t layerIndex, const OverlayLayer_t& layer, const std::vector<int32_t>& surfaceIndices) {
+	ERR_FAIL_INDEX_MSG(layerIndex, MAX_OVERLAY_LAYERS, "Overlay layer index exceeds the amount of layers a tile can composite");
+	Ref<Mesh> mesh = this->get_mesh();
+	ERR_FAIL_COND_MSG(mesh.is_null(), "Cannot attach an overlay to a tile without a mesh");
+
+	const int32_t surfaceCount = mesh->get_surface_count();
+	if (this->m_overlayMaterials.size() < static_cast<size_t>(surfaceCount)) {
+		this->m_overlayMaterials.resize(surfaceCount);
+	}
+
+	// Surfaces receiving overlays for the first time get their composite material, built from the glTF one
+	for (int32_t surfaceIndex : surfaceIndices) {
+		if (surfaceIndex < 0 || surfaceIndex >= surfaceCount) continue;
+		Ref<ShaderMaterial>& material = this->m_overlayMaterials[surfaceIndex];
+		if (material.is_valid()) continue;
+		Ref<StandardMaterial3D> baseMaterial = mesh->surface_get_material(surfaceIndex);
+		material = CesiumOverlayMaterial::create_composite_material(baseMaterial);
+		// Override on the instance so the mesh itself can be shared between tiles
+		this->set_surface_override_material(surfaceIndex, material);
+	}
+
+	this->m_overlayLayers[layerIndex] = layer;
+	this->m_overlayLayers[layerIndex].active = true;
+	this->apply_overlay_layers();
+}
+
+void Cesium3DTile::clear_overlay_layer(int32_t layerIndex) {
+	ERR_FAIL_INDEX(layerIndex, MAX_OVERLAY_LAYERS);
+	this->m_overlayLayers[layerIndex] = OverlayLayer_t{};
+	this->apply_overlay_layers();
+}
+
+void Cesium3DTile::apply_overlay_layers() {
+	for (const Ref<ShaderMaterial>& material : this->m_overlayMaterials) {
+		if (material.is_null()) continue;
+		CesiumOverlayMaterial::apply_layers(material, this->m_overlayLayers);
+	}
+}
+
 void Cesium3DTile::_bind_methods() {
     ClassDB::bind_method(D_METHOD("get_metadata_table", "index"), &Cesium3DTile::get_metadata_table);
     ClassDB::bind_method(D_METHOD("get_table_count"), &Cesium3DTile::get_table_count);
@@ -3,6 +3,7 @@
 
 #include "CesiumGltf/Model.h"
 #include "Models/TileMetadata.h"
+#include "Utils/CesiumOverlayMaterial.h"
 #include "godot_cpp/variant/dictionary.hpp"
 #include <cstdint>
 #if defined(CESIUM_GD_EXT)
@@ -12,6 +13,7 @@ using namespace godot;
 #endif
 
 #include <glm/ext/vector_double3.hpp>
+#include <vector>
 
 namespace CesiumGltf {
 	class Model;
@@ -35,23 +37,41 @@ public:
 	void apply_position_on_globe(const glm::dvec3& engineOrigin);
 
 	void generate_tile_collision();
+
+	/// @brief Same as generate_tile_collision, with triangles that were already extracted (e.g. read back from the render cache)
+	void generate_tile_collision_from_faces(const PackedVector3Array& faces);
+
+	/// @brief Mesh triangles with the winding the collision shape expects
+	PackedVector3Array get_collision_faces();
 	
 	void add_metadata(const CesiumGltf::Model* model, const CesiumGltf::ExtensionModelExtStructuralMetadata* metadata);
 	
 	const Dictionary& get_metadata_table(int32_t idx) const;
 
 	int32_t get_table_count() const;
+
+	/// @brief Binds an overlay texture to the given layer of every surface in surfaceIndices, all layers are composited in one material
+	void set_overlay_layer(int32_t layerIndex, const OverlayLayer_t& layer, const std::vector<int32_t>& surfaceIndices);
+
+	void clear_overlay_layer(int32_t layerIndex);
 	
 private:
 
-	Ref<ConcavePolygonShape3D> create_trimesh_shape_inverse_winding();	
+	void apply_overlay_layers();
 
-	Node* create_collision_node_custom_trimesh();
+	Ref<ConcavePolygonShape3D> create_trimesh_shape_inverse_winding(const PackedVector3Array& faces);	
+
+	Node* create_collision_node_custom_trimesh(const PackedVector3Array& faces);
 
 	TileMetadata m_metadata;
 	
 	glm::dvec3 m_originalPosition;
 
+	OverlayLayerArray_t m_overlayLayers;
+
+	/// @brief Composite material per surface, null for surfaces that do not receive overlays
+	std::vector<Ref<ShaderMaterial>> m_overlayMaterials;
+
 protected:
 
 	static void _bind_methods();
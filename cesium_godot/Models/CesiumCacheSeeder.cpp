@@ -0,0 +1,511 @@
+#include "CesiumCacheSeeder.h"
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/geometry2d.hpp>
+#include <godot_cpp/classes/json.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/math/geometry_2d.h"
+#include "core/error/error_macros.h"
+#endif
+
+#include "CesiumGDTileset.h"
+#include "../Utils/CesiumMathUtils.h"
+#include "../Utils/CurlBandwidthGovernor.h"
+#include "Cesium3DTilesSelection/BoundingVolume.h"
+#include "Cesium3DTilesSelection/ITileExcluder.h"
+#include "Cesium3DTilesSelection/Tile.h"
+#include "Cesium3DTilesSelection/Tileset.h"
+#include "Cesium3DTilesSelection/ViewState.h"
+#include "CesiumGeospatial/Cartographic.h"
+#include "CesiumGeospatial/Ellipsoid.h"
+#include "CesiumGeospatial/GlobeRectangle.h"
+#include <algorithm>
+#include <cmath>
+
+// The views mimic a 1080p camera with a 60 degree vertical FOV, the screen space error then means what it does at runtime
+constexpr double SEED_VIEWPORT_WIDTH = 1920.0;
+constexpr double SEED_VIEWPORT_HEIGHT = 1080.0;
+constexpr double SEED_VERTICAL_FOV_DEGREES = 60.0;
+// Neighbouring views overlap, the edges of a footprint are seen from further away and load coarser tiles
+constexpr double SEED_CELL_OVERLAP = 0.8;
+
+constexpr const char* SEED_TILESET_DESC = "Cesium3DTileset to seed, its data source (Ion asset or URL) decides what is requested.";
+constexpr const char* SEED_REGION_POLYGON_DESC = "Longitude / latitude vertices in degrees, edges take the short way around so the polygon may cross the antimeridian. When set, replaces the rectangle with the polygon's bounds and only seeds views inside it.";
+constexpr const char* SEED_MAXIMUM_SCREEN_SPACE_ERROR_DESC = "Screen space error the tileset is refined to while seeding, use the value the tileset runs with.";
+constexpr const char* SEED_MAXIMUM_LEVEL_DESC = "Tiles deeper than this in the tile hierarchy are not loaded, -1 removes the limit.";
+constexpr const char* SEED_VIEW_HEIGHT_DESC = "Height above the ellipsoid (in meters) of the downward looking views, lower views load finer tiles and need more of them.";
+constexpr const char* SEED_RESUME_FILE_DESC = "Progress of the current job, removed once it finishes.";
+
+namespace {
+	/// @brief Keeps the traversal inside the seeded region and above the maximum level
+	class SeedRegionExcluder : public Cesium3DTilesSelection::ITileExcluder {
+	public:
+		SeedRegionExcluder(const CesiumGeospatial::GlobeRectangle& region, int32_t maximumLevel) : m_region(region), m_maximumLevel(maximumLevel)
+		{
+		}
+
+		bool shouldExclude(const Cesium3DTilesSelection::Tile& tile) const noexcept override
+		{
+			if (this->m_maximumLevel >= 0) {
+				int32_t level = 0;
+				for (const Cesium3DTilesSelection::Tile* parent = tile.getParent(); parent != nullptr; parent = parent->getParent()) {
+					if (++level > this->m_maximumLevel) return true;
+				}
+			}
+			const std::optional<CesiumGeospatial::GlobeRectangle> tileRectangle = Cesium3DTilesSelection::estimateGlobeRectangle(tile.getBoundingVolume());
+			if (!tileRectangle.has_value()) return false;
+			return !tileRectangle->computeIntersection(this->m_region).has_value();
+		}
+
+	private:
+		CesiumGeospatial::GlobeRectangle m_region;
+
+		int32_t m_maximumLevel;
+	};
+}
+
+#pragma region Public Editor Methods
+
+void CesiumCacheSeeder::set_tileset(const NodePath& path)
+{
+	this->m_tilesetPath = path;
+}
+
+const NodePath& CesiumCacheSeeder::get_tileset() const
+{
+	return this->m_tilesetPath;
+}
+
+void CesiumCacheSeeder::set_region_west(double degrees)
+{
+	this->m_regionWest = Math::clamp(degrees, -180.0, 180.0);
+}
+
+double CesiumCacheSeeder::get_region_west() const
+{
+	return this->m_regionWest;
+}
+
+void CesiumCacheSeeder::set_region_south(double degrees)
+{
+	this->m_regionSouth = Math::clamp(degrees, -90.0, 90.0);
+}
+
+double CesiumCacheSeeder::get_region_south() const
+{
+	return this->m_regionSouth;
+}
+
+void CesiumCacheSeeder::set_region_east(double degrees)
+{
+	this->m_regionEast = Math::clamp(degrees, -180.0, 180.0);
+}
+
+double CesiumCacheSeeder::get_region_east() const
+{
+	return this->m_regionEast;
+}
+
+void CesiumCacheSeeder::set_region_north(double degrees)
+{
+	this->m_regionNorth = Math::clamp(degrees, -90.0, 90.0);
+}
+
+double CesiumCacheSeeder::get_region_north() const
+{
+	return this->m_regionNorth;
+}
+
+void CesiumCacheSeeder::set_region_polygon(const PackedVector2Array& polygon)
+{
+	this->m_regionPolygon = polygon;
+}
+
+const PackedVector2Array& CesiumCacheSeeder::get_region_polygon() const
+{
+	return this->m_regionPolygon;
+}
+
+void CesiumCacheSeeder::set_maximum_screen_space_error(double error)
+{
+	this->m_maximumScreenSpaceError = Math::max(error, 0.1);
+}
+
+double CesiumCacheSeeder::get_maximum_screen_space_error() const
+{
+	return this->m_maximumScreenSpaceError;
+}
+
+void CesiumCacheSeeder::set_maximum_level(int32_t level)
+{
+	this->m_maximumLevel = Math::max(level, -1);
+}
+
+int32_t CesiumCacheSeeder::get_maximum_level() const
+{
+	return this->m_maximumLevel;
+}
+
+void CesiumCacheSeeder::set_view_height(double height)
+{
+	this->m_viewHeight = Math::max(height, 1.0);
+}
+
+double CesiumCacheSeeder::get_view_height() const
+{
+	return this->m_viewHeight;
+}
+
+void CesiumCacheSeeder::set_resume_file_path(const String& path)
+{
+	this->m_resumeFilePath = path;
+}
+
+const String& CesiumCacheSeeder::get_resume_file_path() const
+{
+	return this->m_resumeFilePath;
+}
+
+#pragma endregion
+
+bool CesiumCacheSeeder::start()
+{
+	if (this->m_running) return true;
+	Cesium3DTileset* tileset = this->get_tileset_node();
+	ERR_FAIL_COND_V_MSG(tileset == nullptr, false, "CesiumCacheSeeder needs a Cesium3DTileset to seed");
+	ERR_FAIL_COND_V_MSG(tileset->get_native_tileset() == nullptr, false, "The seeded tileset failed to load");
+
+	this->build_cells();
+	ERR_FAIL_COND_V_MSG(this->m_cells.empty(), false, "The seeded region is empty");
+
+	this->m_nextCell = this->read_resume_file();
+	if (this->m_nextCell >= static_cast<int32_t>(this->m_cells.size())) {
+		this->m_nextCell = 0;
+	}
+	this->apply_seed_options(tileset);
+	this->m_running = true;
+	this->set_process(true);
+	return true;
+}
+
+void CesiumCacheSeeder::stop()
+{
+	if (!this->m_running) return;
+	this->m_running = false;
+	this->set_process(false);
+	this->restore_tileset_options();
+}
+
+bool CesiumCacheSeeder::is_running() const
+{
+	return this->m_running;
+}
+
+int32_t CesiumCacheSeeder::get_completed_cells() const
+{
+	return this->m_nextCell;
+}
+
+int32_t CesiumCacheSeeder::get_total_cells() const
+{
+	return static_cast<int32_t>(this->m_cells.size());
+}
+
+void CesiumCacheSeeder::_process(double delta)
+{
+	if (!this->m_running) return;
+	Cesium3DTileset* tileset = this->get_tileset_node();
+	if (tileset == nullptr) {
+		ERR_PRINT("The seeded tileset is gone, seeding stopped");
+		this->stop();
+		return;
+	}
+	Cesium3DTilesSelection::Tileset* nativeTileset = tileset->get_native_tileset();
+	if (nativeTileset == nullptr) return;
+
+	const CesiumGeospatial::Ellipsoid& ellipsoid = CesiumGeospatial::Ellipsoid::WGS84;
+	const SeedCell_t& cell = this->m_cells[this->m_nextCell];
+	const glm::dvec3 position = ellipsoid.cartographicToCartesian(CesiumGeospatial::Cartographic(cell.longitude, cell.latitude, this->m_viewHeight));
+	const glm::dvec3 normal = ellipsoid.geodeticSurfaceNormal(position);
+	// North up, the poles have no east so any horizontal axis works there
+	glm::dvec3 east = glm::cross(glm::dvec3(0.0, 0.0, 1.0), normal);
+	east = glm::length(east) < 1e-9 ? glm::dvec3(0.0, 1.0, 0.0) : glm::normalize(east);
+	const glm::dvec3 north = glm::cross(normal, east);
+
+	const double verticalFOV = Math::deg_to_rad(SEED_VERTICAL_FOV_DEGREES);
+	const double horizontalFOV = 2.0 * Math::atan(SEED_VIEWPORT_WIDTH / SEED_VIEWPORT_HEIGHT * Math::tan(verticalFOV * 0.5));
+	const Cesium3DTilesSelection::ViewState view = Cesium3DTilesSelection::ViewState::create(
+		position,
+		-normal,
+		north,
+		glm::dvec2(SEED_VIEWPORT_WIDTH, SEED_VIEWPORT_HEIGHT),
+		horizontalFOV,
+		verticalFOV
+	);
+	// Blocks until every tile this view selects is loaded (and cached), one cell per frame keeps the loop responsive
+	// Seeding is speculative, other tilesets' regular loads are admitted before it
+	{
+		CurlBandwidthGovernor::ScopedPriority lowPriority(CurlRequestPriority::Low);
+		nativeTileset->updateViewOffline({ view });
+	}
+
+	this->m_nextCell++;
+	this->write_resume_file();
+	this->emit_signal("progress", this->m_nextCell, static_cast<int32_t>(this->m_cells.size()));
+	if (this->m_nextCell >= static_cast<int32_t>(this->m_cells.size())) {
+		this->finish();
+	}
+}
+
+void CesiumCacheSeeder::_exit_tree()
+{
+	this->stop();
+}
+
+void CesiumCacheSeeder::get_region_bounds(double* west, double* south, double* east, double* north) const
+{
+	if (this->m_regionPolygon.is_empty()) {
+		*west = this->m_regionWest;
+		*south = this->m_regionSouth;
+		*east = this->m_regionEast;
+		*north = this->m_regionNorth;
+		return;
+	}
+	const PackedVector2Array polygon = this->get_unwrapped_polygon();
+	*west = polygon[0].x;
+	*south = polygon[0].y;
+	*east = polygon[0].x;
+	*north = polygon[0].y;
+	for (const Vector2& vertex : polygon) {
+		*west = Math::min(*west, static_cast<double>(vertex.x));
+		*east = Math::max(*east, static_cast<double>(vertex.x));
+		*south = Math::min(*south, static_cast<double>(vertex.y));
+		*north = Math::max(*north, static_cast<double>(vertex.y));
+	}
+	if (*east - *west >= 360.0) {
+		*west = -180.0;
+		*east = 180.0;
+	}
+	else if (*east > 180.0) {
+		*east -= 360.0;
+	}
+}
+
+PackedVector2Array CesiumCacheSeeder::get_unwrapped_polygon() const
+{
+	PackedVector2Array polygon = this->m_regionPolygon;
+	const int64_t vertexCount = polygon.size();
+	if (vertexCount == 0) return polygon;
+
+	double latitudeSum = polygon[0].y;
+	for (int64_t i = 1; i < vertexCount; i++) {
+		const double previous = polygon[i - 1].x;
+		const double longitude = polygon[i].x - 360.0 * std::round((polygon[i].x - previous) / 360.0);
+		polygon.set(i, Vector2(longitude, polygon[i].y));
+		latitudeSum += polygon[i].y;
+	}
+
+	// Following the closing edge the same way either lands back on the first vertex, or a whole turn away from it
+	// when the ring goes around a pole. The pole on the side of the ring is added so the polygon covers the cap
+	const Vector2 first = polygon[0];
+	const Vector2 last = polygon[vertexCount - 1];
+	const double turns = std::round((first.x - last.x) / 360.0);
+	if (turns != 0.0) {
+		const double closedLongitude = first.x - 360.0 * turns;
+		const double pole = latitudeSum >= 0.0 ? 90.0 : -90.0;
+		polygon.push_back(Vector2(closedLongitude, first.y));
+		polygon.push_back(Vector2(closedLongitude, pole));
+		polygon.push_back(Vector2(first.x, pole));
+	}
+
+	double west = polygon[0].x;
+	for (const Vector2& vertex : polygon) {
+		west = Math::min(west, static_cast<double>(vertex.x));
+	}
+	const double shift = 360.0 * std::floor((west + 180.0) / 360.0);
+	for (int64_t i = 0; i < polygon.size(); i++) {
+		polygon.set(i, Vector2(polygon[i].x - shift, polygon[i].y));
+	}
+	return polygon;
+}
+
+void CesiumCacheSeeder::build_cells()
+{
+	this->m_cells.clear();
+	double west, south, east, north;
+	this->get_region_bounds(&west, &south, &east, &north);
+	if (north <= south || west == east) return;
+	const PackedVector2Array polygon = this->get_unwrapped_polygon();
+
+	// A west edge east of the east edge crosses the antimeridian
+	const double width = Math::deg_to_rad(east > west ? east - west : east - west + 360.0);
+	const double height = Math::deg_to_rad(north - south);
+	const double radius = CesiumGeospatial::Ellipsoid::WGS84.getMaximumRadius();
+	const double footprint = 2.0 * this->m_viewHeight * Math::tan(Math::deg_to_rad(SEED_VERTICAL_FOV_DEGREES) * 0.5);
+	const double spacing = footprint * SEED_CELL_OVERLAP;
+
+	const int32_t rows = Math::max(1, static_cast<int32_t>(std::ceil(height * radius / spacing)));
+	for (int32_t row = 0; row < rows; row++) {
+		const double latitude = Math::deg_to_rad(south) + (row + 0.5) * height / rows;
+		const int32_t columns = Math::max(1, static_cast<int32_t>(std::ceil(width * radius * Math::cos(latitude) / spacing)));
+		for (int32_t column = 0; column < columns; column++) {
+			double longitude = Math::deg_to_rad(west) + (column + 0.5) * width / columns;
+			if (!polygon.is_empty()) {
+				// The unwrapped polygon may reach past 180, the same meridian a turn further east is tested too
+				const Vector2 point(Math::rad_to_deg(longitude), Math::rad_to_deg(latitude));
+				Geometry2D* geometry = Geometry2D::get_singleton();
+				if (!geometry->is_point_in_polygon(point, polygon) && !geometry->is_point_in_polygon(point + Vector2(360.0, 0.0), polygon)) continue;
+			}
+			if (longitude > Math_PI) longitude -= Math_TAU;
+			this->m_cells.push_back({ longitude, latitude });
+		}
+	}
+}
+
+String CesiumCacheSeeder::get_job_signature() const
+{
+	Cesium3DTileset* tileset = this->get_tileset_node();
+	String source = tileset == nullptr ? String() :
+		tileset->get_data_source() == static_cast<int>(CesiumDataSource::FromCesiumIon) ? String::num_int64(tileset->get_ion_asset_id()) : tileset->get_url();
+	String signature = source + "|" + String::num(this->m_regionWest, 9) + "," + String::num(this->m_regionSouth, 9) + "," +
+		String::num(this->m_regionEast, 9) + "," + String::num(this->m_regionNorth, 9);
+	for (const Vector2& vertex : this->m_regionPolygon) {
+		signature += "," + String::num(vertex.x, 9) + "," + String::num(vertex.y, 9);
+	}
+	return signature + "|" + String::num(this->m_maximumScreenSpaceError) + "|" + String::num_int64(this->m_maximumLevel) + "|" + String::num(this->m_viewHeight);
+}
+
+int32_t CesiumCacheSeeder::read_resume_file() const
+{
+	if (!FileAccess::file_exists(this->m_resumeFilePath)) return 0;
+	const Variant parsed = JSON::parse_string(FileAccess::get_file_as_string(this->m_resumeFilePath));
+	if (parsed.get_type() != Variant::DICTIONARY) return 0;
+	const Dictionary progress = parsed;
+	// A different job (other tileset, region or parameters) starts over
+	if (String(progress.get("job", String())) != this->get_job_signature()) return 0;
+	if (static_cast<int64_t>(progress.get("total_cells", 0)) != static_cast<int64_t>(this->m_cells.size())) return 0;
+	const Variant nextCell = progress.get("next_cell", Variant());
+	// JSON numbers come back as floats, anything else (or out of range) is a damaged file and the job starts over
+	if (nextCell.get_type() != Variant::INT && nextCell.get_type() != Variant::FLOAT) return 0;
+	const int64_t cell = static_cast<int64_t>(nextCell);
+	if (cell < 0 || cell > static_cast<int64_t>(this->m_cells.size())) {
+		ERR_PRINT("Ignoring the seeding resume file " + this->m_resumeFilePath + ", its next cell is out of range");
+		return 0;
+	}
+	return static_cast<int32_t>(cell);
+}
+
+void CesiumCacheSeeder::write_resume_file() const
+{
+	DirAccess::make_dir_recursive_absolute(this->m_resumeFilePath.get_base_dir());
+	Ref<FileAccess> file = FileAccess::open(this->m_resumeFilePath, FileAccess::WRITE);
+	ERR_FAIL_COND_MSG(file.is_null(), "Could not write the seeding resume file " + this->m_resumeFilePath);
+	Dictionary progress;
+	progress["job"] = this->get_job_signature();
+	progress["next_cell"] = this->m_nextCell;
+	progress["total_cells"] = static_cast<int64_t>(this->m_cells.size());
+	file->store_string(JSON::stringify(progress, "\t"));
+	file->close();
+}
+
+Cesium3DTileset* CesiumCacheSeeder::get_tileset_node() const
+{
+	if (!this->is_inside_tree() || this->m_tilesetPath.is_empty()) return nullptr;
+	return Object::cast_to<Cesium3DTileset>(this->get_node_or_null(this->m_tilesetPath));
+}
+
+void CesiumCacheSeeder::apply_seed_options(Cesium3DTileset* tileset)
+{
+	Cesium3DTilesSelection::Tileset* nativeTileset = tileset->get_native_tileset();
+	ERR_FAIL_COND(nativeTileset == nullptr);
+	double west, south, east, north;
+	this->get_region_bounds(&west, &south, &east, &north);
+	const CesiumGeospatial::GlobeRectangle region(Math::deg_to_rad(west), Math::deg_to_rad(south), Math::deg_to_rad(east), Math::deg_to_rad(north));
+	// The tileset's own camera updates are restricted too until seeding stops
+	this->m_excluder = std::make_shared<SeedRegionExcluder>(region, this->m_maximumLevel);
+	Cesium3DTilesSelection::TilesetOptions& options = nativeTileset->getOptions();
+	options.excluders.push_back(this->m_excluder);
+	this->m_previousScreenSpaceError = options.maximumScreenSpaceError;
+	options.maximumScreenSpaceError = this->m_maximumScreenSpaceError;
+}
+
+void CesiumCacheSeeder::restore_tileset_options()
+{
+	std::shared_ptr<Cesium3DTilesSelection::ITileExcluder> excluder = std::move(this->m_excluder);
+	this->m_excluder = nullptr;
+	Cesium3DTileset* tileset = this->get_tileset_node();
+	if (excluder == nullptr || tileset == nullptr) return;
+	Cesium3DTilesSelection::Tileset* nativeTileset = tileset->get_native_tileset();
+	if (nativeTileset == nullptr) return;
+	Cesium3DTilesSelection::TilesetOptions& options = nativeTileset->getOptions();
+	std::erase(options.excluders, excluder);
+	options.maximumScreenSpaceError = this->m_previousScreenSpaceError;
+}
+
+void CesiumCacheSeeder::finish()
+{
+	this->stop();
+	DirAccess::remove_absolute(this->m_resumeFilePath);
+	this->emit_signal("finished");
+}
+
+void CesiumCacheSeeder::_bind_methods()
+{
+	ClassDB::bind_method(D_METHOD("set_tileset", "path"), &CesiumCacheSeeder::set_tileset);
+	ClassDB::bind_method(D_METHOD("get_tileset"), &CesiumCacheSeeder::get_tileset);
+	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "tileset", PROPERTY_HINT_NODE_PATH_VALID_TYPES, "Cesium3DTileset", PROPERTY_USAGE_DEFAULT, SEED_TILESET_DESC), "set_tileset", "get_tileset");
+
+	ClassDB::bind_method(D_METHOD("set_region_west", "degrees"), &CesiumCacheSeeder::set_region_west);
+	ClassDB::bind_method(D_METHOD("get_region_west"), &CesiumCacheSeeder::get_region_west);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "region_west"), "set_region_west", "get_region_west");
+
+	ClassDB::bind_method(D_METHOD("set_region_south", "degrees"), &CesiumCacheSeeder::set_region_south);
+	ClassDB::bind_method(D_METHOD("get_region_south"), &CesiumCacheSeeder::get_region_south);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "region_south"), "set_region_south", "get_region_south");
+
+	ClassDB::bind_method(D_METHOD("set_region_east", "degrees"), &CesiumCacheSeeder::set_region_east);
+	ClassDB::bind_method(D_METHOD("get_region_east"), &CesiumCacheSeeder::get_region_east);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "region_east"), "set_region_east", "get_region_east");
+
+	ClassDB::bind_method(D_METHOD("set_region_north", "degrees"), &CesiumCacheSeeder::set_region_north);
+	ClassDB::bind_method(D_METHOD("get_region_north"), &CesiumCacheSeeder::get_region_north);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "region_north"), "set_region_north", "get_region_north");
+
+	ClassDB::bind_method(D_METHOD("set_region_polygon", "polygon"), &CesiumCacheSeeder::set_region_polygon);
+	ClassDB::bind_method(D_METHOD("get_region_polygon"), &CesiumCacheSeeder::get_region_polygon);
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_VECTOR2_ARRAY, "region_polygon", PROPERTY_HINT_NONE, SEED_REGION_POLYGON_DESC), "set_region_polygon", "get_region_polygon");
+
+	ClassDB::bind_method(D_METHOD("set_maximum_screen_space_error", "error"), &CesiumCacheSeeder::set_maximum_screen_space_error);
+	ClassDB::bind_method(D_METHOD("get_maximum_screen_space_error"), &CesiumCacheSeeder::get_maximum_screen_space_error);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "maximum_screen_space_error", PROPERTY_HINT_NONE, SEED_MAXIMUM_SCREEN_SPACE_ERROR_DESC), "set_maximum_screen_space_error", "get_maximum_screen_space_error");
+
+	ClassDB::bind_method(D_METHOD("set_maximum_level", "level"), &CesiumCacheSeeder::set_maximum_level);
+	ClassDB::bind_method(D_METHOD("get_maximum_level"), &CesiumCacheSeeder::get_maximum_level);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "maximum_level", PROPERTY_HINT_NONE, SEED_MAXIMUM_LEVEL_DESC), "set_maximum_level", "get_maximum_level");
+
+	ClassDB::bind_method(D_METHOD("set_view_height", "height"), &CesiumCacheSeeder::set_view_height);
+	ClassDB::bind_method(D_METHOD("get_view_height"), &CesiumCacheSeeder::get_view_height);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "view_height", PROPERTY_HINT_NONE, SEED_VIEW_HEIGHT_DESC), "set_view_height", "get_view_height");
+
+	ClassDB::bind_method(D_METHOD("set_resume_file_path", "path"), &CesiumCacheSeeder::set_resume_file_path);
+	ClassDB::bind_method(D_METHOD("get_resume_file_path"), &CesiumCacheSeeder::get_resume_file_path);
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "resume_file_path", PROPERTY_HINT_NONE, SEED_RESUME_FILE_DESC), "set_resume_file_path", "get_resume_file_path");
+
+	ClassDB::bind_method(D_METHOD("start"), &CesiumCacheSeeder::start);
+	ClassDB::bind_method(D_METHOD("stop"), &CesiumCacheSeeder::stop);
+	ClassDB::bind_method(D_METHOD("is_running"), &CesiumCacheSeeder::is_running);
+	ClassDB::bind_method(D_METHOD("get_completed_cells"), &CesiumCacheSeeder::get_completed_cells);
+	ClassDB::bind_method(D_METHOD("get_total_cells"), &CesiumCacheSeeder::get_total_cells);
+
+	ADD_SIGNAL(MethodInfo("progress", PropertyInfo(Variant::INT, "completed_cells"), PropertyInfo(Variant::INT, "total_cells")));
+	ADD_SIGNAL(MethodInfo("finished"));
+}
@@ -0,0 +1,164 @@
+#ifndef CESIUM_CACHE_SEEDER_H
+#define CESIUM_CACHE_SEEDER_H
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/node_path.hpp>
+#include <godot_cpp/variant/packed_vector2_array.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "scene/main/node.h"
+#endif
+
+#include <memory>
+#include <vector>
+
+namespace Cesium3DTilesSelection {
+	class ITileExcluder;
+}
+
+class Cesium3DTileset;
+
+/**
+ * @brief Fills the request cache (and the render cache, when the tileset has it enabled) for a geographic region without a camera
+ * The region is covered by a grid of downward looking views, one grid cell is loaded per frame with updateViewOffline,
+ * so it can be driven from a --headless script: call start() and wait for the finished signal.
+ * Completed cells are recorded in a resume file, starting the same job again continues where it stopped
+ */
+class CesiumCacheSeeder : public Node {
+	GDCLASS(CesiumCacheSeeder, Node)
+public:
+	CesiumCacheSeeder() = default;
+
+#pragma region Public Editor Methods
+
+	/// @brief Cesium3DTileset to seed, its data source (Ion asset or URL) decides what is requested
+	void set_tileset(const NodePath& path);
+
+	const NodePath& get_tileset() const;
+
+	void set_region_west(double degrees);
+
+	double get_region_west() const;
+
+	void set_region_south(double degrees);
+
+	double get_region_south() const;
+
+	void set_region_east(double degrees);
+
+	double get_region_east() const;
+
+	void set_region_north(double degrees);
+
+	double get_region_north() const;
+
+	/// @brief Longitude / latitude vertices in degrees, replaces the rectangle with its bounds when not empty
+	void set_region_polygon(const PackedVector2Array& polygon);
+
+	const PackedVector2Array& get_region_polygon() const;
+
+	void set_maximum_screen_space_error(double error);
+
+	double get_maximum_screen_space_error() const;
+
+	void set_maximum_level(int32_t level);
+
+	int32_t get_maximum_level() const;
+
+	void set_view_height(double height);
+
+	double get_view_height() const;
+
+	void set_resume_file_path(const String& path);
+
+	const String& get_resume_file_path() const;
+
+#pragma endregion
+
+	/// @brief Starts (or resumes) seeding, returns false when the tileset or the region is not usable
+	bool start();
+
+	/// @brief Stops after the current cell, the resume file keeps the progress
+	void stop();
+
+	bool is_running() const;
+
+	int32_t get_completed_cells() const;
+
+	int32_t get_total_cells() const;
+
+	void _process(double delta) override;
+
+	/// @brief Stops seeding, the tileset gets its options back
+	void _exit_tree() override;
+
+private:
+	struct SeedCell_t {
+		double longitude;
+		double latitude;
+	};
+
+	/// @brief Degrees, the polygon's bounds when there is one. West is east of east when the region crosses the antimeridian
+	void get_region_bounds(double* west, double* south, double* east, double* north) const;
+
+	/// @brief The region polygon with its longitudes shifted by whole turns so no edge jumps across the antimeridian,
+	/// its westmost vertex in [-180, 180). A polygon that goes around a pole is closed over that pole
+	PackedVector2Array get_unwrapped_polygon() const;
+
+	void build_cells();
+
+	String get_job_signature() const;
+
+	int32_t read_resume_file() const;
+
+	void write_resume_file() const;
+
+	/// @brief Resolved again every frame, the tileset may be freed while seeding
+	Cesium3DTileset* get_tileset_node() const;
+
+	void apply_seed_options(Cesium3DTileset* tileset);
+
+	void restore_tileset_options();
+
+	void finish();
+
+	NodePath m_tilesetPath;
+
+	double m_regionWest = 0.0;
+
+	double m_regionSouth = 0.0;
+
+	double m_regionEast = 0.0;
+
+	double m_regionNorth = 0.0;
+
+	PackedVector2Array m_regionPolygon;
+
+	double m_maximumScreenSpaceError = 16.0;
+
+	/// @brief -1 removes the limit
+	int32_t m_maximumLevel = -1;
+
+	/// @brief Height of the views above the ellipsoid (in meters), the grid spacing follows from it
+	double m_viewHeight = 500.0;
+
+	String m_resumeFilePath = "user://cache/seed_progress.json";
+
+	/// @brief Radians
+	std::vector<SeedCell_t> m_cells;
+
+	int32_t m_nextCell = 0;
+
+	bool m_running = false;
+
+	/// @brief Restricts the tileset to the region and level while seeding
+	std::shared_ptr<Cesium3DTilesSelection::ITileExcluder> m_excluder = nullptr;
+
+	double m_previousScreenSpaceError = 16.0;
+
+protected:
+	static void _bind_methods();
+};
+
+#endif // !CESIUM_CACHE_SEEDER_H
@@ -3,7 +3,9 @@
 
 enum CesiumDataSource {
 	FromCesiumIon,
-	FromUrl
+	FromUrl,
+	/// @brief A 3TZ or zip archive on disk, the url property holds its path
+	FromArchive
 };
 
 #endif // !CESIUM_DATA_SOURCE_H
@@ -1,5 +1,7 @@
 #include "CesiumGDConfig.h"
 #include "Utils/AssetManipulation.h"
+#include "Utils/CesiumTileMeshCache.h"
+#include "Utils/LocalCacheManager.h"
 #include "error_names.hpp"
 #include "godot_cpp/classes/dir_access.hpp"
 #include "godot_cpp/classes/file_access.hpp"
@@ -7,6 +9,7 @@
 #include "godot_cpp/classes/project_settings.hpp"
 #include "godot_cpp/core/class_db.hpp"
 #include "godot_cpp/core/error_macros.hpp"
+#include "godot_cpp/core/math.hpp"
 #include "missing_functions.hpp"
 
 
@@ -14,6 +17,17 @@ constexpr const char* CACHE_PATH = "user://cache";
 
 #define CONFIG_FILE_PATH String(CACHE_PATH) + "/ion_session.dat"
 
+constexpr const char* REQUEST_CACHE_PATH_DESC = "Database of cached tile responses, user:// and res:// paths are allowed.";
+constexpr const char* REQUEST_CACHE_MAX_ITEMS_DESC = "Least recently used responses are evicted past this count, 0 removes the limit.";
+constexpr const char* REQUEST_CACHE_MAX_SIZE_DESC = "Least recently used responses are evicted once their bodies add up to more than this (in MiB), 0 removes the limit.";
+constexpr const char* REQUESTS_PER_CACHE_PRUNE_DESC = "The limits are enforced once every this many requests.";
+constexpr const char* REQUEST_CACHE_WRITE_BATCH_DESC = "Cached responses are written in the background, up to this many per transaction.";
+constexpr const char* REQUEST_CACHE_COMPRESSION_DESC = "Compress cached responses with zstd and a dictionary trained per kind of content (SQLite backend), entries already compressed are read either way.";
+constexpr const char* ION_STARTUP_CACHE_DESC = "Start Ion tilesets from the endpoint and root document stored by the previous launch while they are revalidated in the background, as long as the stored access token has not expired. The endpoint, with its short lived access token, is stored unencrypted next to the request cache.";
+constexpr const char* REQUEST_CACHE_BACKEND_HINT = "SQLite,Pack File";
+constexpr const char* RENDER_CACHE_SIZE_DESC = "Converted tiles stored on disk (in MiB) by tilesets with render_cache_enabled, the oldest are deleted past this when a tileset loads.";
+constexpr const char* DECODED_TILE_CACHE_SIZE_DESC = "Converted tiles kept in memory (in MiB) after their tileset unloads them, so recreated tilesets don't convert them again. 0 disables it.";
+
 void CesiumGDConfig::set_access_token(const String& accessToken)
 {
 	// Write to cache
@@ -40,6 +54,106 @@ const String& CesiumGDConfig::get_access_token() const
 	return this->m_accessToken;
 }
 
+void CesiumGDConfig::set_request_cache_path(const String& path)
+{
+	this->m_requestCachePath = path;
+}
+
+const String& CesiumGDConfig::get_request_cache_path() const
+{
+	return this->m_requestCachePath;
+}
+
+void CesiumGDConfig::set_request_cache_max_items(int64_t count)
+{
+	this->m_requestCacheMaxItems = Math::max<int64_t>(count, 0);
+}
+
+int64_t CesiumGDConfig::get_request_cache_max_items() const
+{
+	return this->m_requestCacheMaxItems;
+}
+
+void CesiumGDConfig::set_request_cache_max_size_mb(int64_t size)
+{
+	this->m_requestCacheMaxSizeMb = Math::max<int64_t>(size, 0);
+}
+
+int64_t CesiumGDConfig::get_request_cache_max_size_mb() const
+{
+	return this->m_requestCacheMaxSizeMb;
+}
+
+void CesiumGDConfig::set_requests_per_cache_prune(int32_t count)
+{
+	this->m_requestsPerCachePrune = Math::max(count, 1);
+}
+
+int32_t CesiumGDConfig::get_requests_per_cache_prune() const
+{
+	return this->m_requestsPerCachePrune;
+}
+
+void CesiumGDConfig::set_request_cache_write_batch_size(int32_t size)
+{
+	this->m_requestCacheWriteBatchSize = Math::max(size, 1);
+}
+
+int32_t CesiumGDConfig::get_request_cache_write_batch_size() const
+{
+	return this->m_requestCacheWriteBatchSize;
+}
+
+void CesiumGDConfig::set_request_cache_compression(bool enabled)
+{
+	this->m_requestCacheCompression = enabled;
+}
+
+bool CesiumGDConfig::get_request_cache_compression() const
+{
+	return this->m_requestCacheCompression;
+}
+
+void CesiumGDConfig::set_request_cache_backend(int32_t backend)
+{
+	this->m_requestCacheBackend = static_cast<RequestCacheBackend>(Math::clamp(backend, 0, 1));
+}
+
+int32_t CesiumGDConfig::get_request_cache_backend() const
+{
+	return static_cast<int32_t>(this->m_requestCacheBackend);
+}
+
+void CesiumGDConfig::set_ion_startup_cache_enabled(bool enabled)
+{
+	this->m_ionStartupCacheEnabled = enabled;
+}
+
+bool CesiumGDConfig::get_ion_startup_cache_enabled() const
+{
+	return this->m_ionStartupCacheEnabled;
+}
+
+void CesiumGDConfig::set_decoded_tile_cache_size_mb(int64_t size)
+{
+	CesiumTileMeshCache::set_max_bytes(static_cast<uint64_t>(Math::max(size, int64_t(0))) * 1024 * 1024);
+}
+
+int64_t CesiumGDConfig::get_decoded_tile_cache_size_mb() const
+{
+	return static_cast<int64_t>(CesiumTileMeshCache::get_max_bytes() / (1024 * 1024));
+}
+
+void CesiumGDConfig::set_render_cache_size_mb(int64_t size)
+{
+	LocalCacheManager::set_max_render_cache_bytes(static_cast<uint64_t>(Math::max(size, int64_t(0))) * 1024 * 1024);
+}
+
+int64_t CesiumGDConfig::get_render_cache_size_mb() const
+{
+	return static_cast<int64_t>(LocalCacheManager::get_max_render_cache_bytes() / (1024 * 1024));
+}
+
 void CesiumGDConfig::clear_session() {
 	// We could delete the cache if we need to, but we might be able to get away with just setting it once + no longer 	
 }
@@ -107,6 +221,46 @@ void CesiumGDConfig::_bind_methods()
 	ClassDB::bind_method(D_METHOD("get_access_token"), &CesiumGDConfig::get_access_token);
 	ClassDB::bind_method(D_METHOD("set_access_token", "accessToken"), &CesiumGDConfig::set_access_token);
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "accessToken"), "set_access_token", "get_access_token");
+
+	ClassDB::bind_method(D_METHOD("set_request_cache_path", "path"), &CesiumGDConfig::set_request_cache_path);
+	ClassDB::bind_method(D_METHOD("get_request_cache_path"), &CesiumGDConfig::get_request_cache_path);
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "request_cache_path", PROPERTY_HINT_NONE, REQUEST_CACHE_PATH_DESC), "set_request_cache_path", "get_request_cache_path");
+
+	ClassDB::bind_method(D_METHOD("set_request_cache_max_items", "count"), &CesiumGDConfig::set_request_cache_max_items);
+	ClassDB::bind_method(D_METHOD("get_request_cache_max_items"), &CesiumGDConfig::get_request_cache_max_items);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "request_cache_max_items", PROPERTY_HINT_NONE, REQUEST_CACHE_MAX_ITEMS_DESC), "set_request_cache_max_items", "get_request_cache_max_items");
+
+	ClassDB::bind_method(D_METHOD("set_request_cache_max_size_mb", "size"), &CesiumGDConfig::set_request_cache_max_size_mb);
+	ClassDB::bind_method(D_METHOD("get_request_cache_max_size_mb"), &CesiumGDConfig::get_request_cache_max_size_mb);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "request_cache_max_size_mb", PROPERTY_HINT_NONE, REQUEST_CACHE_MAX_SIZE_DESC), "set_request_cache_max_size_mb", "get_request_cache_max_size_mb");
+
+	ClassDB::bind_method(D_METHOD("set_requests_per_cache_prune", "count"), &CesiumGDConfig::set_requests_per_cache_prune);
+	ClassDB::bind_method(D_METHOD("get_requests_per_cache_prune"), &CesiumGDConfig::get_requests_per_cache_prune);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "requests_per_cache_prune", PROPERTY_HINT_NONE, REQUESTS_PER_CACHE_PRUNE_DESC), "set_requests_per_cache_prune", "get_requests_per_cache_prune");
+
+	ClassDB::bind_method(D_METHOD("set_request_cache_write_batch_size", "size"), &CesiumGDConfig::set_request_cache_write_batch_size);
+	ClassDB::bind_method(D_METHOD("get_request_cache_write_batch_size"), &CesiumGDConfig::get_request_cache_write_batch_size);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "request_cache_write_batch_size", PROPERTY_HINT_NONE, REQUEST_CACHE_WRITE_BATCH_DESC), "set_request_cache_write_batch_size", "get_request_cache_write_batch_size");
+
+	ClassDB::bind_method(D_METHOD("set_request_cache_compression", "enabled"), &CesiumGDConfig::set_request_cache_compression);
+	ClassDB::bind_method(D_METHOD("get_request_cache_compression"), &CesiumGDConfig::get_request_cache_compression);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "request_cache_compression", PROPERTY_HINT_NONE, REQUEST_CACHE_COMPRESSION_DESC), "set_request_cache_compression", "get_request_cache_compression");
+
+	ClassDB::bind_method(D_METHOD("set_request_cache_backend", "backend"), &CesiumGDConfig::set_request_cache_backend);
+	ClassDB::bind_method(D_METHOD("get_request_cache_backend"), &CesiumGDConfig::get_request_cache_backend);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "request_cache_backend", PROPERTY_HINT_ENUM, REQUEST_CACHE_BACKEND_HINT), "set_request_cache_backend", "get_request_cache_backend");
+
+	ClassDB::bind_method(D_METHOD("set_decoded_tile_cache_size_mb", "size"), &CesiumGDConfig::set_decoded_tile_cache_size_mb);
+	ClassDB::bind_method(D_METHOD("get_decoded_tile_cache_size_mb"), &CesiumGDConfig::get_decoded_tile_cache_size_mb);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "decoded_tile_cache_size_mb", PROPERTY_HINT_NONE, DECODED_TILE_CACHE_SIZE_DESC), "set_decoded_tile_cache_size_mb", "get_decoded_tile_cache_size_mb");
+
+	ClassDB::bind_method(D_METHOD("set_render_cache_size_mb", "size"), &CesiumGDConfig::set_render_cache_size_mb);
+	ClassDB::bind_method(D_METHOD("get_render_cache_size_mb"), &CesiumGDConfig::get_render_cache_size_mb);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "render_cache_size_mb", PROPERTY_HINT_NONE, RENDER_CACHE_SIZE_DESC), "set_render_cache_size_mb", "get_render_cache_size_mb");
+
+	ClassDB::bind_method(D_METHOD("set_ion_startup_cache_enabled", "enabled"), &CesiumGDConfig::set_ion_startup_cache_enabled);
+	ClassDB::bind_method(D_METHOD("get_ion_startup_cache_enabled"), &CesiumGDConfig::get_ion_startup_cache_enabled);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "ion_startup_cache_enabled", PROPERTY_HINT_NONE, ION_STARTUP_CACHE_DESC), "set_ion_startup_cache_enabled", "get_ion_startup_cache_enabled");
 	
 	ClassDB::bind_static_method("CesiumGDConfig", D_METHOD("get_singleton", "baseNode"), CesiumGDConfig::get_singleton);
 	
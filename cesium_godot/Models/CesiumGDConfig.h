@@ -16,6 +16,18 @@ public:
 	static constexpr std::string_view DEFAULT_ION_API_URL = "https://api.cesium.com/";
 	static constexpr std::string_view DEFAULT_SERVER_URL = "https://ion.cesium.com";
 	static constexpr int32_t DEFAULT_APPLICATION_ID = 891;
+	static constexpr std::string_view DEFAULT_REQUEST_CACHE_PATH = "user://cache/cesium-tile-cache.sqlite";
+	/// @brief Database of cesium's own SqliteCache used before the cache became configurable, deleted on the first load
+	static constexpr std::string_view LEGACY_REQUEST_CACHE_PATH = "user://cache/cesium-request-cache.sqlite";
+	static constexpr int64_t DEFAULT_REQUEST_CACHE_MAX_ITEMS = 4096 * 5;
+	static constexpr int64_t DEFAULT_REQUEST_CACHE_MAX_SIZE_MB = 2048;
+	static constexpr int32_t DEFAULT_REQUESTS_PER_CACHE_PRUNE = 10000;
+	static constexpr int32_t DEFAULT_REQUEST_CACHE_WRITE_BATCH_SIZE = 64;
+
+	enum class RequestCacheBackend : int32_t {
+		Sqlite = 0,
+		PackFile = 1
+	};
 
 	CesiumGDConfig() = default;
 
@@ -23,6 +35,51 @@ public:
 
 	const String& get_access_token() const;
 
+	/// @brief Read by tilesets when they create their request cache, changes apply to tilesets loaded afterwards
+	void set_request_cache_path(const String& path);
+
+	const String& get_request_cache_path() const;
+
+	void set_request_cache_max_items(int64_t count);
+
+	int64_t get_request_cache_max_items() const;
+
+	void set_request_cache_max_size_mb(int64_t size);
+
+	int64_t get_request_cache_max_size_mb() const;
+
+	void set_requests_per_cache_prune(int32_t count);
+
+	int32_t get_requests_per_cache_prune() const;
+
+	void set_request_cache_write_batch_size(int32_t size);
+
+	int32_t get_request_cache_write_batch_size() const;
+
+	void set_request_cache_compression(bool enabled);
+
+	bool get_request_cache_compression() const;
+
+	/// @brief The pack file stores next to request_cache_path, with a .pack extension
+	void set_request_cache_backend(int32_t backend);
+
+	int32_t get_request_cache_backend() const;
+
+	/// @brief Budget of the process-wide cache of converted tiles, shared by every tileset
+	void set_decoded_tile_cache_size_mb(int64_t size);
+
+	int64_t get_decoded_tile_cache_size_mb() const;
+
+	/// @brief Budget of the on-disk cache of converted tiles (next to request_cache_path), enforced when the first tileset loads
+	void set_render_cache_size_mb(int64_t size);
+
+	int64_t get_render_cache_size_mb() const;
+
+	/// @brief Keeps the Ion endpoint and root tileset.json / layer.json of each asset next to request_cache_path for the next launch
+	void set_ion_startup_cache_enabled(bool enabled);
+
+	bool get_ion_startup_cache_enabled() const;
+
 	static CesiumGDConfig* get_singleton(Node* baseNode);
 
 	static void clear_session();
@@ -33,6 +90,23 @@ private:
 	Error create_cache_session_file();
 	
 	String m_accessToken = "";
+
+	String m_requestCachePath = DEFAULT_REQUEST_CACHE_PATH.data();
+
+	int64_t m_requestCacheMaxItems = DEFAULT_REQUEST_CACHE_MAX_ITEMS;
+
+	int64_t m_requestCacheMaxSizeMb = DEFAULT_REQUEST_CACHE_MAX_SIZE_MB;
+
+	int32_t m_requestsPerCachePrune = DEFAULT_REQUESTS_PER_CACHE_PRUNE;
+
+	int32_t m_requestCacheWriteBatchSize = DEFAULT_REQUEST_CACHE_WRITE_BATCH_SIZE;
+
+	bool m_requestCacheCompression = true;
+
+	bool m_ionStartupCacheEnabled = true;
+
+	RequestCacheBackend m_requestCacheBackend = RequestCacheBackend::Sqlite;
+
 	static inline CesiumGDConfig* s_instance = nullptr;
 	
 protected:
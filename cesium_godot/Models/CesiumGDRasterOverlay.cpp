@@ -2,69 +2,203 @@
 #include <CesiumRasterOverlays/IonRasterOverlay.h>
 #include "CesiumGDTileset.h"
 #include "CesiumGDConfig.h"
+#include "../Utils/CesiumOverlayMaterial.h"
+#include <algorithm>
+#include <cmath>
 
-int64_t CesiumIonRasterOverlay::get_asset_id() const
+constexpr const char* ALPHA_DESC = "Opacity of this overlay when composited over the overlays on lower layers.\nApplied when the overlay is added to the tileset.";
+constexpr const char* OVERLAY_TILE_LOADS_DESC = "The maximum number of overlay tiles that may simultaneously be in the process of loading.\nLower it on bandwidth limited links to leave room for the tileset's geometry.";
+constexpr const char* MAXIMUM_TEXTURE_SIZE_DESC = "The maximum pixel size of raster overlay textures.\nA larger value provides more detail but requires more memory to store the texture.";
+constexpr const char* OVERLAY_SCREEN_SPACE_DESC = "The maximum number of pixels of error when rendering this overlay.\nThis is used to select an appropriate level-of-detail for the imagery, independently of the tileset's own screen space error.";
+constexpr const char* SUB_TILE_CACHE_DESC = "The maximum number of bytes to use to cache sub-tiles in memory.\nThis is used by overlays that are composed of many sub-tiles, such as Web Map Tile Service overlays.";
+constexpr const char* LOD_BIAS_DESC = "Shifts the overlay's level-of-detail selection, the screen space error is multiplied by 2^bias.\nPositive values load coarser imagery (favoring geometry when bandwidth is scarce), negative values load finer imagery.";
+
+void CesiumRasterOverlay::set_material_key(const String& key)
 {
-	return this->m_assetId;
+	this->m_materialKey = key;
 }
 
-void CesiumIonRasterOverlay::set_asset_id(int64_t id)
+const String& CesiumRasterOverlay::get_material_key() const
 {
-	this->m_assetId = id;
+	return this->m_materialKey;
 }
 
-void CesiumIonRasterOverlay::set_material_key(const String& key)
+void CesiumRasterOverlay::set_alpha(real_t alpha)
 {
-	this->m_materialKey = key;
+	this->m_alpha = alpha;
 }
 
-const String& CesiumIonRasterOverlay::get_material_key() const
+real_t CesiumRasterOverlay::get_alpha() const
 {
-	return this->m_materialKey;
+	return this->m_alpha;
+}
+
+void CesiumRasterOverlay::set_maximum_simultaneous_tile_loads(int32_t count)
+{
+	this->m_maximumSimultaneousTileLoads = count;
+}
+
+int32_t CesiumRasterOverlay::get_maximum_simultaneous_tile_loads() const
+{
+	return this->m_maximumSimultaneousTileLoads;
+}
+
+void CesiumRasterOverlay::set_maximum_texture_size(int32_t size)
+{
+	this->m_maximumTextureSize = size;
+}
+
+int32_t CesiumRasterOverlay::get_maximum_texture_size() const
+{
+	return this->m_maximumTextureSize;
+}
+
+void CesiumRasterOverlay::set_maximum_screen_space_error(real_t error)
+{
+	this->m_maximumScreenSpaceError = error;
+}
+
+real_t CesiumRasterOverlay::get_maximum_screen_space_error() const
+{
+	return this->m_maximumScreenSpaceError;
+}
+
+void CesiumRasterOverlay::set_sub_tile_cache_bytes(int64_t bytes)
+{
+	this->m_subTileCacheBytes = bytes;
+}
+
+int64_t CesiumRasterOverlay::get_sub_tile_cache_bytes() const
+{
+	return this->m_subTileCacheBytes;
+}
+
+void CesiumRasterOverlay::set_lod_bias(real_t bias)
+{
+	this->m_lodBias = bias;
+}
+
+real_t CesiumRasterOverlay::get_lod_bias() const
+{
+	return this->m_lodBias;
 }
 
-Error CesiumIonRasterOverlay::add_to_tileset(Cesium3DTileset* tilesetInstance)
+Error CesiumRasterOverlay::add_to_tileset(Cesium3DTileset* tilesetInstance)
 {
 	if (tilesetInstance == nullptr) return Error::ERR_INVALID_PARAMETER;
-	if (this->m_assetId <= 0) return Error::ERR_CANT_ACQUIRE_RESOURCE;
 
 	//Overlay already added
 	if (this->m_overlayInstance != nullptr) return Error::OK;
+	// Nothing to attach to when the tileset's source couldn't be opened
+	if (tilesetInstance->get_native_tileset() == nullptr) return Error::ERR_UNCONFIGURED;
+
+	this->m_layerIndex = tilesetInstance->acquire_overlay_layer();
+	ERR_FAIL_COND_V_MSG(this->m_layerIndex < 0, Error::ERR_OUT_OF_MEMORY, "The tileset already composites " + itos(MAX_OVERLAY_LAYERS) + " overlays, remove one first");
+
+	this->m_overlayInstance = this->create_overlay(this->make_overlay_options(tilesetInstance));
+	if (this->m_overlayInstance == nullptr) {
+		tilesetInstance->release_overlay_layer(this->m_layerIndex);
+		this->m_layerIndex = -1;
+		return Error::ERR_CANT_ACQUIRE_RESOURCE;
+	}
 
-	this->create_and_add_overlay(tilesetInstance);
+	tilesetInstance->add_overlay(this);
 	return Error::OK;
 }
 
-void CesiumIonRasterOverlay::remove_from_tileset(Cesium3DTileset* tilesetInstance)
+void CesiumRasterOverlay::remove_from_tileset(Cesium3DTileset* tilesetInstance)
 {
+	if (tilesetInstance == nullptr || this->m_overlayInstance == nullptr) return;
+	tilesetInstance->remove_overlay(this);
+	tilesetInstance->release_overlay_layer(this->m_layerIndex);
+	this->m_layerIndex = -1;
+	this->m_overlayInstance = nullptr;
+}
 
+void CesiumRasterOverlay::_exit_tree()
+{
+	this->remove_from_tileset(Object::cast_to<Cesium3DTileset>(this->get_parent()));
 }
 
-CesiumUtility::IntrusivePointer<CesiumRasterOverlays::IonRasterOverlay> CesiumIonRasterOverlay::get_overlay_instance()
+CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> CesiumRasterOverlay::get_overlay_instance()
 {
 	return this->m_overlayInstance;
 }
 
-void CesiumIonRasterOverlay::create_and_add_overlay(Cesium3DTileset* tilesetInstance)
+CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> CesiumRasterOverlay::create_overlay(const CesiumRasterOverlays::RasterOverlayOptions& overlayOptions)
+{
+	ERR_PRINT("CesiumRasterOverlay is abstract, use one of the overlay nodes for a specific source instead");
+	return nullptr;
+}
+
+CesiumRasterOverlays::RasterOverlayOptions CesiumRasterOverlay::make_overlay_options(Cesium3DTileset* tilesetInstance) const
+{
+	// Overlays are composited in layer order, a removed overlay's layer goes to the next one added
+	CesiumRasterOverlays::RasterOverlayOptions overlayOptions{};
+	overlayOptions.rendererOptions = OverlayLayerOptions_t{ this->m_layerIndex, this->m_alpha };
+	overlayOptions.maximumSimultaneousTileLoads = std::max(1, this->m_maximumSimultaneousTileLoads);
+	overlayOptions.maximumTextureSize = std::max(1, this->m_maximumTextureSize);
+	overlayOptions.subTileCacheBytes = std::max<int64_t>(0, this->m_subTileCacheBytes);
+	overlayOptions.maximumScreenSpaceError = static_cast<double>(this->m_maximumScreenSpaceError) * std::exp2(static_cast<double>(this->m_lodBias));
+	return overlayOptions;
+}
+
+void CesiumRasterOverlay::_bind_methods()
+{
+	ClassDB::bind_method(D_METHOD("set_material_key", "key"), &CesiumRasterOverlay::set_material_key);
+	ClassDB::bind_method(D_METHOD("get_material_key"), &CesiumRasterOverlay::get_material_key);
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "key"), "set_material_key", "get_material_key");
+
+	ClassDB::bind_method(D_METHOD("set_alpha", "alpha"), &CesiumRasterOverlay::set_alpha);
+	ClassDB::bind_method(D_METHOD("get_alpha"), &CesiumRasterOverlay::get_alpha);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "alpha", PROPERTY_HINT_RANGE, "0,1,0.01", ALPHA_DESC), "set_alpha", "get_alpha");
+
+	ClassDB::bind_method(D_METHOD("set_maximum_simultaneous_tile_loads", "count"), &CesiumRasterOverlay::set_maximum_simultaneous_tile_loads);
+	ClassDB::bind_method(D_METHOD("get_maximum_simultaneous_tile_loads"), &CesiumRasterOverlay::get_maximum_simultaneous_tile_loads);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "maximum_simultaneous_tile_loads", PROPERTY_HINT_RANGE, "1,128,1", OVERLAY_TILE_LOADS_DESC), "set_maximum_simultaneous_tile_loads", "get_maximum_simultaneous_tile_loads");
+
+	ClassDB::bind_method(D_METHOD("set_maximum_texture_size", "size"), &CesiumRasterOverlay::set_maximum_texture_size);
+	ClassDB::bind_method(D_METHOD("get_maximum_texture_size"), &CesiumRasterOverlay::get_maximum_texture_size);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "maximum_texture_size", PROPERTY_HINT_RANGE, "64,16384,1", MAXIMUM_TEXTURE_SIZE_DESC), "set_maximum_texture_size", "get_maximum_texture_size");
+
+	ClassDB::bind_method(D_METHOD("set_maximum_screen_space_error", "error"), &CesiumRasterOverlay::set_maximum_screen_space_error);
+	ClassDB::bind_method(D_METHOD("get_maximum_screen_space_error"), &CesiumRasterOverlay::get_maximum_screen_space_error);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "maximum_screen_space_error", PROPERTY_HINT_NONE, OVERLAY_SCREEN_SPACE_DESC), "set_maximum_screen_space_error", "get_maximum_screen_space_error");
+
+	ClassDB::bind_method(D_METHOD("set_sub_tile_cache_bytes", "bytes"), &CesiumRasterOverlay::set_sub_tile_cache_bytes);
+	ClassDB::bind_method(D_METHOD("get_sub_tile_cache_bytes"), &CesiumRasterOverlay::get_sub_tile_cache_bytes);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "sub_tile_cache_bytes", PROPERTY_HINT_NONE, SUB_TILE_CACHE_DESC), "set_sub_tile_cache_bytes", "get_sub_tile_cache_bytes");
+
+	ClassDB::bind_method(D_METHOD("set_lod_bias", "bias"), &CesiumRasterOverlay::set_lod_bias);
+	ClassDB::bind_method(D_METHOD("get_lod_bias"), &CesiumRasterOverlay::get_lod_bias);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "lod_bias", PROPERTY_HINT_RANGE, "-4,4,0.1", LOD_BIAS_DESC), "set_lod_bias", "get_lod_bias");
+}
+
+int64_t CesiumIonRasterOverlay::get_asset_id() const
+{
+	return this->m_assetId;
+}
+
+void CesiumIonRasterOverlay::set_asset_id(int64_t id)
 {
+	this->m_assetId = id;
+}
+
+CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> CesiumIonRasterOverlay::create_overlay(const CesiumRasterOverlays::RasterOverlayOptions& overlayOptions)
+{
+	if (this->m_assetId <= 0) return nullptr;
+
 	const String& ionAccessToken = CesiumGDConfig::get_singleton(this)->get_access_token();
-	this->m_overlayInstance = new CesiumRasterOverlays::IonRasterOverlay(
+	return new CesiumRasterOverlays::IonRasterOverlay(
 		this->m_materialKey.utf8().get_data(),
 		this->m_assetId,
 		ionAccessToken.utf8().get_data(),
-		{}
+		overlayOptions
 	);
-	tilesetInstance->add_overlay(this);
 }
 
 void CesiumIonRasterOverlay::_bind_methods()
 {
-
-	ClassDB::bind_method(D_METHOD("set_material_key", "key"), &CesiumIonRasterOverlay::set_material_key);
-	ClassDB::bind_method(D_METHOD("get_material_key"), &CesiumIonRasterOverlay::get_material_key);
-	ADD_PROPERTY(PropertyInfo(Variant::STRING, "key"), "set_material_key", "get_material_key");
-
-
 	ClassDB::bind_method(D_METHOD("set_asset_id", "id"), &CesiumIonRasterOverlay::set_asset_id);
 	ClassDB::bind_method(D_METHOD("get_asset_id"), &CesiumIonRasterOverlay::get_asset_id);
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "asset_id"), "set_asset_id", "get_asset_id");
@@ -15,46 +15,106 @@ using namespace godot;
 #endif
 
 #include <CesiumUtility/IntrusivePointer.h>
+#include <CesiumRasterOverlays/RasterOverlay.h>
 #include <CesiumRasterOverlays/IonRasterOverlay.h>
 
 class Cesium3DTileset;
 
 class CesiumGDConfig;
 
-class CesiumIonRasterOverlay : public Node3D {
-	GDCLASS(CesiumIonRasterOverlay, Node3D)
+/// @brief Base of every raster overlay node, subclasses only have to build the cesium overlay for their source
+/// @note Overlays are added to the tileset's overlay collection, so their requests go through the tileset's accessor stack (cache, gunzip, curl)
+class CesiumRasterOverlay : public Node3D {
+	GDCLASS(CesiumRasterOverlay, Node3D)
 public:
 #pragma region Editor Properties
-	int64_t get_asset_id() const;
-
-	void set_asset_id(int64_t id);
-
 	void set_material_key(const String& key);
 
 	const String& get_material_key() const;
 
+	void set_alpha(real_t alpha);
+
+	real_t get_alpha() const;
+
+	void set_maximum_simultaneous_tile_loads(int32_t count);
+
+	int32_t get_maximum_simultaneous_tile_loads() const;
+
+	void set_maximum_texture_size(int32_t size);
+
+	int32_t get_maximum_texture_size() const;
+
+	void set_maximum_screen_space_error(real_t error);
+
+	real_t get_maximum_screen_space_error() const;
+
+	void set_sub_tile_cache_bytes(int64_t bytes);
+
+	int64_t get_sub_tile_cache_bytes() const;
+
+	void set_lod_bias(real_t bias);
+
+	real_t get_lod_bias() const;
+
 #pragma endregion
 
 	Error add_to_tileset(Cesium3DTileset* tilesetInstance);
 
+	/// @brief Detaches the overlay from the tileset and gives its composite layer back
 	void remove_from_tileset(Cesium3DTileset* tilesetInstance);
 
-	CesiumUtility::IntrusivePointer<CesiumRasterOverlays::IonRasterOverlay> get_overlay_instance();
+	/// @brief Overlays live as children of their tileset, leaving it removes them
+	void _exit_tree() override;
+
+	CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> get_overlay_instance();
+
+protected:
+	/// @brief Creates the cesium overlay for this node's source, returns nullptr if the node is not configured properly
+	virtual CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> create_overlay(const CesiumRasterOverlays::RasterOverlayOptions& overlayOptions);
+
+	static void _bind_methods();
+
+	String m_materialKey = "0";
 
 private:
+	CesiumRasterOverlays::RasterOverlayOptions make_overlay_options(Cesium3DTileset* tilesetInstance) const;
 
+	real_t m_alpha = 1.0;
 
-	void create_and_add_overlay(Cesium3DTileset* tilesetInstance);
+	int32_t m_maximumSimultaneousTileLoads = 20;
 
-	int64_t m_assetId = 0;
+	int32_t m_maximumTextureSize = 2048;
 
-	String m_materialKey = "0";
+	real_t m_maximumScreenSpaceError = 2.0;
+
+	int64_t m_subTileCacheBytes = 16 * 1024 * 1024;
+
+	/// @brief Power of two applied to the screen space error, positive values trade imagery detail for bandwidth
+	real_t m_lodBias = 0.0;
 
-	CesiumUtility::IntrusivePointer<CesiumRasterOverlays::IonRasterOverlay> m_overlayInstance;
+	CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> m_overlayInstance;
+
+	/// @brief Composite layer taken from the tileset, -1 while the overlay isn't added
+	int32_t m_layerIndex = -1;
+};
+
+class CesiumIonRasterOverlay : public CesiumRasterOverlay {
+	GDCLASS(CesiumIonRasterOverlay, CesiumRasterOverlay)
+public:
+#pragma region Editor Properties
+	int64_t get_asset_id() const;
+
+	void set_asset_id(int64_t id);
+
+#pragma endregion
 
 protected:
+	CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> create_overlay(const CesiumRasterOverlays::RasterOverlayOptions& overlayOptions) override;
+
 	static void _bind_methods();
+
+private:
+	int64_t m_assetId = 0;
 };
 
 #endif // !CESIUM_GD_RASTER_OVERLAY_H
-
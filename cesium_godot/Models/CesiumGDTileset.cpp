@@ -20,6 +20,7 @@
 #include <godot_cpp/classes/window.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
 #include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
 #include <godot_cpp/classes/collision_shape3d.hpp>
 #include <godot_cpp/core/error_macros.hpp>
 #include <godot_cpp/classes/scene_tree.hpp>
@@ -32,6 +33,7 @@ using namespace godot;
 #include "scene/main/window.h"
 #include "core/config/project_settings.h"
 #include "core/io/dir_access.h"
+#include "core/io/file_access.h"
 #include "scene/3d/physics/collision_shape_3d.h"
 #include "core/error/error_macros.h"
 #endif
@@ -41,18 +43,30 @@ using namespace godot;
 #include "Utils/AssetManipulation.h"
 #include "Cesium3DTilesSelection/Tileset.h"
 #include "Cesium3DTilesSelection/TilesetExternals.h"
+#include "Cesium3DTilesSelection/TilesetViewGroup.h"
+#include "Cesium3DTilesSelection/ViewState.h"
 #include "SimpleTaskProcessor.h"
 #include "../Utils/CesiumMathUtils.h"
 #include "../Implementations/NetworkAssetAccessor.h"
+#include "../Implementations/ArchiveAssetAccessor.h"
+#include "../Implementations/LocalAssetAccesor.h"
+#include "../Implementations/IonStartupAssetAccessor.h"
+#include "../Implementations/PriorityAssetAccessor.h"
+#include "../Implementations/RoutingAssetAccessor.h"
 #include "../Implementations/GodotPrepareRenderResources.h"
+#include "../Utils/CurlBandwidthGovernor.h"
+#include "../Utils/LocalCacheManager.h"
 #include "CesiumHTTPRequestNode.h"
 #include "Cesium3DTilesContent/registerAllTileContentTypes.h"
 #include "../Utils/CesiumVariantHash.h"
 #include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <functional>
 #include "CesiumGDRasterOverlay.h"
 #include "CesiumAsync/GunzipAssetAccessor.h"
 #include <CesiumAsync/CachingAssetAccessor.h>
-#include "CesiumAsync/SqliteCache.h"
+#include "../Implementations/CesiumPackFileCache.h"
+#include "../Implementations/CesiumSqliteCache.h"
 
 
 static int32_t tileCount = 0;
@@ -68,6 +82,11 @@ constexpr const char* PRELOAD_ANCESTORS_DESC = "Indicates whether the ancestors
 constexpr const char* PRELOAD_SIBLINGS_DESC = "Indicates whether the siblings of rendered tiles should bepreloaded.\nSetting this to true causes tiles with the same parent as arendered tile to be loaded, even if they are culled.\nSetting this to truemay provide a better panning experience at the cost of loading more tiles.";
 constexpr const char* LOADING_DESCENDANT_LIMIT_DESC = "The number of loading descendant tiles that is considered \"too many\".\nIf a tile has too many loading descendants, that tile will be loaded and rendered before any of its descendants are loaded and rendered. \nThis means more feedback for the user that something is happening at the cost of a longer overall load time.\nSetting this to 0 will cause each tile level to be loaded successively, significantly increasing load time.\nSetting it to a large number (e.g. 1000) will minimize the number of tiles that are loaded but tend to make detail appear all at once after a long wait.";
 constexpr const char* FORBID_HOLES_DESC = "Never render a tileset with missing tiles.\n\nWhen true, the tileset will guarantee that the tileset will never be rendered with holes in place of tiles that are not yet loaded.\nIt does this by refusing to refine a parent tile until all of its child tiles are ready to render.\nThus, when the camera moves, we will always have something - even if it's low resolution - to render any part of the tileset that becomes visible.\nWhen false, overall loading will be faster, but newly-visible parts of the tileset may initially be blank.";
+constexpr const char* PREFETCH_ENABLED_DESC = "Request the tiles the camera will need a few seconds from now.\nThe camera path is extrapolated from its motion, or follows the route given with set_prefetch_route.\nPrefetching only runs while no regular tile request is waiting for bandwidth.";
+constexpr const char* PREFETCH_LOOKAHEAD_DESC = "How far ahead (in seconds of camera travel) tiles are prefetched.";
+constexpr const char* PREFETCH_STEPS_DESC = "Number of predicted viewpoints between the camera and the lookahead, each one is an extra frustum to select tiles for.";
+constexpr const char* RENDER_CACHE_ENABLED_DESC = "Keep converted tiles (meshes, materials, textures and collision) on disk in a render folder next to the configuration's request cache, so they skip the mesh conversion on the next run. Off by default, the folder can grow up to the configuration's render_cache_size_mb.";
+constexpr const char* PREFETCH_LOAD_WEIGHT_DESC = "Share of the tile load slots given to prefetching, relative to the camera's own view (weight 1).";
 constexpr const char* GENERATE_MISSING_NORMALS_DESC = "Whether to generate smooth normals when normals are missing in theoriginal Gltf.\n\nAccording to the Gltf spec: \"When normals are not specified, clientimplementations should calculate flat normals.\"\nHowever, calculating flatnormals requires duplicating vertices.\nThis option allows the gltfs to besent with explicit smooth normals when the original gltf was missingnormals.";
 
 
@@ -87,6 +106,10 @@ Cesium3DTileset::Cesium3DTileset()
 {
 	this->m_initialLoadingFinished = false;
 	this->m_tilesetConfig = new OpaqueTilesetOptions();
+	// Back to front, pop_back hands out layer 0 first
+	for (int32_t layerIndex = MAX_OVERLAY_LAYERS - 1; layerIndex >= 0; layerIndex--) {
+		this->m_freeOverlayLayers.push_back(layerIndex);
+	}
 	//Set all the default values for the tileset options that are not exposed to the editor
 	this->m_tilesetConfig->options.mainThreadLoadingTimeLimit = LOADING_LIMIT_SECONDS;
 	this->m_tilesetConfig->options.tileCacheUnloadTimeLimit = LOADING_LIMIT_SECONDS;
@@ -176,6 +199,7 @@ void Cesium3DTileset::set_url(const String& url)
 {
 	//Assert the source
 	this->m_url = url;
+	this->m_loadFailed = false;
 	this->recreate_tileset();
 }
 
@@ -203,12 +227,14 @@ int Cesium3DTileset::get_data_source() const
 void Cesium3DTileset::set_data_source(int data_source)
 {
 	this->m_selectedDataSource = static_cast<CesiumDataSource>(data_source);
+	this->m_loadFailed = false;
 	this->notify_property_list_changed();
 }
 
 void Cesium3DTileset::set_ion_asset_id(int64_t id)
 {
 	this->m_cesiumIonAssetId = id;
+	this->m_loadFailed = false;
 }
 
 int64_t Cesium3DTileset::get_ion_asset_id() const
@@ -237,6 +263,8 @@ void Cesium3DTileset::update_tileset(const Transform3D& cameraTransform)
 		}
 		
 		this->load_tileset();
+		// The failure is latched in load_tileset, nothing is retried until the source changes
+		if (this->m_activeTileset == nullptr) return;
 	}
 
 	//Get the camera view state
@@ -287,20 +315,115 @@ void Cesium3DTileset::update_tileset(const Transform3D& cameraTransform)
 	for (CesiumUtility::IntrusivePointer<Cesium3DTilesSelection::Tile> tile : updateResult.tilesFadingOut) {
 		despawn_tile(*tile);
 	}
+
+	// After the camera's own update, its loads are started first and at their regular priority
+	this->update_prefetch(currentViewState);
+
+	// Overlay tiles attached during this update live in shared atlas pages, upload them once
+	this->m_renderResources->flush_overlay_atlas();
 }
 
 
+Cesium3DTilesSelection::Tileset* Cesium3DTileset::get_native_tileset()
+{
+	if (this->m_activeTileset == nullptr) {
+		this->load_tileset();
+	}
+	return this->m_activeTileset.get();
+}
+
 bool Cesium3DTileset::is_initial_loading_finished() const
 {
 	return this->m_initialLoadingFinished;
 }
 
-void Cesium3DTileset::add_overlay(CesiumIonRasterOverlay* overlay)
+void Cesium3DTileset::update_prefetch(const Cesium3DTilesSelection::ViewState& currentViewState)
+{
+	this->m_prefetcher.add_sample(currentViewState.getPosition(), CesiumTilePrefetcher::Clock_t::now());
+	// An idle group would keep its last selection (and the loads it queued) alive, dropping it unregisters it from the tileset
+	if (!this->m_prefetchEnabled) {
+		this->m_prefetchViewGroup.reset();
+		return;
+	}
+	// Regular loads come first, only look ahead while the network has room to spare
+	if (CurlBandwidthGovernor::get_queued_count(CurlRequestPriority::Normal) > 0) {
+		this->m_prefetchViewGroup.reset();
+		return;
+	}
+
+	const std::vector<PrefetchPose_t> poses = this->m_prefetcher.predict(currentViewState.getPosition(), currentViewState.getDirection(), currentViewState.getUp());
+	// Parked camera, nothing ahead to load
+	if (poses.empty()) {
+		this->m_prefetchViewGroup.reset();
+		return;
+	}
+
+	std::vector<Cesium3DTilesSelection::ViewState> frustums;
+	frustums.reserve(poses.size());
+	for (const PrefetchPose_t& pose : poses) {
+		frustums.push_back(Cesium3DTilesSelection::ViewState::create(
+			pose.position,
+			glm::normalize(pose.direction),
+			pose.up,
+			currentViewState.getViewportSize(),
+			currentViewState.getHorizontalFieldOfView(),
+			currentViewState.getVerticalFieldOfView()
+		));
+	}
+
+	if (this->m_prefetchViewGroup == nullptr) {
+		this->m_prefetchViewGroup = std::make_unique<Cesium3DTilesSelection::TilesetViewGroup>();
+	}
+	this->m_prefetchViewGroup->setWeight(this->m_prefetchLoadWeight);
+	// updateViewGroup only selects, the requests are issued by loadTiles and carry the Low class down to curl
+	CurlBandwidthGovernor::ScopedPriority lowPriority(CurlRequestPriority::Low);
+	this->m_activeTileset->updateViewGroup(*this->m_prefetchViewGroup, frustums);
+	this->m_activeTileset->loadTiles();
+}
+
+void Cesium3DTileset::add_overlay(CesiumRasterOverlay* overlay)
 {
 	if (overlay == nullptr) return;
+	ERR_FAIL_COND_MSG(this->m_activeTileset == nullptr, "The tileset failed to load, the overlay can't be attached");
 	this->m_activeTileset->getOverlays().add(overlay->get_overlay_instance());
 }
 
+void Cesium3DTileset::remove_overlay(CesiumRasterOverlay* overlay)
+{
+	if (overlay == nullptr || this->m_activeTileset == nullptr) return;
+	// Tiles detach its raster tiles through detachRasterInMainThread, which clears the overlay's layer
+	this->m_activeTileset->getOverlays().remove(overlay->get_overlay_instance());
+}
+
+int32_t Cesium3DTileset::acquire_overlay_layer()
+{
+	if (this->m_freeOverlayLayers.empty()) return -1;
+	const int32_t layerIndex = this->m_freeOverlayLayers.back();
+	this->m_freeOverlayLayers.pop_back();
+	return layerIndex;
+}
+
+void Cesium3DTileset::release_overlay_layer(int32_t layerIndex)
+{
+	ERR_FAIL_INDEX(layerIndex, MAX_OVERLAY_LAYERS);
+	ERR_FAIL_COND_MSG(std::find(this->m_freeOverlayLayers.begin(), this->m_freeOverlayLayers.end(), layerIndex) != this->m_freeOverlayLayers.end(), "Overlay layer was released twice");
+	this->m_freeOverlayLayers.push_back(layerIndex);
+	// Keep the lowest free layer at the back
+	std::sort(this->m_freeOverlayLayers.begin(), this->m_freeOverlayLayers.end(), std::greater<int32_t>());
+}
+
+int32_t Cesium3DTileset::get_overlay_count() const
+{
+	if (this->m_activeTileset == nullptr) return 0;
+	return static_cast<int32_t>(this->m_activeTileset->getOverlays().size());
+}
+
+Dictionary Cesium3DTileset::get_overlay_atlas_statistics() const
+{
+	if (this->m_renderResources == nullptr) return Dictionary();
+	return this->m_renderResources->get_overlay_atlas_statistics();
+}
+
 void Cesium3DTileset::free_tile(Cesium3DTile* tileInstance, size_t tileHash) {
 	if (tileInstance == nullptr) {
 		return;
@@ -346,19 +469,71 @@ void Cesium3DTileset::load_tileset()
 	const Cesium3DTilesSelection::TilesetOptions& options = this->m_tilesetConfig->options;
 	const Cesium3DTilesSelection::TilesetContentOptions& contentOptions = this->m_tilesetConfig->contentOptions;
 
+	// A source that failed to open (bad URL, unreadable archive) was reported once, it's only tried again once it changes
+	if (this->m_loadFailed) return;
+	// Cleared below once the tileset exists, every early return on the way leaves it set
+	this->m_loadFailed = true;
+
 	if (this->m_selectedDataSource == CesiumDataSource::FromCesiumIon) {
-		const String& token = CesiumGDConfig::get_singleton(this)->get_access_token();
+		const CesiumGDConfig* config = CesiumGDConfig::get_singleton(this);
+		const String& token = config->get_access_token();
+		std::shared_ptr<CesiumAsync::IAssetAccessor> assetAccessor = this->create_cached_asset_accessor();
+		if (config->get_ion_startup_cache_enabled()) {
+			// Selection starts from the previous launch's endpoint and root document instead of waiting on two round trips
+			const String startupCachePath = config->get_request_cache_path().get_base_dir().path_join("ion_startup");
+			assetAccessor = std::make_shared<IonStartupAssetAccessor>(assetAccessor, startupCachePath);
+		}
 		this->m_activeTileset = std::make_unique<Cesium3DTilesSelection::Tileset>(
-			this->create_tileset_externals(),
+			this->create_tileset_externals(assetAccessor),
 			this->m_cesiumIonAssetId,
 			token.utf8().get_data(),
 			options
 		);
 	}
+	else if (this->m_selectedDataSource == CesiumDataSource::FromArchive) {
+		// Already local, tiles are read from the archive without going through the request cache
+		const std::string archivePath = ProjectSettings::get_singleton()->globalize_path(this->m_url).utf8().get_data();
+		auto archive = std::make_shared<CesiumTileArchive>();
+		std::string error;
+		ERR_FAIL_COND_MSG(!archive->open(archivePath, &error), String("Could not open the tileset archive: ") + error.c_str());
+		auto archiveAccessor = std::make_shared<ArchiveAssetAccessor>(archive, archivePath);
+		const std::string rootUrl = archiveAccessor->get_root_url();
+		ERR_FAIL_COND_MSG(rootUrl.empty(), "The archive " + this->m_url + " contains no tileset.json or layer.json");
+		// Overlays share the accessor, files outside the archive are read from disk and anything else from the network
+		auto outsideAccessor = std::make_shared<RoutingAssetAccessor>(
+			&LocalAssetAccessor::is_local_url,
+			std::make_shared<CesiumAsync::GunzipAssetAccessor>(std::make_shared<LocalAssetAccessor>()),
+			this->create_cached_asset_accessor()
+		);
+		auto assetAccessor = std::make_shared<RoutingAssetAccessor>(
+			[archiveAccessor](const std::string& url) { return archiveAccessor->contains_url(url); },
+			std::make_shared<CesiumAsync::GunzipAssetAccessor>(archiveAccessor),
+			outsideAccessor
+		);
+		this->m_activeTileset = std::make_unique<Cesium3DTilesSelection::Tileset>(
+			this->create_tileset_externals(assetAccessor),
+			rootUrl,
+			options
+		);
+	}
 	//Else this is coming from a URL
+	else if (LocalAssetAccessor::is_local_url(this->m_url.utf8().get_data())) {
+		// Files on disk are read directly, caching them again would only duplicate them
+		// Overlays share the accessor, imagery from Ion or a URL template still goes through the cached network stack
+		auto assetAccessor = std::make_shared<RoutingAssetAccessor>(
+			&LocalAssetAccessor::is_local_url,
+			std::make_shared<CesiumAsync::GunzipAssetAccessor>(std::make_shared<LocalAssetAccessor>()),
+			this->create_cached_asset_accessor()
+		);
+		this->m_activeTileset = std::make_unique<Cesium3DTilesSelection::Tileset>(
+			this->create_tileset_externals(assetAccessor),
+			LocalAssetAccessor::to_url(this->m_url.utf8().get_data()),
+			options
+		);
+	}
 	else {
 		this->m_activeTileset = std::make_unique<Cesium3DTilesSelection::Tileset>(
-			this->create_tileset_externals(),
+			this->create_tileset_externals(this->create_cached_asset_accessor()),
 			this->m_url.utf8().get_data(),
 			options
 		);
@@ -368,40 +543,87 @@ void Cesium3DTileset::load_tileset()
 	for (int32_t i = 0; i < childCount; i++)
 	{
 		Node* currChild = this->get_child(i);
-		CesiumIonRasterOverlay* overlay = Object::cast_to<CesiumIonRasterOverlay>(currChild);
+		CesiumRasterOverlay* overlay = Object::cast_to<CesiumRasterOverlay>(currChild);
 		if (overlay == nullptr) continue;
 		overlay->add_to_tileset(this);
 	}
+	this->m_loadFailed = this->m_activeTileset == nullptr;
+}
 
+static void remove_legacy_request_cache(const String& cachePath)
+{
+	static bool s_checked = false;
+	if (s_checked) return;
+	s_checked = true;
+	// Unless the configuration still points at it, nothing would ever read or prune the old database again
+	const String legacyPath = CesiumGDConfig::LEGACY_REQUEST_CACHE_PATH.data();
+	if (cachePath.simplify_path() == legacyPath) return;
+	for (const char* suffix : { "", "-wal", "-shm", "-journal" }) {
+		const String path = legacyPath + suffix;
+		if (FileAccess::file_exists(path)) {
+			DirAccess::remove_absolute(path);
+		}
+	}
 }
 
-Cesium3DTilesSelection::TilesetExternals Cesium3DTileset::create_tileset_externals()
+std::shared_ptr<CesiumAsync::IAssetAccessor> Cesium3DTileset::create_cached_asset_accessor()
 {
-	const String cachePath = "user://cache";
-	Ref<DirAccess> userAccess = DirAccess::open("user://");
-	Error err = userAccess->make_dir_recursive(cachePath);
+	const CesiumGDConfig* config = CesiumGDConfig::get_singleton(this);
+	const String cachePath = config->get_request_cache_path();
+	remove_legacy_request_cache(cachePath);
+	Error err = DirAccess::make_dir_recursive_absolute(cachePath.get_base_dir());
 	if (err != Error::OK) {
 		ERR_PRINT("Could not create / use temporary cache path!");
 	}
-	String globalCachePath = ProjectSettings::get_singleton()->globalize_path(cachePath) + "/cesium-request-cache.sqlite";
-	constexpr int32_t requestsPerCachePrune = 10000;
-	constexpr uint64_t maxItems = 4096 * 5;
-
-	auto cache = std::make_shared<CesiumAsync::SqliteCache>(spdlog::default_logger(), globalCachePath.utf8().get_data(), maxItems);
+	const String globalCachePath = ProjectSettings::get_singleton()->globalize_path(cachePath);
+	const uint64_t maxItems = static_cast<uint64_t>(config->get_request_cache_max_items());
+	const uint64_t maxBytes = static_cast<uint64_t>(config->get_request_cache_max_size_mb()) * 1024 * 1024;
+
+	std::shared_ptr<CesiumAsync::ICacheDatabase> cache;
+	if (config->get_request_cache_backend() == static_cast<int32_t>(CesiumGDConfig::RequestCacheBackend::PackFile)) {
+		CesiumPackFileCacheOptions_t cacheOptions;
+		cacheOptions.path = (globalCachePath.get_basename() + ".pack").utf8().get_data();
+		cacheOptions.maxItems = maxItems;
+		cacheOptions.maxBytes = maxBytes;
+		// Tilesets (and reloads overlapping the old tileset) append to one shared instance of the pack
+		cache = CesiumPackFileCache::get_shared(cacheOptions);
+	}
+	else {
+		// Inserts are queued for the cache's writer thread, tile delivery never waits on the database
+		CesiumSqliteCacheOptions_t cacheOptions;
+		cacheOptions.path = globalCachePath.utf8().get_data();
+		cacheOptions.maxItems = maxItems;
+		cacheOptions.maxBytes = maxBytes;
+		cacheOptions.writeBatchSize = static_cast<uint32_t>(config->get_request_cache_write_batch_size());
+		cacheOptions.compressionEnabled = config->get_request_cache_compression();
+		cache = std::make_shared<CesiumSqliteCache>(cacheOptions);
+	}
 	auto simpleAccessor = std::make_shared<NetworkAssetAccessor>();
-	auto cachedAccessor = std::make_shared<CesiumAsync::CachingAssetAccessor>(spdlog::default_logger(), simpleAccessor, cache, requestsPerCachePrune);
-	auto gunzipAccessor = std::make_shared<CesiumAsync::GunzipAssetAccessor>(
+	auto cachedAccessor = std::make_shared<CesiumAsync::CachingAssetAccessor>(spdlog::default_logger(), simpleAccessor, cache, config->get_requests_per_cache_prune());
+	// The cache forwards misses from its own threads, the tag keeps prefetch / seeding requests in the Low class
+	return std::make_shared<PriorityAssetAccessor>(std::make_shared<CesiumAsync::GunzipAssetAccessor>(
 		cachedAccessor
-	);
-	
+	));
+}
+
+Cesium3DTilesSelection::TilesetExternals Cesium3DTileset::create_tileset_externals(std::shared_ptr<CesiumAsync::IAssetAccessor> assetAccessor)
+{
+	if (this->m_renderCacheEnabled) {
+		// Converted tiles live next to the request cache, like the Ion startup store
+		const String requestCachePath = CesiumGDConfig::get_singleton(this)->get_request_cache_path();
+		LocalCacheManager::set_directory(requestCachePath.get_base_dir().path_join("render"));
+		LocalCacheManager::prune_render_resources();
+	}
+
 	auto taskProcessor = std::make_shared<SimpleTaskProcessor>();
 	CesiumAsync::AsyncSystem asyncSystem(taskProcessor);
 	auto renderResourcesProvider = std::make_shared<GodotPrepareRenderResources>(this);
+	this->m_renderResources = renderResourcesProvider;
 	auto creditSystem = std::make_shared<CesiumUtility::CreditSystem>();
 	CesiumGDCreditSystem::get_singleton(this)->add_credit_system(creditSystem);
 	
 	Cesium3DTilesSelection::TilesetExternals result {
-		gunzipAccessor,
+		assetAccessor,
 		renderResourcesProvider,
 		asyncSystem,
 		creditSystem
@@ -507,6 +729,84 @@ void Cesium3DTileset::set_show_hierarchy(bool show) {
 	this->m_showHierarchy = show;
 }
 
+void Cesium3DTileset::set_prefetch_enabled(bool enabled)
+{
+	this->m_prefetchEnabled = enabled;
+	if (!enabled) {
+		// Releases the prefetched selection, those tiles can be unloaded again
+		this->m_prefetchViewGroup.reset();
+	}
+}
+
+bool Cesium3DTileset::get_prefetch_enabled() const
+{
+	return this->m_prefetchEnabled;
+}
+
+void Cesium3DTileset::set_prefetch_lookahead_seconds(double seconds)
+{
+	this->m_prefetcher.set_lookahead_seconds(seconds);
+}
+
+double Cesium3DTileset::get_prefetch_lookahead_seconds() const
+{
+	return this->m_prefetcher.get_lookahead_seconds();
+}
+
+void Cesium3DTileset::set_prefetch_steps(int32_t steps)
+{
+	this->m_prefetcher.set_step_count(steps);
+}
+
+int32_t Cesium3DTileset::get_prefetch_steps() const
+{
+	return this->m_prefetcher.get_step_count();
+}
+
+void Cesium3DTileset::set_prefetch_load_weight(double weight)
+{
+	this->m_prefetchLoadWeight = Math::max(weight, 0.0);
+}
+
+double Cesium3DTileset::get_prefetch_load_weight() const
+{
+	return this->m_prefetchLoadWeight;
+}
+
+void Cesium3DTileset::set_render_cache_enabled(bool enabled)
+{
+	this->m_renderCacheEnabled = enabled;
+}
+
+bool Cesium3DTileset::get_render_cache_enabled() const
+{
+	return this->m_renderCacheEnabled;
+}
+
+void Cesium3DTileset::set_prefetch_route(const PackedVector3Array& waypoints)
+{
+	std::vector<glm::dvec3> route;
+	route.reserve(waypoints.size());
+	for (int32_t i = 0; i < waypoints.size(); i++) {
+		route.push_back(CesiumMathUtils::to_glm_dvec3(waypoints[i]));
+	}
+	this->m_prefetcher.set_route(std::move(route));
+}
+
+PackedVector3Array Cesium3DTileset::get_prefetch_route() const
+{
+	PackedVector3Array result;
+	for (const glm::dvec3& waypoint : this->m_prefetcher.get_route()) {
+		result.push_back(Vector3(waypoint.x, waypoint.y, waypoint.z));
+	}
+	return result;
+}
+
+void Cesium3DTileset::clear_prefetch_route()
+{
+	this->m_prefetcher.set_route({});
+}
+
 void Cesium3DTileset::_bind_methods()
 {
 #pragma region Inspector properties
@@ -545,9 +845,10 @@ void Cesium3DTileset::_bind_methods()
 
 	ClassDB::bind_method(D_METHOD("get_data_source"), &Cesium3DTileset::get_data_source);
 	ClassDB::bind_method(D_METHOD("set_data_source", "data_source"), &Cesium3DTileset::set_data_source);
-	ADD_PROPERTY(PropertyInfo(Variant::INT, "data_source", PROPERTY_HINT_ENUM, "From Cesium Ion,From Url"), "set_data_source", "get_data_source");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "data_source", PROPERTY_HINT_ENUM, "From Cesium Ion,From Url,From Archive"), "set_data_source", "get_data_source");
 	BIND_ENUM_CONSTANT(static_cast<int64_t>(CesiumDataSource::FromCesiumIon));
 	BIND_ENUM_CONSTANT(static_cast<int64_t>(CesiumDataSource::FromUrl));
+	BIND_ENUM_CONSTANT(static_cast<int64_t>(CesiumDataSource::FromArchive));
 
 	ClassDB::bind_method(D_METHOD("set_url", URL_P_NAME), &Cesium3DTileset::set_url);
 	
@@ -562,6 +863,26 @@ void Cesium3DTileset::_bind_methods()
 	ClassDB::bind_method(D_METHOD("set_show_hierarchy", "showHierarchy"), &Cesium3DTileset::set_show_hierarchy);
 	ClassDB::bind_method(D_METHOD("get_show_hierarchy"), &Cesium3DTileset::get_show_hierarchy);
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "show_hierarchy"), "set_show_hierarchy", "get_show_hierarchy");
+
+	ClassDB::bind_method(D_METHOD("set_prefetch_enabled", "enabled"), &Cesium3DTileset::set_prefetch_enabled);
+	ClassDB::bind_method(D_METHOD("get_prefetch_enabled"), &Cesium3DTileset::get_prefetch_enabled);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "prefetch_enabled", PROPERTY_HINT_NONE, PREFETCH_ENABLED_DESC), "set_prefetch_enabled", "get_prefetch_enabled");
+
+	ClassDB::bind_method(D_METHOD("set_prefetch_lookahead_seconds", "seconds"), &Cesium3DTileset::set_prefetch_lookahead_seconds);
+	ClassDB::bind_method(D_METHOD("get_prefetch_lookahead_seconds"), &Cesium3DTileset::get_prefetch_lookahead_seconds);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "prefetch_lookahead_seconds", PROPERTY_HINT_NONE, PREFETCH_LOOKAHEAD_DESC), "set_prefetch_lookahead_seconds", "get_prefetch_lookahead_seconds");
+
+	ClassDB::bind_method(D_METHOD("set_prefetch_steps", "steps"), &Cesium3DTileset::set_prefetch_steps);
+	ClassDB::bind_method(D_METHOD("get_prefetch_steps"), &Cesium3DTileset::get_prefetch_steps);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "prefetch_steps", PROPERTY_HINT_NONE, PREFETCH_STEPS_DESC), "set_prefetch_steps", "get_prefetch_steps");
+
+	ClassDB::bind_method(D_METHOD("set_prefetch_load_weight", "weight"), &Cesium3DTileset::set_prefetch_load_weight);
+	ClassDB::bind_method(D_METHOD("get_prefetch_load_weight"), &Cesium3DTileset::get_prefetch_load_weight);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "prefetch_load_weight", PROPERTY_HINT_NONE, PREFETCH_LOAD_WEIGHT_DESC), "set_prefetch_load_weight", "get_prefetch_load_weight");
+
+	ClassDB::bind_method(D_METHOD("set_render_cache_enabled", "enabled"), &Cesium3DTileset::set_render_cache_enabled);
+	ClassDB::bind_method(D_METHOD("get_render_cache_enabled"), &Cesium3DTileset::get_render_cache_enabled);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "render_cache_enabled", PROPERTY_HINT_NONE, RENDER_CACHE_ENABLED_DESC), "set_render_cache_enabled", "get_render_cache_enabled");
 	
 #pragma endregion
 
@@ -569,6 +890,10 @@ void Cesium3DTileset::_bind_methods()
 	ClassDB::bind_method(D_METHOD("is_initial_loading_finished"), &Cesium3DTileset::is_initial_loading_finished);
 	ClassDB::bind_method(D_METHOD("update_tileset", "camera_transform"), &Cesium3DTileset::update_tileset);
 	ClassDB::bind_method(D_METHOD("free_tile"), &Cesium3DTileset::free_tile);
+	ClassDB::bind_method(D_METHOD("get_overlay_atlas_statistics"), &Cesium3DTileset::get_overlay_atlas_statistics);
+	ClassDB::bind_method(D_METHOD("set_prefetch_route", "waypoints"), &Cesium3DTileset::set_prefetch_route);
+	ClassDB::bind_method(D_METHOD("get_prefetch_route"), &Cesium3DTileset::get_prefetch_route);
+	ClassDB::bind_method(D_METHOD("clear_prefetch_route"), &Cesium3DTileset::clear_prefetch_route);
 #pragma endregion
 }
 
@@ -13,18 +13,28 @@ using namespace godot;
 
 #include "CesiumDataSource.h"
 #include "../Utils/BRThreadPool.h"
+#include "../Utils/CesiumTilePrefetcher.h"
+#include <atomic>
 #include "CesiumHTTPRequestNode.h"
 
 namespace Cesium3DTilesSelection {
 	class Tileset;
 	class Tile;
 	class TilesetExternals;
+	class TilesetViewGroup;
+	class ViewState;
+}
+
+namespace CesiumAsync {
+	class IAssetAccessor;
 }
 
 class OpaqueTilesetOptions;
 
+class GodotPrepareRenderResources;
 
-class CesiumIonRasterOverlay;
+
+class CesiumRasterOverlay;
 
 class CesiumGeoreference;
 
@@ -89,13 +99,55 @@ public:
 
 	void set_show_hierarchy(bool show);
 
+	void set_prefetch_enabled(bool enabled);
+
+	bool get_prefetch_enabled() const;
+
+	void set_prefetch_lookahead_seconds(double seconds);
+
+	double get_prefetch_lookahead_seconds() const;
+
+	void set_prefetch_steps(int32_t steps);
+
+	int32_t get_prefetch_steps() const;
+
+	void set_prefetch_load_weight(double weight);
+
+	double get_prefetch_load_weight() const;
+
+	void set_render_cache_enabled(bool enabled);
+
+	bool get_render_cache_enabled() const;
+
 #pragma endregion
 
+	/// @brief Known camera path to prefetch along, in the space the tileset is viewed from (ECEF when georeferenced)
+	void set_prefetch_route(const PackedVector3Array& waypoints);
+
+	PackedVector3Array get_prefetch_route() const;
+
+	void clear_prefetch_route();
+
 	void update_tileset(const Transform3D& cameraTransform);
 
+	/// @brief Loads the tileset on first use, for callers driving it without a camera (see CesiumCacheSeeder)
+	Cesium3DTilesSelection::Tileset* get_native_tileset();
+
 	bool is_initial_loading_finished() const;
 
-	void add_overlay(CesiumIonRasterOverlay* overlay);
+	void add_overlay(CesiumRasterOverlay* overlay);
+
+	void remove_overlay(CesiumRasterOverlay* overlay);
+
+	int32_t get_overlay_count() const;
+
+	/// @brief Composite layer for a new overlay, -1 once every layer a tile can composite is taken
+	int32_t acquire_overlay_layer();
+
+	/// @brief Hands the layer of a removed overlay to the next one added
+	void release_overlay_layer(int32_t layerIndex);
+
+	Dictionary get_overlay_atlas_statistics() const;
 
 	void free_tile(Cesium3DTile* tileInstance, size_t tileHash);
 	
@@ -113,7 +165,10 @@ private:
 
 	void load_tileset();
 
-	Cesium3DTilesSelection::TilesetExternals create_tileset_externals();
+	Cesium3DTilesSelection::TilesetExternals create_tileset_externals(std::shared_ptr<CesiumAsync::IAssetAccessor> assetAccessor);
+
+	/// @brief Network accessor behind the configured request cache
+	std::shared_ptr<CesiumAsync::IAssetAccessor> create_cached_asset_accessor();
 
 	void render_tile_as_node(const Cesium3DTilesSelection::Tile& tile);
 
@@ -127,10 +182,33 @@ private:
 
 	void register_tile(Cesium3DTile *instance, size_t hash);
 
+	/// @brief Selects tiles for the predicted camera poses in a separate, lower weighted view group
+	void update_prefetch(const Cesium3DTilesSelection::ViewState& currentViewState);
+
 	uint32_t update_property_usage_flags(const PropertyInfo& property) const;
 	
 	std::unique_ptr<Cesium3DTilesSelection::Tileset> m_activeTileset = nullptr;
 
+	/// @brief Set when the source could not be opened, cleared when the url, data source or Ion asset id changes
+	bool m_loadFailed = false;
+
+	/// @brief Declared after the tileset so it unregisters from it first
+	std::unique_ptr<Cesium3DTilesSelection::TilesetViewGroup> m_prefetchViewGroup = nullptr;
+
+	CesiumTilePrefetcher m_prefetcher;
+
+	bool m_prefetchEnabled = false;
+
+	double m_prefetchLoadWeight = 0.25;
+
+	/// @brief Read by the load threads. Opt-in, it keeps up to render_cache_size_mb of converted tiles on disk
+	std::atomic<bool> m_renderCacheEnabled{ false };
+
+	std::shared_ptr<GodotPrepareRenderResources> m_renderResources = nullptr;
+
+	/// @brief Composite layers no overlay holds, the lowest one is handed out first
+	std::vector<int32_t> m_freeOverlayLayers;
+
 
 	OpaqueTilesetOptions* m_tilesetConfig;
 
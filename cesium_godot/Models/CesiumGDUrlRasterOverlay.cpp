@@ -0,0 +1,389 @@
+#include "CesiumGDUrlRasterOverlay.h"
+#include <CesiumGeospatial/Ellipsoid.h>
+#include <CesiumGeospatial/GeographicProjection.h>
+#include <CesiumGeospatial/WebMercatorProjection.h>
+#include <CesiumRasterOverlays/TileMapServiceRasterOverlay.h>
+#include <CesiumRasterOverlays/UrlTemplateRasterOverlay.h>
+#include <CesiumRasterOverlays/WebMapTileServiceRasterOverlay.h>
+
+constexpr const char* URL_DESC = "Where the tiles come from, http(s):// for tile servers or file:// for tiles stored on disk.\nURL template overlays use {x}, {y}, {z} placeholders ({reverseY} for TMS style rows)";
+constexpr const char* PROJECTION_HINT = "WebMercator,Geographic";
+
+#pragma region CesiumUrlRasterOverlay
+
+void CesiumUrlRasterOverlay::set_url(const String& url)
+{
+	this->m_url = url;
+}
+
+const String& CesiumUrlRasterOverlay::get_url() const
+{
+	return this->m_url;
+}
+
+void CesiumUrlRasterOverlay::set_request_headers(const Dictionary& headers)
+{
+	this->m_requestHeaders = headers;
+}
+
+Dictionary CesiumUrlRasterOverlay::get_request_headers() const
+{
+	return this->m_requestHeaders;
+}
+
+void CesiumUrlRasterOverlay::set_credit(const String& credit)
+{
+	this->m_credit = credit;
+}
+
+const String& CesiumUrlRasterOverlay::get_credit() const
+{
+	return this->m_credit;
+}
+
+void CesiumUrlRasterOverlay::set_minimum_level(int32_t level)
+{
+	this->m_minimumLevel = level;
+}
+
+int32_t CesiumUrlRasterOverlay::get_minimum_level() const
+{
+	return this->m_minimumLevel;
+}
+
+void CesiumUrlRasterOverlay::set_maximum_level(int32_t level)
+{
+	this->m_maximumLevel = level;
+}
+
+int32_t CesiumUrlRasterOverlay::get_maximum_level() const
+{
+	return this->m_maximumLevel;
+}
+
+void CesiumUrlRasterOverlay::set_projection(int32_t projection)
+{
+	this->m_projection = static_cast<OverlayProjection>(projection);
+}
+
+int32_t CesiumUrlRasterOverlay::get_projection() const
+{
+	return static_cast<int32_t>(this->m_projection);
+}
+
+std::vector<CesiumAsync::IAssetAccessor::THeader> CesiumUrlRasterOverlay::get_cesium_headers() const
+{
+	std::vector<CesiumAsync::IAssetAccessor::THeader> headers;
+	Array keys = this->m_requestHeaders.keys();
+	headers.reserve(keys.size());
+	for (int32_t i = 0; i < keys.size(); i++) {
+		String key = keys[i];
+		String value = this->m_requestHeaders[keys[i]];
+		headers.emplace_back(key.utf8().get_data(), value.utf8().get_data());
+	}
+	return headers;
+}
+
+std::optional<std::string> CesiumUrlRasterOverlay::get_cesium_credit() const
+{
+	if (this->m_credit.is_empty()) return std::nullopt;
+	return std::string(this->m_credit.utf8().get_data());
+}
+
+CesiumGeospatial::Projection CesiumUrlRasterOverlay::get_cesium_projection() const
+{
+	if (this->m_projection == OverlayProjection::Geographic) {
+		return CesiumGeospatial::GeographicProjection(CesiumGeospatial::Ellipsoid::WGS84);
+	}
+	return CesiumGeospatial::WebMercatorProjection(CesiumGeospatial::Ellipsoid::WGS84);
+}
+
+CesiumGeometry::QuadtreeTilingScheme CesiumUrlRasterOverlay::get_cesium_tiling_scheme() const
+{
+	if (this->m_projection == OverlayProjection::Geographic) {
+		return CesiumGeometry::QuadtreeTilingScheme(
+			CesiumGeospatial::GeographicProjection::computeMaximumProjectedRectangle(CesiumGeospatial::Ellipsoid::WGS84), 2, 1
+		);
+	}
+	return CesiumGeometry::QuadtreeTilingScheme(
+		CesiumGeospatial::WebMercatorProjection::computeMaximumProjectedRectangle(CesiumGeospatial::Ellipsoid::WGS84), 1, 1
+	);
+}
+
+bool CesiumUrlRasterOverlay::is_url_valid() const
+{
+	ERR_FAIL_COND_V_MSG(this->m_url.is_empty(), false, String("Raster overlay ") + this->get_name() + " has no URL");
+	ERR_FAIL_COND_V_MSG(this->m_minimumLevel > this->m_maximumLevel, false, String("Raster overlay ") + this->get_name() + " has a minimum level above its maximum level");
+	return true;
+}
+
+void CesiumUrlRasterOverlay::_bind_methods()
+{
+	ClassDB::bind_method(D_METHOD("set_url", "url"), &CesiumUrlRasterOverlay::set_url);
+	ClassDB::bind_method(D_METHOD("get_url"), &CesiumUrlRasterOverlay::get_url);
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "url", PROPERTY_HINT_NONE, URL_DESC), "set_url", "get_url");
+
+	ClassDB::bind_method(D_METHOD("set_request_headers", "headers"), &CesiumUrlRasterOverlay::set_request_headers);
+	ClassDB::bind_method(D_METHOD("get_request_headers"), &CesiumUrlRasterOverlay::get_request_headers);
+	ADD_PROPERTY(PropertyInfo(Variant::DICTIONARY, "request_headers"), "set_request_headers", "get_request_headers");
+
+	ClassDB::bind_method(D_METHOD("set_credit", "credit"), &CesiumUrlRasterOverlay::set_credit);
+	ClassDB::bind_method(D_METHOD("get_credit"), &CesiumUrlRasterOverlay::get_credit);
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "credit"), "set_credit", "get_credit");
+
+	ClassDB::bind_method(D_METHOD("set_minimum_level", "level"), &CesiumUrlRasterOverlay::set_minimum_level);
+	ClassDB::bind_method(D_METHOD("get_minimum_level"), &CesiumUrlRasterOverlay::get_minimum_level);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "minimum_level", PROPERTY_HINT_RANGE, "0,30,1"), "set_minimum_level", "get_minimum_level");
+
+	ClassDB::bind_method(D_METHOD("set_maximum_level", "level"), &CesiumUrlRasterOverlay::set_maximum_level);
+	ClassDB::bind_method(D_METHOD("get_maximum_level"), &CesiumUrlRasterOverlay::get_maximum_level);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "maximum_level", PROPERTY_HINT_RANGE, "0,30,1"), "set_maximum_level", "get_maximum_level");
+
+	ClassDB::bind_method(D_METHOD("set_projection", "projection"), &CesiumUrlRasterOverlay::set_projection);
+	ClassDB::bind_method(D_METHOD("get_projection"), &CesiumUrlRasterOverlay::get_projection);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "projection", PROPERTY_HINT_ENUM, PROJECTION_HINT), "set_projection", "get_projection");
+}
+
+#pragma endregion
+
+#pragma region CesiumUrlTemplateRasterOverlay
+
+void CesiumUrlTemplateRasterOverlay::set_tile_width(int32_t width)
+{
+	this->m_tileWidth = width;
+}
+
+int32_t CesiumUrlTemplateRasterOverlay::get_tile_width() const
+{
+	return this->m_tileWidth;
+}
+
+void CesiumUrlTemplateRasterOverlay::set_tile_height(int32_t height)
+{
+	this->m_tileHeight = height;
+}
+
+int32_t CesiumUrlTemplateRasterOverlay::get_tile_height() const
+{
+	return this->m_tileHeight;
+}
+
+CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> CesiumUrlTemplateRasterOverlay::create_overlay(const CesiumRasterOverlays::RasterOverlayOptions& overlayOptions)
+{
+	if (!this->is_url_valid()) return nullptr;
+
+	CesiumRasterOverlays::UrlTemplateRasterOverlayOptions templateOptions{};
+	templateOptions.credit = this->get_cesium_credit();
+	templateOptions.projection = this->get_cesium_projection();
+	templateOptions.tilingScheme = this->get_cesium_tiling_scheme();
+	templateOptions.minimumLevel = static_cast<uint32_t>(this->m_minimumLevel);
+	templateOptions.maximumLevel = static_cast<uint32_t>(this->m_maximumLevel);
+	templateOptions.tileWidth = static_cast<uint32_t>(this->m_tileWidth);
+	templateOptions.tileHeight = static_cast<uint32_t>(this->m_tileHeight);
+
+	return new CesiumRasterOverlays::UrlTemplateRasterOverlay(
+		this->m_materialKey.utf8().get_data(),
+		this->m_url.utf8().get_data(),
+		this->get_cesium_headers(),
+		templateOptions,
+		overlayOptions
+	);
+}
+
+void CesiumUrlTemplateRasterOverlay::_bind_methods()
+{
+	ClassDB::bind_method(D_METHOD("set_tile_width", "width"), &CesiumUrlTemplateRasterOverlay::set_tile_width);
+	ClassDB::bind_method(D_METHOD("get_tile_width"), &CesiumUrlTemplateRasterOverlay::get_tile_width);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tile_width", PROPERTY_HINT_RANGE, "1,4096,1"), "set_tile_width", "get_tile_width");
+
+	ClassDB::bind_method(D_METHOD("set_tile_height", "height"), &CesiumUrlTemplateRasterOverlay::set_tile_height);
+	ClassDB::bind_method(D_METHOD("get_tile_height"), &CesiumUrlTemplateRasterOverlay::get_tile_height);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tile_height", PROPERTY_HINT_RANGE, "1,4096,1"), "set_tile_height", "get_tile_height");
+}
+
+#pragma endregion
+
+#pragma region CesiumTileMapServiceRasterOverlay
+
+void CesiumTileMapServiceRasterOverlay::set_file_extension(const String& extension)
+{
+	this->m_fileExtension = extension;
+}
+
+const String& CesiumTileMapServiceRasterOverlay::get_file_extension() const
+{
+	return this->m_fileExtension;
+}
+
+void CesiumTileMapServiceRasterOverlay::set_flip_xy(bool flip)
+{
+	this->m_flipXY = flip;
+}
+
+bool CesiumTileMapServiceRasterOverlay::get_flip_xy() const
+{
+	return this->m_flipXY;
+}
+
+CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> CesiumTileMapServiceRasterOverlay::create_overlay(const CesiumRasterOverlays::RasterOverlayOptions& overlayOptions)
+{
+	if (!this->is_url_valid()) return nullptr;
+
+	// Levels, projection and extension are read from tilemapresource.xml when present, these only act as fallbacks
+	CesiumRasterOverlays::TileMapServiceRasterOverlayOptions tmsOptions{};
+	tmsOptions.credit = this->get_cesium_credit();
+	tmsOptions.fileExtension = std::string(this->m_fileExtension.utf8().get_data());
+	tmsOptions.minimumLevel = static_cast<uint32_t>(this->m_minimumLevel);
+	tmsOptions.maximumLevel = static_cast<uint32_t>(this->m_maximumLevel);
+	tmsOptions.projection = this->get_cesium_projection();
+	tmsOptions.tilingScheme = this->get_cesium_tiling_scheme();
+	tmsOptions.flipXY = this->m_flipXY;
+
+	return new CesiumRasterOverlays::TileMapServiceRasterOverlay(
+		this->m_materialKey.utf8().get_data(),
+		this->m_url.utf8().get_data(),
+		this->get_cesium_headers(),
+		tmsOptions,
+		overlayOptions
+	);
+}
+
+void CesiumTileMapServiceRasterOverlay::_bind_methods()
+{
+	ClassDB::bind_method(D_METHOD("set_file_extension", "extension"), &CesiumTileMapServiceRasterOverlay::set_file_extension);
+	ClassDB::bind_method(D_METHOD("get_file_extension"), &CesiumTileMapServiceRasterOverlay::get_file_extension);
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "file_extension"), "set_file_extension", "get_file_extension");
+
+	ClassDB::bind_method(D_METHOD("set_flip_xy", "flip"), &CesiumTileMapServiceRasterOverlay::set_flip_xy);
+	ClassDB::bind_method(D_METHOD("get_flip_xy"), &CesiumTileMapServiceRasterOverlay::get_flip_xy);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "flip_xy"), "set_flip_xy", "get_flip_xy");
+}
+
+#pragma endregion
+
+#pragma region CesiumWebMapTileServiceRasterOverlay
+
+void CesiumWebMapTileServiceRasterOverlay::set_layer(const String& layer)
+{
+	this->m_layer = layer;
+}
+
+const String& CesiumWebMapTileServiceRasterOverlay::get_layer() const
+{
+	return this->m_layer;
+}
+
+void CesiumWebMapTileServiceRasterOverlay::set_style(const String& style)
+{
+	this->m_style = style;
+}
+
+const String& CesiumWebMapTileServiceRasterOverlay::get_style() const
+{
+	return this->m_style;
+}
+
+void CesiumWebMapTileServiceRasterOverlay::set_tile_matrix_set_id(const String& id)
+{
+	this->m_tileMatrixSetId = id;
+}
+
+const String& CesiumWebMapTileServiceRasterOverlay::get_tile_matrix_set_id() const
+{
+	return this->m_tileMatrixSetId;
+}
+
+void CesiumWebMapTileServiceRasterOverlay::set_format(const String& format)
+{
+	this->m_format = format;
+}
+
+const String& CesiumWebMapTileServiceRasterOverlay::get_format() const
+{
+	return this->m_format;
+}
+
+void CesiumWebMapTileServiceRasterOverlay::set_subdomains(const PackedStringArray& subdomains)
+{
+	this->m_subdomains = subdomains;
+}
+
+PackedStringArray CesiumWebMapTileServiceRasterOverlay::get_subdomains() const
+{
+	return this->m_subdomains;
+}
+
+void CesiumWebMapTileServiceRasterOverlay::set_tile_size(int32_t size)
+{
+	this->m_tileSize = size;
+}
+
+int32_t CesiumWebMapTileServiceRasterOverlay::get_tile_size() const
+{
+	return this->m_tileSize;
+}
+
+CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> CesiumWebMapTileServiceRasterOverlay::create_overlay(const CesiumRasterOverlays::RasterOverlayOptions& overlayOptions)
+{
+	if (!this->is_url_valid()) return nullptr;
+	ERR_FAIL_COND_V_MSG(this->m_layer.is_empty() || this->m_tileMatrixSetId.is_empty(), nullptr, "WMTS overlays need both a layer and a tile matrix set id");
+
+	CesiumRasterOverlays::WebMapTileServiceRasterOverlayOptions wmtsOptions{};
+	wmtsOptions.credit = this->get_cesium_credit();
+	wmtsOptions.layer = this->m_layer.utf8().get_data();
+	wmtsOptions.style = this->m_style.utf8().get_data();
+	wmtsOptions.tileMatrixSetID = this->m_tileMatrixSetId.utf8().get_data();
+	wmtsOptions.format = std::string(this->m_format.utf8().get_data());
+	wmtsOptions.minimumLevel = static_cast<uint32_t>(this->m_minimumLevel);
+	wmtsOptions.maximumLevel = static_cast<uint32_t>(this->m_maximumLevel);
+	wmtsOptions.projection = this->get_cesium_projection();
+	wmtsOptions.tilingScheme = this->get_cesium_tiling_scheme();
+	wmtsOptions.tileWidth = static_cast<uint32_t>(this->m_tileSize);
+	wmtsOptions.tileHeight = static_cast<uint32_t>(this->m_tileSize);
+
+	if (!this->m_subdomains.is_empty()) {
+		std::vector<std::string> subdomains;
+		subdomains.reserve(this->m_subdomains.size());
+		for (int32_t i = 0; i < this->m_subdomains.size(); i++) {
+			subdomains.emplace_back(this->m_subdomains[i].utf8().get_data());
+		}
+		wmtsOptions.subdomains = std::move(subdomains);
+	}
+
+	return new CesiumRasterOverlays::WebMapTileServiceRasterOverlay(
+		this->m_materialKey.utf8().get_data(),
+		this->m_url.utf8().get_data(),
+		this->get_cesium_headers(),
+		wmtsOptions,
+		overlayOptions
+	);
+}
+
+void CesiumWebMapTileServiceRasterOverlay::_bind_methods()
+{
+	ClassDB::bind_method(D_METHOD("set_layer", "layer"), &CesiumWebMapTileServiceRasterOverlay::set_layer);
+	ClassDB::bind_method(D_METHOD("get_layer"), &CesiumWebMapTileServiceRasterOverlay::get_layer);
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "layer"), "set_layer", "get_layer");
+
+	ClassDB::bind_method(D_METHOD("set_style", "style"), &CesiumWebMapTileServiceRasterOverlay::set_style);
+	ClassDB::bind_method(D_METHOD("get_style"), &CesiumWebMapTileServiceRasterOverlay::get_style);
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "style"), "set_style", "get_style");
+
+	ClassDB::bind_method(D_METHOD("set_tile_matrix_set_id", "id"), &CesiumWebMapTileServiceRasterOverlay::set_tile_matrix_set_id);
+	ClassDB::bind_method(D_METHOD("get_tile_matrix_set_id"), &CesiumWebMapTileServiceRasterOverlay::get_tile_matrix_set_id);
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "tile_matrix_set_id"), "set_tile_matrix_set_id", "get_tile_matrix_set_id");
+
+	ClassDB::bind_method(D_METHOD("set_format", "format"), &CesiumWebMapTileServiceRasterOverlay::set_format);
+	ClassDB::bind_method(D_METHOD("get_format"), &CesiumWebMapTileServiceRasterOverlay::get_format);
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "format"), "set_format", "get_format");
+
+	ClassDB::bind_method(D_METHOD("set_subdomains", "subdomains"), &CesiumWebMapTileServiceRasterOverlay::set_subdomains);
+	ClassDB::bind_method(D_METHOD("get_subdomains"), &CesiumWebMapTileServiceRasterOverlay::get_subdomains);
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_STRING_ARRAY, "subdomains"), "set_subdomains", "get_subdomains");
+
+	ClassDB::bind_method(D_METHOD("set_tile_size", "size"), &CesiumWebMapTileServiceRasterOverlay::set_tile_size);
+	ClassDB::bind_method(D_METHOD("get_tile_size"), &CesiumWebMapTileServiceRasterOverlay::get_tile_size);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tile_size", PROPERTY_HINT_RANGE, "1,4096,1"), "set_tile_size", "get_tile_size");
+}
+
+#pragma endregion
@@ -0,0 +1,183 @@
+#ifndef CESIUM_GD_URL_RASTER_OVERLAY_H
+#define CESIUM_GD_URL_RASTER_OVERLAY_H
+
+#include "CesiumGDRasterOverlay.h"
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_string_array.hpp>
+using namespace godot;
+#endif
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumGeometry/QuadtreeTilingScheme.h>
+#include <CesiumGeospatial/Projection.h>
+#include <optional>
+#include <vector>
+
+/// @brief Shared settings of the overlays that pull tiles straight from a URL, either a tile server or a file:// path on disk
+class CesiumUrlRasterOverlay : public CesiumRasterOverlay {
+	GDCLASS(CesiumUrlRasterOverlay, CesiumRasterOverlay)
+public:
+	enum class OverlayProjection : int32_t {
+		WebMercator,
+		Geographic
+	};
+
+#pragma region Editor Properties
+	void set_url(const String& url);
+
+	const String& get_url() const;
+
+	void set_request_headers(const Dictionary& headers);
+
+	Dictionary get_request_headers() const;
+
+	void set_credit(const String& credit);
+
+	const String& get_credit() const;
+
+	void set_minimum_level(int32_t level);
+
+	int32_t get_minimum_level() const;
+
+	void set_maximum_level(int32_t level);
+
+	int32_t get_maximum_level() const;
+
+	void set_projection(int32_t projection);
+
+	int32_t get_projection() const;
+
+#pragma endregion
+
+protected:
+	std::vector<CesiumAsync::IAssetAccessor::THeader> get_cesium_headers() const;
+
+	std::optional<std::string> get_cesium_credit() const;
+
+	CesiumGeospatial::Projection get_cesium_projection() const;
+
+	/// @brief Root tiles matching the selected projection, one for Web Mercator and two for geographic
+	CesiumGeometry::QuadtreeTilingScheme get_cesium_tiling_scheme() const;
+
+	bool is_url_valid() const;
+
+	static void _bind_methods();
+
+	String m_url;
+
+	Dictionary m_requestHeaders;
+
+	String m_credit;
+
+	int32_t m_minimumLevel = 0;
+
+	int32_t m_maximumLevel = 25;
+
+	OverlayProjection m_projection = OverlayProjection::WebMercator;
+};
+
+/// @brief Tiles addressed through a URL template, e.g. https://tiles.example.com/{z}/{x}/{y}.png (XYZ / slippy map servers)
+class CesiumUrlTemplateRasterOverlay : public CesiumUrlRasterOverlay {
+	GDCLASS(CesiumUrlTemplateRasterOverlay, CesiumUrlRasterOverlay)
+public:
+#pragma region Editor Properties
+	void set_tile_width(int32_t width);
+
+	int32_t get_tile_width() const;
+
+	void set_tile_height(int32_t height);
+
+	int32_t get_tile_height() const;
+
+#pragma endregion
+
+protected:
+	CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> create_overlay(const CesiumRasterOverlays::RasterOverlayOptions& overlayOptions) override;
+
+	static void _bind_methods();
+
+private:
+	int32_t m_tileWidth = 256;
+
+	int32_t m_tileHeight = 256;
+};
+
+/// @brief Tile Map Service source, the URL points to the folder holding tilemapresource.xml (gdal2tiles output works as is)
+class CesiumTileMapServiceRasterOverlay : public CesiumUrlRasterOverlay {
+	GDCLASS(CesiumTileMapServiceRasterOverlay, CesiumUrlRasterOverlay)
+public:
+#pragma region Editor Properties
+	void set_file_extension(const String& extension);
+
+	const String& get_file_extension() const;
+
+	void set_flip_xy(bool flip);
+
+	bool get_flip_xy() const;
+
+#pragma endregion
+
+protected:
+	CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> create_overlay(const CesiumRasterOverlays::RasterOverlayOptions& overlayOptions) override;
+
+	static void _bind_methods();
+
+private:
+	String m_fileExtension = "png";
+
+	bool m_flipXY = false;
+};
+
+/// @brief OGC Web Map Tile Service source, supports both KVP and RESTful (template) URLs
+class CesiumWebMapTileServiceRasterOverlay : public CesiumUrlRasterOverlay {
+	GDCLASS(CesiumWebMapTileServiceRasterOverlay, CesiumUrlRasterOverlay)
+public:
+#pragma region Editor Properties
+	void set_layer(const String& layer);
+
+	const String& get_layer() const;
+
+	void set_style(const String& style);
+
+	const String& get_style() const;
+
+	void set_tile_matrix_set_id(const String& id);
+
+	const String& get_tile_matrix_set_id() const;
+
+	void set_format(const String& format);
+
+	const String& get_format() const;
+
+	void set_subdomains(const PackedStringArray& subdomains);
+
+	PackedStringArray get_subdomains() const;
+
+	void set_tile_size(int32_t size);
+
+	int32_t get_tile_size() const;
+
+#pragma endregion
+
+protected:
+	CesiumUtility::IntrusivePointer<CesiumRasterOverlays::RasterOverlay> create_overlay(const CesiumRasterOverlays::RasterOverlayOptions& overlayOptions) override;
+
+	static void _bind_methods();
+
+private:
+	String m_layer;
+
+	String m_style = "default";
+
+	String m_tileMatrixSetId;
+
+	String m_format = "image/jpeg";
+
+	PackedStringArray m_subdomains;
+
+	int32_t m_tileSize = 256;
+};
+
+#endif // !CESIUM_GD_URL_RASTER_OVERLAY_H
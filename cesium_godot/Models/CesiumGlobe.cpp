@@ -4,6 +4,7 @@
 #include "glm/ext/vector_double3.hpp"
 #include "godot_cpp/core/math.hpp"
 #include "godot_cpp/variant/vector3.hpp"
+#include <algorithm>
 #include <cstdint>
 
 #if defined(CESIUM_GD_EXT)
@@ -199,6 +200,8 @@ glm::dvec3 CesiumGeoreference::get_lla() const {
 
 
 void CesiumGeoreference::register_tileset_to_move_origin(Cesium3DTileset* tileset) {
+	// Tilesets register each time they (re)load, track every one of them once
+	if (std::find(this->m_trackedTilesets.begin(), this->m_trackedTilesets.end(), tileset) != this->m_trackedTilesets.end()) return;
 	this->m_trackedTilesets.emplace_back(tileset);
 }
 
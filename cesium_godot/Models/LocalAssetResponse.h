@@ -3,6 +3,9 @@
 
 #include <CesiumAsync/IAssetResponse.h>
 #include <cstdint>
+#include <memory>
+#include <utility>
+#include "../Utils/MappedFile.h"
 #if defined(CESIUM_GD_EXT)
 #include <godot_cpp/variant/variant.hpp>
 #include <godot_cpp/templates/vector.hpp>
@@ -17,11 +20,24 @@ public:
 		uint16_t statusCode,
 		const std::string& contentType,
 		const CesiumAsync::HttpHeaders& headers,
-		const PackedByteArray& data)
+		PackedByteArray data)
 		: m_statusCode{ statusCode },
 		m_contentType{ contentType },
 		m_headers{ headers },
-		m_data{ data } {}
+		m_data{ std::move(data) } {}
+
+	/// @brief Serves the body straight from the mapped file's pages (the whole file or a range of it), the mapping lives as long as the response
+	LocalAssetResponse(
+		uint16_t statusCode,
+		const std::string& contentType,
+		const CesiumAsync::HttpHeaders& headers,
+		std::shared_ptr<const MappedFile> mappedFile,
+		std::span<const std::byte> mappedBytes)
+		: m_statusCode{ statusCode },
+		m_contentType{ contentType },
+		m_headers{ headers },
+		m_mappedFile{ std::move(mappedFile) },
+		m_mappedBytes{ mappedBytes } {}
 
 	/**
 	* @brief Returns the HTTP response code.
@@ -45,9 +61,12 @@ public:
 	}
 
 	/**
-	 * @brief Returns the data of this response
+	 * @brief Returns the data of this response, a view over the buffer curl wrote into or the mapped file (no copy is made)
 	 */
 	std::span<const std::byte> data() const override {
+		if (this->m_mappedFile != nullptr) {
+			return this->m_mappedBytes;
+		}
 		const std::byte* bytePtr = reinterpret_cast<const std::byte*>(this->m_data.ptr());
 		return std::span<const std::byte>(bytePtr, bytePtr + this->m_data.size());
 	}
@@ -57,6 +76,8 @@ private:
 	std::string m_contentType;
 	CesiumAsync::HttpHeaders m_headers;
 	PackedByteArray m_data;
+	std::shared_ptr<const MappedFile> m_mappedFile;
+	std::span<const std::byte> m_mappedBytes;
 };
 
 #endif // !LOCAL_ASSET_RESPONSE_H
@@ -0,0 +1,201 @@
+#include "CesiumCacheCompressor.h"
+
+#include <zstd.h>
+#include <zdict.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <mutex>
+
+// Compression runs on the cache writer thread, off the request path, so it can afford more than zstd's default
+constexpr int COMPRESSION_LEVEL = 6;
+// zstd's own default dictionary size
+constexpr size_t DICTIONARY_CAPACITY = 112 * 1024;
+constexpr size_t MIN_TRAINING_SAMPLES = 64;
+constexpr size_t MIN_TRAINING_BYTES = 512 * 1024;
+// The start of a body carries most of what tiles have in common (headers, JSON chunks), large bodies only add their prefix
+constexpr size_t MAX_SAMPLE_BYTES = 128 * 1024;
+constexpr size_t MAX_SAMPLES_BYTES = 8 * 1024 * 1024;
+
+namespace {
+	bool starts_with(std::span<const std::byte> data, const char* magic, size_t offset = 0)
+	{
+		const size_t size = strlen(magic);
+		return data.size() >= offset + size && memcmp(data.data() + offset, magic, size) == 0;
+	}
+
+	std::string to_lower(std::string text)
+	{
+		std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return text;
+	}
+
+	std::string get_extension(const std::string& url)
+	{
+		const std::string path = url.substr(0, url.find_first_of("?#"));
+		const size_t dot = path.find_last_of('.');
+		if (dot == std::string::npos || path.find('/', dot) != std::string::npos) return std::string();
+		return to_lower(path.substr(dot + 1));
+	}
+
+	struct DecompressionContextDeleter_t {
+		void operator()(ZSTD_DCtx* context) const
+		{
+			ZSTD_freeDCtx(context);
+		}
+	};
+}
+
+CesiumCacheCompressor::ContentType CesiumCacheCompressor::classify(const std::string& url, const CesiumAsync::HttpHeaders& responseHeaders, std::span<const std::byte> data)
+{
+	if (starts_with(data, "glTF") || starts_with(data, "b3dm") || starts_with(data, "i3dm") || starts_with(data, "pnts") || starts_with(data, "cmpt")) {
+		return ContentType::Model;
+	}
+	if (starts_with(data, "\x89PNG") || starts_with(data, "\xFF\xD8\xFF") || starts_with(data, "\xABKTX") ||
+			(starts_with(data, "RIFF") && starts_with(data, "WEBP", 8))) {
+		return ContentType::Imagery;
+	}
+
+	std::string contentType;
+	auto header = responseHeaders.find("content-type");
+	if (header == responseHeaders.end()) header = responseHeaders.find("Content-Type");
+	if (header != responseHeaders.end()) contentType = to_lower(header->second);
+	const std::string extension = get_extension(url);
+	if (contentType.find("quantized-mesh") != std::string::npos || extension == "terrain") {
+		return ContentType::QuantizedMesh;
+	}
+	if (contentType.find("image/") == 0) {
+		return ContentType::Imagery;
+	}
+
+	const auto firstCharacter = std::find_if(data.begin(), data.end(), [](std::byte b) {
+		return !std::isspace(static_cast<unsigned char>(b));
+	});
+	if ((firstCharacter != data.end() && *firstCharacter == std::byte{ '{' }) || contentType.find("json") != std::string::npos || extension == "json") {
+		return ContentType::TilesetJson;
+	}
+	return ContentType::Other;
+}
+
+CesiumCacheCompressor::CesiumCacheCompressor()
+{
+	this->m_compressionContext = ZSTD_createCCtx();
+}
+
+CesiumCacheCompressor::~CesiumCacheCompressor()
+{
+	ZSTD_freeCCtx(this->m_compressionContext);
+	for (CompressionDictionary_t& dictionary : this->m_compressionDictionaries) {
+		ZSTD_freeCDict(dictionary.dictionary);
+	}
+	for (auto& [id, dictionary] : this->m_decompressionDictionaries) {
+		ZSTD_freeDDict(dictionary);
+	}
+}
+
+bool CesiumCacheCompressor::compress(ContentType type, std::span<const std::byte> data, std::vector<std::byte>* output, int64_t* outDictionaryId)
+{
+	*outDictionaryId = 0;
+	if (this->m_compressionContext == nullptr || data.empty()) return false;
+	const CompressionDictionary_t& dictionary = this->m_compressionDictionaries[static_cast<size_t>(type)];
+
+	output->resize(ZSTD_compressBound(data.size()));
+	const size_t compressedSize = dictionary.dictionary != nullptr ?
+		ZSTD_compress_usingCDict(this->m_compressionContext, output->data(), output->size(), data.data(), data.size(), dictionary.dictionary) :
+		ZSTD_compressCCtx(this->m_compressionContext, output->data(), output->size(), data.data(), data.size(), COMPRESSION_LEVEL);
+	// Already compressed payloads barely shrink, decompressing them on every hit would be a loss
+	if (ZSTD_isError(compressedSize) || compressedSize > data.size() - data.size() / 16) {
+		output->clear();
+		return false;
+	}
+	output->resize(compressedSize);
+	*outDictionaryId = dictionary.dictionary != nullptr ? dictionary.id : 0;
+	return true;
+}
+
+bool CesiumCacheCompressor::add_sample(ContentType type, std::span<const std::byte> data)
+{
+	if (this->m_compressionDictionaries[static_cast<size_t>(type)].dictionary != nullptr || data.empty()) return false;
+	Samples_t& samples = this->m_samples[static_cast<size_t>(type)];
+	const size_t size = std::min(data.size(), MAX_SAMPLE_BYTES);
+	if (samples.buffer.size() + size <= MAX_SAMPLES_BYTES) {
+		samples.buffer.insert(samples.buffer.end(), data.begin(), data.begin() + size);
+		samples.sizes.push_back(size);
+	}
+	return samples.sizes.size() >= MIN_TRAINING_SAMPLES && samples.buffer.size() >= MIN_TRAINING_BYTES;
+}
+
+std::vector<std::byte> CesiumCacheCompressor::train_dictionary(ContentType type)
+{
+	Samples_t samples = std::move(this->m_samples[static_cast<size_t>(type)]);
+	this->m_samples[static_cast<size_t>(type)] = Samples_t{};
+	if (samples.sizes.empty()) return {};
+
+	std::vector<std::byte> dictionary(DICTIONARY_CAPACITY);
+	const size_t dictionarySize = ZDICT_trainFromBuffer(
+		dictionary.data(),
+		dictionary.size(),
+		samples.buffer.data(),
+		samples.sizes.data(),
+		static_cast<unsigned>(samples.sizes.size()));
+	if (ZDICT_isError(dictionarySize)) return {};
+	dictionary.resize(dictionarySize);
+	return dictionary;
+}
+
+void CesiumCacheCompressor::set_compression_dictionary(ContentType type, int64_t dictionaryId, std::span<const std::byte> dictionary)
+{
+	CompressionDictionary_t& slot = this->m_compressionDictionaries[static_cast<size_t>(type)];
+	ZSTD_CDict* compressionDictionary = ZSTD_createCDict(dictionary.data(), dictionary.size(), COMPRESSION_LEVEL);
+	if (compressionDictionary == nullptr) return;
+	ZSTD_freeCDict(slot.dictionary);
+	slot.dictionary = compressionDictionary;
+	slot.id = dictionaryId;
+	// No need to keep training samples around for a type that has its dictionary
+	this->m_samples[static_cast<size_t>(type)] = Samples_t{};
+	this->add_decompression_dictionary(dictionaryId, dictionary);
+}
+
+void CesiumCacheCompressor::add_decompression_dictionary(int64_t dictionaryId, std::span<const std::byte> dictionary)
+{
+	ZSTD_DDict* decompressionDictionary = ZSTD_createDDict(dictionary.data(), dictionary.size());
+	if (decompressionDictionary == nullptr) return;
+	std::unique_lock lock(this->m_decompressionMutex);
+	auto [it, inserted] = this->m_decompressionDictionaries.emplace(dictionaryId, decompressionDictionary);
+	if (!inserted) {
+		ZSTD_freeDDict(decompressionDictionary);
+	}
+}
+
+bool CesiumCacheCompressor::has_decompression_dictionary(int64_t dictionaryId) const
+{
+	std::shared_lock lock(this->m_decompressionMutex);
+	return this->m_decompressionDictionaries.contains(dictionaryId);
+}
+
+bool CesiumCacheCompressor::decompress(std::span<const std::byte> data, int64_t dictionaryId, std::vector<std::byte>* output) const
+{
+	const unsigned long long contentSize = ZSTD_getFrameContentSize(data.data(), data.size());
+	if (contentSize == ZSTD_CONTENTSIZE_ERROR || contentSize == ZSTD_CONTENTSIZE_UNKNOWN) return false;
+
+	// One context per load thread, creating them per call would dominate small tiles
+	thread_local std::unique_ptr<ZSTD_DCtx, DecompressionContextDeleter_t> context(ZSTD_createDCtx());
+	if (context == nullptr) return false;
+
+	output->resize(static_cast<size_t>(contentSize));
+	size_t decompressedSize;
+	if (dictionaryId != 0) {
+		std::shared_lock lock(this->m_decompressionMutex);
+		auto it = this->m_decompressionDictionaries.find(dictionaryId);
+		if (it == this->m_decompressionDictionaries.end()) return false;
+		decompressedSize = ZSTD_decompress_usingDDict(context.get(), output->data(), output->size(), data.data(), data.size(), it->second);
+	}
+	else {
+		decompressedSize = ZSTD_decompressDCtx(context.get(), output->data(), output->size(), data.data(), data.size());
+	}
+	if (ZSTD_isError(decompressedSize) || decompressedSize != output->size()) {
+		output->clear();
+		return false;
+	}
+	return true;
+}
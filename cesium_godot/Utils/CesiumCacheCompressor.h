@@ -0,0 +1,92 @@
+#ifndef CESIUM_CACHE_COMPRESSOR_H
+#define CESIUM_CACHE_COMPRESSOR_H
+
+#include <CesiumAsync/HttpHeaders.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ZSTD_CCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+/**
+ * @brief zstd compression of cached response bodies with one trained dictionary per kind of content
+ * Tiles of one tileset share most of their structure (glTF JSON chunks, feature tables, quantized-mesh headers), so a dictionary
+ * trained on the first bodies of a kind compresses the following ones far better than zstd alone. Bodies stored before the
+ * dictionary exists are compressed without one, bodies that don't get smaller (JPEG / PNG imagery mostly) are stored as is
+ * @note Training and compression belong to the cache writer thread, decompression may run on any thread
+ */
+class CesiumCacheCompressor {
+public:
+	enum class ContentType : uint8_t {
+		TilesetJson,
+		Model,
+		QuantizedMesh,
+		Imagery,
+		Other,
+		Count
+	};
+
+	/// @brief Looks at the first bytes of the body, then the Content-Type header and the URL extension
+	static ContentType classify(const std::string& url, const CesiumAsync::HttpHeaders& responseHeaders, std::span<const std::byte> data);
+
+	CesiumCacheCompressor();
+
+	~CesiumCacheCompressor();
+
+	CesiumCacheCompressor(const CesiumCacheCompressor&) = delete;
+
+	CesiumCacheCompressor& operator=(const CesiumCacheCompressor&) = delete;
+
+	/// @brief False when compressing doesn't pay off, outDictionaryId is 0 when no dictionary was used
+	bool compress(ContentType type, std::span<const std::byte> data, std::vector<std::byte>* output, int64_t* outDictionaryId);
+
+	/// @brief Keeps the body for training while the content type has no dictionary, true once there are enough samples
+	bool add_sample(ContentType type, std::span<const std::byte> data);
+
+	/// @brief Trains on the collected samples and drops them, empty when training failed
+	std::vector<std::byte> train_dictionary(ContentType type);
+
+	/// @brief Dictionary used for the following bodies of that type, also registered for decompression
+	void set_compression_dictionary(ContentType type, int64_t dictionaryId, std::span<const std::byte> dictionary);
+
+	void add_decompression_dictionary(int64_t dictionaryId, std::span<const std::byte> dictionary);
+
+	bool has_decompression_dictionary(int64_t dictionaryId) const;
+
+	/// @brief False when the frame is corrupt or its dictionary is unknown
+	bool decompress(std::span<const std::byte> data, int64_t dictionaryId, std::vector<std::byte>* output) const;
+
+private:
+	struct Samples_t {
+		std::vector<std::byte> buffer;
+		std::vector<size_t> sizes;
+	};
+
+	struct CompressionDictionary_t {
+		int64_t id = 0;
+		ZSTD_CDict_s* dictionary = nullptr;
+	};
+
+	static constexpr size_t CONTENT_TYPE_COUNT = static_cast<size_t>(ContentType::Count);
+
+	/// @brief Writer thread only, like the compression dictionaries and the samples
+	ZSTD_CCtx_s* m_compressionContext = nullptr;
+
+	std::array<CompressionDictionary_t, CONTENT_TYPE_COUNT> m_compressionDictionaries{};
+
+	std::array<Samples_t, CONTENT_TYPE_COUNT> m_samples{};
+
+	mutable std::shared_mutex m_decompressionMutex;
+
+	std::unordered_map<int64_t, ZSTD_DDict_s*> m_decompressionDictionaries;
+};
+
+#endif // !CESIUM_CACHE_COMPRESSOR_H
@@ -3,8 +3,15 @@
 #include "godot_cpp/classes/rendering_server.hpp"
 #include <godot_cpp/templates/vector.hpp>
 #include <godot_cpp/classes/array_mesh.hpp>
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/time.hpp>
 #endif
 
+#include "CesiumMipChainBuilder.h"
+#include "CesiumGltfReader/ImageDecoder.h"
+#include <cstring>
+#include <random>
+
 void CesiumDebugUtils::draw_line(const Vector3& from, const Vector3& to, const Color& color)
 {
 
@@ -20,7 +27,59 @@ void CesiumDebugUtils::draw_thick_line(const Vector3& from, const Vector3& to, r
 
 }
 
+Dictionary CesiumDebugUtils::benchmark_mipmap_generation(int32_t width, int32_t height, int32_t iterations)
+{
+	Dictionary results;
+	ERR_FAIL_COND_V_MSG(width <= 0 || height <= 0 || iterations <= 0, results, "Benchmark dimensions and iterations must be positive");
+
+	CesiumGltf::ImageAsset source;
+	source.width = width;
+	source.height = height;
+	source.channels = 4;
+	source.bytesPerChannel = 1;
+	source.pixelData.resize(static_cast<size_t>(width) * height * 4);
+	std::mt19937 random(1337);
+	for (std::byte& value : source.pixelData) {
+		value = static_cast<std::byte>(random() & 0xFF);
+	}
+
+	PackedByteArray baseLevel;
+	baseLevel.resize(source.pixelData.size());
+	memcpy(baseLevel.ptrw(), source.pixelData.data(), source.pixelData.size());
+
+	Time* time = Time::get_singleton();
+	auto measure = [&](auto&& generate) {
+		uint64_t totalUsec = 0;
+		for (int32_t i = 0; i < iterations; i++) {
+			uint64_t start = time->get_ticks_usec();
+			generate();
+			totalUsec += time->get_ticks_usec() - start;
+		}
+		return static_cast<double>(totalUsec) / iterations / 1000.0;
+	};
+
+	results["cesium_image_decoder_ms"] = measure([&]() {
+		CesiumGltf::ImageAsset image = source;
+		CesiumGltfReader::ImageDecoder::generateMipMaps(image);
+	});
+	results["godot_image_ms"] = measure([&]() {
+		Ref<Image> image = Image::create_from_data(width, height, false, Image::FORMAT_RGBA8, baseLevel);
+		image->generate_mipmaps();
+	});
+	results["chain_builder_linear_ms"] = measure([&]() {
+		CesiumMipChainBuilder::build_image_data(source, false);
+	});
+	results["chain_builder_srgb_ms"] = measure([&]() {
+		CesiumMipChainBuilder::build_image_data(source, true);
+	});
+	results["width"] = width;
+	results["height"] = height;
+	results["iterations"] = iterations;
+	return results;
+}
+
 void CesiumDebugUtils::_bind_methods()
 {
 	ClassDB::bind_static_method("CesiumDebugUtils", D_METHOD("draw_line", "from", "to", "color"), &CesiumDebugUtils::draw_line);
+	ClassDB::bind_static_method("CesiumDebugUtils", D_METHOD("benchmark_mipmap_generation", "width", "height", "iterations"), &CesiumDebugUtils::benchmark_mipmap_generation);
 }
@@ -18,6 +18,9 @@ public:
 
 	static void draw_thick_line(const Vector3& from, const Vector3& to, real_t width, const Color& color);
 
+	/// @brief Times every mip generation path on a random RGBA8 image, returns the average milliseconds per chain for each one
+	static Dictionary benchmark_mipmap_generation(int32_t width, int32_t height, int32_t iterations);
+
 protected:
 	static void _bind_methods();
 
@@ -2,26 +2,31 @@
 #include "CesiumGltf/ImageAsset.h"
 #include "godot_cpp/core/error_macros.hpp"
 #include "error_names.hpp"
+#include "CesiumMipChainBuilder.h"
+#include <cstring>
 
 constexpr int32_t RGBA_CHANNEL_COUNT = 4;
 constexpr int32_t RGB_CHANNEL_COUNT = 3;
 
 Ref<ImageTexture> CesiumGDTextureLoader::load_image_texture(const CesiumGltf::ImageAsset& image, bool generateMipMaps, bool imageHasMipMaps)
 {
-	//TODO: we can probably optimize this
-	PackedByteArray rawImageData;
-	size_t pixelSize = image.pixelData.size();
-
-	for (size_t i = 0; i < pixelSize; ++i)
-	{
-		const std::byte& element = image.pixelData.at(i);
-		rawImageData.push_back(static_cast<uint8_t>(element));
-	}
-
 	Image::Format cesiumFormat;
 	Error err = try_get_image_format(image.channels, image.bytesPerChannel, &cesiumFormat);
 	ERR_FAIL_COND_V_MSG(err != Error::OK, Ref<ImageTexture>(), "Image format not recognized!");
 
+	// Base color textures are sRGB, build their chain straight into the buffer we hand to Godot
+	if (generateMipMaps && !imageHasMipMaps && CesiumMipChainBuilder::is_supported(image.channels, image.bytesPerChannel)) {
+		PackedByteArray chainData = CesiumMipChainBuilder::build_image_data(image, true);
+		if (!chainData.is_empty()) {
+			Ref<Image> godotImage = Image::create_from_data(image.width, image.height, true, cesiumFormat, chainData);
+			return ImageTexture::create_from_image(godotImage);
+		}
+	}
+
+	PackedByteArray rawImageData;
+	rawImageData.resize(image.pixelData.size());
+	memcpy(rawImageData.ptrw(), image.pixelData.data(), image.pixelData.size());
+
 	Ref<Image> godotImage = Image::create_from_data(
 		image.width,
 		image.height,
@@ -30,7 +35,7 @@ Ref<ImageTexture> CesiumGDTextureLoader::load_image_texture(const CesiumGltf::Im
 		rawImageData
 	);
 
-	if (generateMipMaps) {
+	if (generateMipMaps && !imageHasMipMaps) {
 		err = godotImage->generate_mipmaps();
 
 		if (err != Error::OK) {
@@ -0,0 +1,209 @@
+#include "CesiumMipChainBuilder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CESIUM_MIP_SSE2
+#include <emmintrin.h>
+#endif
+
+constexpr int32_t RGBA_CHANNEL_COUNT = 4;
+constexpr int32_t RGB_CHANNEL_COUNT = 3;
+constexpr int32_t ALPHA_CHANNEL = 3;
+constexpr int32_t LINEAR_TO_SRGB_STEPS = 4096;
+
+namespace {
+	struct SrgbTables {
+		std::array<float, 256> toLinear;
+		std::array<uint8_t, LINEAR_TO_SRGB_STEPS> toSrgb;
+
+		SrgbTables() {
+			for (int32_t i = 0; i < 256; i++) {
+				float c = i / 255.0f;
+				toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for (int32_t i = 0; i < LINEAR_TO_SRGB_STEPS; i++) {
+				float l = i / float(LINEAR_TO_SRGB_STEPS - 1);
+				float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+				toSrgb[i] = static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+			}
+		}
+	};
+
+	const SrgbTables& get_srgb_tables() {
+		static const SrgbTables tables;
+		return tables;
+	}
+}
+
+bool CesiumMipChainBuilder::is_supported(int32_t channels, int32_t bytesPerChannel)
+{
+	return bytesPerChannel == 1 && (channels == RGBA_CHANNEL_COUNT || channels == RGB_CHANNEL_COUNT);
+}
+
+size_t CesiumMipChainBuilder::get_chain_size(int32_t width, int32_t height, int32_t channels)
+{
+	size_t size = 0;
+	while (true) {
+		size += static_cast<size_t>(width) * height * channels;
+		if (width == 1 && height == 1) break;
+		width = std::max(1, width >> 1);
+		height = std::max(1, height >> 1);
+	}
+	return size;
+}
+
+void CesiumMipChainBuilder::build_chain(uint8_t* buffer, int32_t width, int32_t height, int32_t channels, bool isSrgb)
+{
+	uint8_t* source = buffer;
+	while (width > 1 || height > 1) {
+		uint8_t* destination = source + static_cast<size_t>(width) * height * channels;
+		downsample_level(source, width, height, destination, channels, isSrgb);
+		source = destination;
+		width = std::max(1, width >> 1);
+		height = std::max(1, height >> 1);
+	}
+}
+
+void CesiumMipChainBuilder::build_region(uint8_t* buffer, int32_t width, int32_t height, int32_t channels, bool isSrgb, int32_t regionX, int32_t regionY, int32_t regionWidth, int32_t regionHeight, int32_t levelCount)
+{
+	uint8_t* source = buffer;
+	for (int32_t level = 1; level <= levelCount && (width > 1 || height > 1); level++) {
+		uint8_t* destination = source + static_cast<size_t>(width) * height * channels;
+		const int32_t destinationWidth = std::max(1, width >> 1);
+		const int32_t destinationHeight = std::max(1, height >> 1);
+		// Rounded outwards, a partially covered texel has to be refiltered too
+		const int32_t levelMask = (1 << level) - 1;
+		const int32_t x0 = regionX >> level;
+		const int32_t y0 = regionY >> level;
+		const int32_t x1 = std::min(destinationWidth, (regionX + regionWidth + levelMask) >> level);
+		const int32_t y1 = std::min(destinationHeight, (regionY + regionHeight + levelMask) >> level);
+		downsample_area(source, width, height, destination, x0, y0, x1, y1, channels, isSrgb);
+		source = destination;
+		width = destinationWidth;
+		height = destinationHeight;
+	}
+}
+
+Error CesiumMipChainBuilder::generate_mipmaps(CesiumGltf::ImageAsset& image, bool isSrgb)
+{
+	ERR_FAIL_COND_V_MSG(!is_supported(image.channels, image.bytesPerChannel), Error::ERR_UNAVAILABLE, "Mip chain builder only handles 8 bit RGB / RGBA images");
+	ERR_FAIL_COND_V(image.compressedPixelFormat != CesiumGltf::GpuCompressedPixelFormat::NONE, Error::ERR_UNAVAILABLE);
+
+	const size_t baseSize = static_cast<size_t>(image.width) * image.height * image.channels;
+	ERR_FAIL_COND_V(image.pixelData.size() < baseSize, Error::ERR_FILE_CORRUPT);
+
+	image.pixelData.resize(get_chain_size(image.width, image.height, image.channels));
+	build_chain(reinterpret_cast<uint8_t*>(image.pixelData.data()), image.width, image.height, image.channels, isSrgb);
+
+	image.mipPositions.clear();
+	size_t offset = 0;
+	int32_t width = image.width;
+	int32_t height = image.height;
+	while (true) {
+		const size_t levelSize = static_cast<size_t>(width) * height * image.channels;
+		image.mipPositions.push_back(CesiumGltf::ImageAssetMipPosition{ offset, levelSize });
+		offset += levelSize;
+		if (width == 1 && height == 1) break;
+		width = std::max(1, width >> 1);
+		height = std::max(1, height >> 1);
+	}
+	return Error::OK;
+}
+
+PackedByteArray CesiumMipChainBuilder::build_image_data(const CesiumGltf::ImageAsset& image, bool isSrgb)
+{
+	PackedByteArray data;
+	ERR_FAIL_COND_V(!is_supported(image.channels, image.bytesPerChannel), data);
+	const size_t baseSize = static_cast<size_t>(image.width) * image.height * image.channels;
+	ERR_FAIL_COND_V(image.pixelData.size() < baseSize, data);
+
+	data.resize(get_chain_size(image.width, image.height, image.channels));
+	uint8_t* buffer = data.ptrw();
+	memcpy(buffer, image.pixelData.data(), baseSize);
+	build_chain(buffer, image.width, image.height, image.channels, isSrgb);
+	return data;
+}
+
+void CesiumMipChainBuilder::downsample_level(const uint8_t* source, int32_t sourceWidth, int32_t sourceHeight, uint8_t* destination, int32_t channels, bool isSrgb)
+{
+	downsample_area(source, sourceWidth, sourceHeight, destination, 0, 0, std::max(1, sourceWidth >> 1), std::max(1, sourceHeight >> 1), channels, isSrgb);
+}
+
+void CesiumMipChainBuilder::downsample_area(const uint8_t* source, int32_t sourceWidth, int32_t sourceHeight, uint8_t* destination, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t channels, bool isSrgb)
+{
+	const int32_t destinationWidth = std::max(1, sourceWidth >> 1);
+	const size_t sourceStride = static_cast<size_t>(sourceWidth) * channels;
+	const SrgbTables* tables = isSrgb ? &get_srgb_tables() : nullptr;
+
+	for (int32_t y = y0; y < y1; y++) {
+		// Odd or single texel dimensions reuse the last row / column instead of reading past it
+		const uint8_t* row0 = source + std::min(y * 2, sourceHeight - 1) * sourceStride;
+		const uint8_t* row1 = source + std::min(y * 2 + 1, sourceHeight - 1) * sourceStride;
+		uint8_t* destinationRow = destination + static_cast<size_t>(y) * destinationWidth * channels;
+
+		int32_t x = x0;
+		if (!isSrgb && channels == RGBA_CHANNEL_COUNT && sourceWidth >= 2) {
+			const size_t sourceOffset = static_cast<size_t>(x0) * 2 * channels;
+			x += downsample_rows_rgba8_simd(row0 + sourceOffset, row1 + sourceOffset, std::min(x1, sourceWidth >> 1) - x0, destinationRow + static_cast<size_t>(x0) * channels);
+		}
+
+		for (; x < x1; x++) {
+			const int32_t left = std::min(x * 2, sourceWidth - 1) * channels;
+			const int32_t right = std::min(x * 2 + 1, sourceWidth - 1) * channels;
+			for (int32_t c = 0; c < channels; c++) {
+				if (tables == nullptr || c == ALPHA_CHANNEL) {
+					const uint32_t sum = row0[left + c] + row0[right + c] + row1[left + c] + row1[right + c];
+					destinationRow[x * channels + c] = static_cast<uint8_t>((sum + 2) >> 2);
+					continue;
+				}
+				const float linear = (tables->toLinear[row0[left + c]] + tables->toLinear[row0[right + c]] +
+						tables->toLinear[row1[left + c]] + tables->toLinear[row1[right + c]]) * 0.25f;
+				destinationRow[x * channels + c] = tables->toSrgb[static_cast<int32_t>(linear * (LINEAR_TO_SRGB_STEPS - 1) + 0.5f)];
+			}
+		}
+	}
+}
+
+int32_t CesiumMipChainBuilder::downsample_rows_rgba8_simd(const uint8_t* row0, const uint8_t* row1, int32_t destinationWidth, uint8_t* destination)
+{
+#if defined(CESIUM_MIP_SSE2)
+	// 8 source texels per row produce 4 destination texels per iteration
+	constexpr int32_t TEXELS_PER_STEP = 4;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi16(2);
+	int32_t x = 0;
+	for (; x + TEXELS_PER_STEP <= destinationWidth; x += TEXELS_PER_STEP) {
+		const size_t offset = static_cast<size_t>(x) * 2 * RGBA_CHANNEL_COUNT;
+		const __m128i r0a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + offset));
+		const __m128i r0b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + offset + 16));
+		const __m128i r1a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + offset));
+		const __m128i r1b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + offset + 16));
+
+		// Vertical sums, two texels per register
+		const __m128i a01 = _mm_add_epi16(_mm_unpacklo_epi8(r0a, zero), _mm_unpacklo_epi8(r1a, zero));
+		const __m128i a23 = _mm_add_epi16(_mm_unpackhi_epi8(r0a, zero), _mm_unpackhi_epi8(r1a, zero));
+		const __m128i b01 = _mm_add_epi16(_mm_unpacklo_epi8(r0b, zero), _mm_unpacklo_epi8(r1b, zero));
+		const __m128i b23 = _mm_add_epi16(_mm_unpackhi_epi8(r0b, zero), _mm_unpackhi_epi8(r1b, zero));
+
+		// Horizontal sums, the result texel ends up in the low 64 bits
+		const __m128i d0 = _mm_add_epi16(a01, _mm_srli_si128(a01, 8));
+		const __m128i d1 = _mm_add_epi16(a23, _mm_srli_si128(a23, 8));
+		const __m128i d2 = _mm_add_epi16(b01, _mm_srli_si128(b01, 8));
+		const __m128i d3 = _mm_add_epi16(b23, _mm_srli_si128(b23, 8));
+
+		__m128i lo = _mm_unpacklo_epi64(d0, d1);
+		__m128i hi = _mm_unpacklo_epi64(d2, d3);
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, rounding), 2);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, rounding), 2);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + static_cast<size_t>(x) * RGBA_CHANNEL_COUNT), _mm_packus_epi16(lo, hi));
+	}
+	return x;
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,51 @@
+#ifndef CESIUM_MIP_CHAIN_BUILDER_H
+#define CESIUM_MIP_CHAIN_BUILDER_H
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "core/variant/variant.h"
+#endif
+
+#include "CesiumGltf/ImageAsset.h"
+#include <cstdint>
+
+/**
+ * @brief Builds full mip chains for 8 bit RGB / RGBA images with a 2x2 box filter
+ * The chain is laid out the way Godot's Image expects it (base level first, down to 1x1, tightly packed),
+ * so the result can be uploaded as is. Linear RGBA8 goes through an SSE2 kernel when available,
+ * sRGB images are filtered in linear space through lookup tables.
+ */
+class CesiumMipChainBuilder {
+public:
+	static bool is_supported(int32_t channels, int32_t bytesPerChannel);
+
+	/// @brief Size in bytes of the base level plus every mip level
+	static size_t get_chain_size(int32_t width, int32_t height, int32_t channels);
+
+	/// @brief Fills every mip level of buffer, which must be get_chain_size bytes long and hold the base level at offset 0
+	static void build_chain(uint8_t* buffer, int32_t width, int32_t height, int32_t channels, bool isSrgb);
+
+	/// @brief Rebuilds mip levels 1 to levelCount over a region of the base level, the rest of the chain is left as is
+	/// @note The region (in base level texels) should be aligned to 2^levelCount, otherwise its footprint on deeper levels
+	/// also covers texels filtered from outside of it
+	static void build_region(uint8_t* buffer, int32_t width, int32_t height, int32_t channels, bool isSrgb, int32_t regionX, int32_t regionY, int32_t regionWidth, int32_t regionHeight, int32_t levelCount);
+
+	/// @brief Replaces the image's mips with a freshly built chain, for images coming from cesium's decoders
+	static Error generate_mipmaps(CesiumGltf::ImageAsset& image, bool isSrgb);
+
+	/// @brief Copies the base level of the image and builds its chain in one Godot buffer, ready for Image::create_from_data
+	static PackedByteArray build_image_data(const CesiumGltf::ImageAsset& image, bool isSrgb);
+
+private:
+	static void downsample_level(const uint8_t* source, int32_t sourceWidth, int32_t sourceHeight, uint8_t* destination, int32_t channels, bool isSrgb);
+
+	/// @brief Fills the destination texels [x0, x1) x [y0, y1) of the level below source
+	static void downsample_area(const uint8_t* source, int32_t sourceWidth, int32_t sourceHeight, uint8_t* destination, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t channels, bool isSrgb);
+
+	static int32_t downsample_rows_rgba8_simd(const uint8_t* row0, const uint8_t* row1, int32_t destinationWidth, uint8_t* destination);
+};
+
+#endif // !CESIUM_MIP_CHAIN_BUILDER_H
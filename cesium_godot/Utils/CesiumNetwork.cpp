@@ -0,0 +1,209 @@
+#include "CesiumNetwork.h"
+#include "CurlBandwidthGovernor.h"
+#include "CurlHandlePool.h"
+#include "CurlRetryPolicy.h"
+#include "CurlShareContext.h"
+#include "../Implementations/RequestCoalescer.h"
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/core/class_db.hpp>
+#endif
+
+void CesiumNetwork::set_http2_hosts(const PackedStringArray& hosts)
+{
+	std::vector<std::string> hostList;
+	hostList.reserve(hosts.size());
+	for (int32_t i = 0; i < hosts.size(); i++) {
+		hostList.emplace_back(hosts[i].utf8().get_data());
+	}
+	CurlShareContext::set_http2_hosts(hostList);
+}
+
+PackedStringArray CesiumNetwork::get_http2_hosts()
+{
+	PackedStringArray result;
+	for (const std::string& host : CurlShareContext::get_http2_hosts()) {
+		result.push_back(String(host.c_str()));
+	}
+	return result;
+}
+
+void CesiumNetwork::set_max_connections_per_host(int32_t count)
+{
+	CurlShareContext::set_max_connections_per_host(count);
+}
+
+int32_t CesiumNetwork::get_max_connections_per_host()
+{
+	return CurlShareContext::get_max_connections_per_host();
+}
+
+void CesiumNetwork::set_max_total_connections(int32_t count)
+{
+	CurlShareContext::set_max_total_connections(count);
+}
+
+int32_t CesiumNetwork::get_max_total_connections()
+{
+	return CurlShareContext::get_max_total_connections();
+}
+
+Dictionary CesiumNetwork::get_coalescing_statistics()
+{
+	return RequestCoalescer::get_statistics();
+}
+
+void CesiumNetwork::reset_coalescing_statistics()
+{
+	RequestCoalescer::reset_statistics();
+}
+
+void CesiumNetwork::set_max_retries(int32_t retries)
+{
+	CurlRetryPolicy::set_max_retries(retries);
+}
+
+int32_t CesiumNetwork::get_max_retries()
+{
+	return CurlRetryPolicy::get_max_retries();
+}
+
+void CesiumNetwork::set_retry_delay_ms(int32_t baseDelay, int32_t maxDelay)
+{
+	ERR_FAIL_COND_MSG(baseDelay > maxDelay, "The base retry delay can't be larger than the maximum delay");
+	CurlRetryPolicy::set_base_delay_ms(baseDelay);
+	CurlRetryPolicy::set_max_delay_ms(maxDelay);
+}
+
+int32_t CesiumNetwork::get_retry_base_delay_ms()
+{
+	return CurlRetryPolicy::get_base_delay_ms();
+}
+
+int32_t CesiumNetwork::get_retry_max_delay_ms()
+{
+	return CurlRetryPolicy::get_max_delay_ms();
+}
+
+void CesiumNetwork::set_hedging_enabled(bool enabled)
+{
+	CurlRetryPolicy::set_hedging_enabled(enabled);
+}
+
+bool CesiumNetwork::is_hedging_enabled()
+{
+	return CurlRetryPolicy::is_hedging_enabled();
+}
+
+void CesiumNetwork::set_hedge_percentile(double percentile)
+{
+	CurlRetryPolicy::set_hedge_percentile(percentile);
+}
+
+double CesiumNetwork::get_hedge_percentile()
+{
+	return CurlRetryPolicy::get_hedge_percentile();
+}
+
+void CesiumNetwork::set_request_timeout_ms(int32_t timeout)
+{
+	CurlRetryPolicy::set_request_timeout_ms(timeout);
+}
+
+int32_t CesiumNetwork::get_request_timeout_ms()
+{
+	return CurlRetryPolicy::get_request_timeout_ms();
+}
+
+void CesiumNetwork::set_connect_timeout_ms(int32_t timeout)
+{
+	CurlRetryPolicy::set_connect_timeout_ms(timeout);
+}
+
+int32_t CesiumNetwork::get_connect_timeout_ms()
+{
+	return CurlRetryPolicy::get_connect_timeout_ms();
+}
+
+void CesiumNetwork::set_global_bandwidth_limit(double bytesPerSecond, double requestsPerSecond)
+{
+	CurlBandwidthGovernor::set_global_limits(bytesPerSecond, requestsPerSecond);
+}
+
+void CesiumNetwork::set_default_host_bandwidth_limit(double bytesPerSecond, double requestsPerSecond)
+{
+	CurlBandwidthGovernor::set_default_host_limits(bytesPerSecond, requestsPerSecond);
+}
+
+void CesiumNetwork::set_host_bandwidth_limit(const String& host, double bytesPerSecond, double requestsPerSecond)
+{
+	ERR_FAIL_COND_MSG(host.is_empty(), "A host name is required, use set_default_host_bandwidth_limit to limit every host");
+	CurlBandwidthGovernor::set_host_limits(host.utf8().get_data(), bytesPerSecond, requestsPerSecond);
+}
+
+void CesiumNetwork::clear_host_bandwidth_limit(const String& host)
+{
+	CurlBandwidthGovernor::clear_host_limits(host.utf8().get_data());
+}
+
+Dictionary CesiumNetwork::get_bandwidth_statistics()
+{
+	const CurlBandwidthGovernor::Statistics_t statistics = CurlBandwidthGovernor::get_statistics();
+	Dictionary result;
+	result["admitted"] = static_cast<int64_t>(statistics.admitted);
+	result["throttled"] = static_cast<int64_t>(statistics.throttled);
+	result["dropped"] = static_cast<int64_t>(statistics.dropped);
+	result["received_bytes"] = static_cast<int64_t>(statistics.receivedBytes);
+	result["queued_high"] = static_cast<int64_t>(statistics.queued[static_cast<size_t>(CurlRequestPriority::High)]);
+	result["queued_normal"] = static_cast<int64_t>(statistics.queued[static_cast<size_t>(CurlRequestPriority::Normal)]);
+	result["queued_low"] = static_cast<int64_t>(statistics.queued[static_cast<size_t>(CurlRequestPriority::Low)]);
+	result["global_bytes_per_second"] = statistics.globalBytesPerSecond;
+	result["global_requests_per_second"] = statistics.globalRequestsPerSecond;
+	result["host_bytes_per_second"] = statistics.defaultHostBytesPerSecond;
+	result["host_requests_per_second"] = statistics.defaultHostRequestsPerSecond;
+	return result;
+}
+
+Dictionary CesiumNetwork::get_handle_pool_statistics()
+{
+	const CurlHandlePool::Occupancy_t occupancy = CurlHandlePool::get_total_occupancy();
+	Dictionary result;
+	result["capacity"] = static_cast<int64_t>(occupancy.capacity);
+	result["in_use"] = static_cast<int64_t>(occupancy.inUse);
+	result["peak_in_use"] = static_cast<int64_t>(occupancy.peakInUse);
+	result["waiting"] = static_cast<int64_t>(occupancy.waiting);
+	result["queued"] = static_cast<int64_t>(occupancy.queued);
+	result["exhausted"] = static_cast<int64_t>(occupancy.exhausted);
+	return result;
+}
+
+void CesiumNetwork::_bind_methods()
+{
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_http2_hosts", "hosts"), &CesiumNetwork::set_http2_hosts);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_http2_hosts"), &CesiumNetwork::get_http2_hosts);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_max_connections_per_host", "count"), &CesiumNetwork::set_max_connections_per_host);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_max_connections_per_host"), &CesiumNetwork::get_max_connections_per_host);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_max_total_connections", "count"), &CesiumNetwork::set_max_total_connections);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_max_total_connections"), &CesiumNetwork::get_max_total_connections);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_coalescing_statistics"), &CesiumNetwork::get_coalescing_statistics);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("reset_coalescing_statistics"), &CesiumNetwork::reset_coalescing_statistics);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_max_retries", "retries"), &CesiumNetwork::set_max_retries);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_max_retries"), &CesiumNetwork::get_max_retries);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_retry_delay_ms", "base_delay", "max_delay"), &CesiumNetwork::set_retry_delay_ms);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_retry_base_delay_ms"), &CesiumNetwork::get_retry_base_delay_ms);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_retry_max_delay_ms"), &CesiumNetwork::get_retry_max_delay_ms);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_hedging_enabled", "enabled"), &CesiumNetwork::set_hedging_enabled);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("is_hedging_enabled"), &CesiumNetwork::is_hedging_enabled);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_hedge_percentile", "percentile"), &CesiumNetwork::set_hedge_percentile);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_hedge_percentile"), &CesiumNetwork::get_hedge_percentile);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_request_timeout_ms", "timeout"), &CesiumNetwork::set_request_timeout_ms);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_request_timeout_ms"), &CesiumNetwork::get_request_timeout_ms);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_connect_timeout_ms", "timeout"), &CesiumNetwork::set_connect_timeout_ms);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_connect_timeout_ms"), &CesiumNetwork::get_connect_timeout_ms);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_global_bandwidth_limit", "bytes_per_second", "requests_per_second"), &CesiumNetwork::set_global_bandwidth_limit);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_default_host_bandwidth_limit", "bytes_per_second", "requests_per_second"), &CesiumNetwork::set_default_host_bandwidth_limit);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("set_host_bandwidth_limit", "host", "bytes_per_second", "requests_per_second"), &CesiumNetwork::set_host_bandwidth_limit);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("clear_host_bandwidth_limit", "host"), &CesiumNetwork::clear_host_bandwidth_limit);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_bandwidth_statistics"), &CesiumNetwork::get_bandwidth_statistics);
+	ClassDB::bind_static_method("CesiumNetwork", D_METHOD("get_handle_pool_statistics"), &CesiumNetwork::get_handle_pool_statistics);
+}
@@ -0,0 +1,86 @@
+#ifndef CESIUM_NETWORK_H
+#define CESIUM_NETWORK_H
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/classes/object.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_string_array.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "core/object/object.h"
+#endif
+
+/// @brief Runtime settings of the plugin's HTTP stack, shared by every tileset, overlay and editor request
+class CesiumNetwork : public Object {
+	GDCLASS(CesiumNetwork, Object)
+
+public:
+	static void set_http2_hosts(const PackedStringArray& hosts);
+
+	static PackedStringArray get_http2_hosts();
+
+	/// @brief Connection limits of each HTTP client (every tileset's accessor and the editor helpers have their own), 0 removes them
+	static void set_max_connections_per_host(int32_t count);
+
+	static int32_t get_max_connections_per_host();
+
+	static void set_max_total_connections(int32_t count);
+
+	static int32_t get_max_total_connections();
+
+	/// @brief How many GET requests piggybacked on an identical transfer already in flight
+	static Dictionary get_coalescing_statistics();
+
+	static void reset_coalescing_statistics();
+
+	/// @brief Retries of a transfer that failed with a 5xx, 429, timeout or dropped connection
+	static void set_max_retries(int32_t retries);
+
+	static int32_t get_max_retries();
+
+	/// @brief Exponential backoff bounds, each retry waits a random time up to min(base * 2^n, max)
+	static void set_retry_delay_ms(int32_t baseDelay, int32_t maxDelay);
+
+	static int32_t get_retry_base_delay_ms();
+
+	static int32_t get_retry_max_delay_ms();
+
+	/// @brief Sends a duplicate GET once a request runs longer than the given latency percentile, the first response wins
+	static void set_hedging_enabled(bool enabled);
+
+	static bool is_hedging_enabled();
+
+	static void set_hedge_percentile(double percentile);
+
+	static double get_hedge_percentile();
+
+	/// @brief 0 waits forever
+	static void set_request_timeout_ms(int32_t timeout);
+
+	static int32_t get_request_timeout_ms();
+
+	static void set_connect_timeout_ms(int32_t timeout);
+
+	static int32_t get_connect_timeout_ms();
+
+	/// @brief Caps every transfer of the plugin combined, 0 removes a limit
+	static void set_global_bandwidth_limit(double bytesPerSecond, double requestsPerSecond);
+
+	/// @brief Caps applied to each host that has no limits of its own, 0 removes a limit
+	static void set_default_host_bandwidth_limit(double bytesPerSecond, double requestsPerSecond);
+
+	static void set_host_bandwidth_limit(const String& host, double bytesPerSecond, double requestsPerSecond);
+
+	static void clear_host_bandwidth_limit(const String& host);
+
+	/// @brief Admitted / throttled transfers, queue lengths per priority class and the active limits
+	static Dictionary get_bandwidth_statistics();
+
+	/// @brief Easy handles in use / available across every client and attempts waiting for one
+	static Dictionary get_handle_pool_statistics();
+
+protected:
+	static void _bind_methods();
+};
+
+#endif // !CESIUM_NETWORK_H
@@ -0,0 +1,263 @@
+#include "CesiumOverlayAtlas.h"
+#include "CesiumMipChainBuilder.h"
+
+#if defined(CESIUM_GD_EXT)
+#include "godot_cpp/core/error_macros.hpp"
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+constexpr int32_t ATLAS_CHANNEL_COUNT = 4;
+
+static int32_t next_power_of_two(int32_t value) {
+	int32_t result = 1;
+	while (result < value) {
+		result <<= 1;
+	}
+	return result;
+}
+
+CesiumOverlayAtlas::CesiumOverlayAtlas(int32_t pageSize, int32_t border, int32_t pageUploadsPerFrame) :
+		m_pageSize(pageSize),
+		m_border(next_power_of_two(std::max(1, border))),
+		m_maxMipLevel(get_max_mip_level(this->m_border)),
+		m_pageUploadsPerFrame(std::max(1, pageUploadsPerFrame)) {
+}
+
+bool CesiumOverlayAtlas::is_packable(const CesiumGltf::ImageAsset& image, int32_t pageSize, int32_t border)
+{
+	// Only plain RGBA8 tiles can share a page, everything else keeps its own texture
+	const bool isPlainRgba8 = image.channels == ATLAS_CHANNEL_COUNT &&
+			image.bytesPerChannel == 1 &&
+			image.compressedPixelFormat == CesiumGltf::GpuCompressedPixelFormat::NONE &&
+			image.width > 0 && image.height > 0;
+	if (!isPlainRgba8) return false;
+
+	// Tiles that would fill most of a page are not worth packing
+	return get_cell_size(image, next_power_of_two(std::max(1, border))) * 2 <= pageSize;
+}
+
+std::unique_ptr<OverlayAtlasCell_t> CesiumOverlayAtlas::prepare_cell(const CesiumGltf::ImageAsset& image, int32_t pageSize, int32_t border)
+{
+	if (!is_packable(image, pageSize, border)) return nullptr;
+	border = next_power_of_two(std::max(1, border));
+
+	auto preparedCell = std::make_unique<OverlayAtlasCell_t>();
+	const int32_t cellSize = get_cell_size(image, border);
+	preparedCell->cellSize = cellSize;
+	preparedCell->mipLevels = get_max_mip_level(border);
+	// Sized for the whole chain so build_region finds its levels, only the sampled ones are filled
+	preparedCell->pixels.resize(CesiumMipChainBuilder::get_chain_size(cellSize, cellSize, ATLAS_CHANNEL_COUNT));
+
+	const size_t cellStride = static_cast<size_t>(cellSize) * ATLAS_CHANNEL_COUNT;
+	const size_t imageStride = static_cast<size_t>(image.width) * ATLAS_CHANNEL_COUNT;
+	const uint8_t* imagePixels = reinterpret_cast<const uint8_t*>(image.pixelData.data());
+
+	// The tile starts border texels in, every texel around it up to the cell bounds replicates the closest edge texel
+	for (int32_t y = 0; y < cellSize; y++) {
+		const int32_t sourceRow = std::clamp(y - border, 0, image.height - 1);
+		const uint8_t* source = imagePixels + sourceRow * imageStride;
+		uint8_t* destination = preparedCell->pixels.data() + y * cellStride;
+
+		for (int32_t x = 0; x < border; x++) {
+			memcpy(destination + x * ATLAS_CHANNEL_COUNT, source, ATLAS_CHANNEL_COUNT);
+		}
+		memcpy(destination + border * ATLAS_CHANNEL_COUNT, source, imageStride);
+		for (int32_t x = border + image.width; x < cellSize; x++) {
+			memcpy(destination + x * ATLAS_CHANNEL_COUNT, source + imageStride - ATLAS_CHANNEL_COUNT, ATLAS_CHANNEL_COUNT);
+		}
+	}
+
+	// Overlay imagery is sRGB, filter it in linear space. The cell size is a multiple of 2^mipLevels,
+	// so these levels match what filtering the cell in place in the page would give
+	CesiumMipChainBuilder::build_region(preparedCell->pixels.data(), cellSize, cellSize, ATLAS_CHANNEL_COUNT, true, 0, 0, cellSize, cellSize, preparedCell->mipLevels);
+	return preparedCell;
+}
+
+bool CesiumOverlayAtlas::allocate(const CesiumGltf::ImageAsset& image, const OverlayAtlasCell_t* preparedCell, OverlayTextureResource_t* outResource)
+{
+	if (!is_packable(image, this->m_pageSize, this->m_border)) return false;
+
+	const int32_t cellSize = get_cell_size(image, this->m_border);
+
+	// Not prepared on the load thread, or for another layout
+	std::unique_ptr<OverlayAtlasCell_t> fallbackCell;
+	if (preparedCell == nullptr || preparedCell->cellSize != cellSize || preparedCell->mipLevels != this->m_maxMipLevel) {
+		fallbackCell = prepare_cell(image, this->m_pageSize, this->m_border);
+		preparedCell = fallbackCell.get();
+	}
+
+	const int32_t pageIndex = this->find_or_create_page(cellSize);
+	Page_t& page = this->m_pages[pageIndex];
+
+	const int32_t cell = page.freeCells.back();
+	page.freeCells.pop_back();
+	page.usedCells++;
+	page.usedArea[cell] = static_cast<int64_t>(image.width) * image.height;
+	this->write_cell(page, cell, *preparedCell);
+
+	const real_t pageSize = static_cast<real_t>(this->m_pageSize);
+	const int32_t originX = (cell % page.cellsPerRow) * cellSize + this->m_border;
+	const int32_t originY = (cell / page.cellsPerRow) * cellSize + this->m_border;
+
+	outResource->texture = page.texture;
+	outResource->uvRect = Rect2(originX / pageSize, originY / pageSize, image.width / pageSize, image.height / pageSize);
+	outResource->atlasHandle = OverlayAtlasHandle_t{ pageIndex, cell };
+	outResource->maxLod = static_cast<real_t>(this->m_maxMipLevel);
+	return true;
+}
+
+void CesiumOverlayAtlas::release(const OverlayAtlasHandle_t& handle)
+{
+	if (!handle.is_valid() || handle.page >= static_cast<int32_t>(this->m_pages.size())) return;
+	Page_t& page = this->m_pages[handle.page];
+	ERR_FAIL_COND_MSG(page.usedArea[handle.cell] == 0, "Overlay atlas cell was released twice");
+
+	page.usedArea[handle.cell] = 0;
+	page.freeCells.push_back(handle.cell);
+	page.usedCells--;
+
+	// Give the memory back once the page is empty, the slot is reused by the next page we need
+	if (page.usedCells == 0) {
+		page = Page_t{};
+	}
+}
+
+void CesiumOverlayAtlas::flush()
+{
+	// Pages created since the last flush were already uploaded once
+	int32_t uploadBudget = this->m_pageUploadsPerFrame - this->m_pageUploadsThisFrame;
+	this->m_pageUploadsThisFrame = 0;
+
+	const int32_t pageCount = static_cast<int32_t>(this->m_pages.size());
+	for (int32_t i = 0; i < pageCount && uploadBudget > 0; i++) {
+		const int32_t pageIndex = (this->m_nextFlushPage + i) % pageCount;
+		Page_t& page = this->m_pages[pageIndex];
+		if (!page.dirty || page.texture.is_null()) continue;
+
+		page.dirty = false;
+		Ref<Image> pageImage = Image::create_from_data(this->m_pageSize, this->m_pageSize, true, Image::FORMAT_RGBA8, page.pixels);
+		page.texture->update(pageImage);
+		uploadBudget--;
+		this->m_nextFlushPage = (pageIndex + 1) % pageCount;
+	}
+}
+
+Dictionary CesiumOverlayAtlas::get_statistics() const
+{
+	int32_t pageCount = 0;
+	int64_t allocatedTiles = 0;
+	int64_t tileCapacity = 0;
+	int64_t usedTexels = 0;
+	int32_t pendingUploads = 0;
+
+	for (const Page_t& page : this->m_pages) {
+		if (page.texture.is_null()) continue;
+		pageCount++;
+		pendingUploads += page.dirty ? 1 : 0;
+		allocatedTiles += page.usedCells;
+		tileCapacity += page.cellsPerRow * page.cellsPerRow;
+		for (int64_t area : page.usedArea) {
+			usedTexels += area;
+		}
+	}
+
+	const int64_t totalTexels = static_cast<int64_t>(pageCount) * this->m_pageSize * this->m_pageSize;
+
+	Dictionary stats;
+	stats["page_count"] = pageCount;
+	stats["page_size"] = this->m_pageSize;
+	stats["allocated_tiles"] = allocatedTiles;
+	stats["tile_capacity"] = tileCapacity;
+	stats["memory_bytes"] = totalTexels * ATLAS_CHANNEL_COUNT;
+	// Share of the page texels that hold actual tile data
+	stats["occupancy"] = totalTexels == 0 ? 0.0 : static_cast<double>(usedTexels) / totalTexels;
+	// Share of the cells in live pages that are free, high values mean many half empty pages
+	stats["fragmentation"] = tileCapacity == 0 ? 0.0 : static_cast<double>(tileCapacity - allocatedTiles) / tileCapacity;
+	// Pages waiting for a frame with upload budget left
+	stats["pending_uploads"] = pendingUploads;
+	return stats;
+}
+
+int32_t CesiumOverlayAtlas::get_cell_size(const CesiumGltf::ImageAsset& image, int32_t border)
+{
+	// A size class below the border would break the alignment of the cells on the sampled mip levels
+	const int32_t sizeClass = std::max(next_power_of_two(std::max(image.width, image.height)), border);
+	return sizeClass + border * 2;
+}
+
+int32_t CesiumOverlayAtlas::get_max_mip_level(int32_t border)
+{
+	int32_t level = 0;
+	while ((1 << (level + 1)) <= border) {
+		level++;
+	}
+	return level;
+}
+
+int32_t CesiumOverlayAtlas::find_or_create_page(int32_t cellSize)
+{
+	int32_t emptySlot = -1;
+	for (int32_t i = 0; i < static_cast<int32_t>(this->m_pages.size()); i++) {
+		const Page_t& page = this->m_pages[i];
+		if (page.texture.is_null()) {
+			emptySlot = emptySlot < 0 ? i : emptySlot;
+			continue;
+		}
+		if (page.cellSize == cellSize && !page.freeCells.empty()) {
+			return i;
+		}
+	}
+
+	Page_t page;
+	page.cellSize = cellSize;
+	page.cellsPerRow = this->m_pageSize / cellSize;
+	const int32_t cellCount = page.cellsPerRow * page.cellsPerRow;
+	page.usedArea.resize(cellCount, 0);
+	page.freeCells.reserve(cellCount);
+	// Reversed so cells are handed out from the top left corner
+	for (int32_t cell = cellCount - 1; cell >= 0; cell--) {
+		page.freeCells.push_back(cell);
+	}
+
+	page.pixels.resize(CesiumMipChainBuilder::get_chain_size(this->m_pageSize, this->m_pageSize, ATLAS_CHANNEL_COUNT));
+	page.pixels.fill(0);
+	Ref<Image> pageImage = Image::create_from_data(this->m_pageSize, this->m_pageSize, true, Image::FORMAT_RGBA8, page.pixels);
+	page.texture = ImageTexture::create_from_image(pageImage);
+	this->m_pageUploadsThisFrame++;
+
+	if (emptySlot >= 0) {
+		this->m_pages[emptySlot] = std::move(page);
+		return emptySlot;
+	}
+	this->m_pages.emplace_back(std::move(page));
+	return static_cast<int32_t>(this->m_pages.size()) - 1;
+}
+
+void CesiumOverlayAtlas::write_cell(Page_t& page, int32_t cell, const OverlayAtlasCell_t& preparedCell)
+{
+	const int32_t cellX = (cell % page.cellsPerRow) * page.cellSize;
+	const int32_t cellY = (cell / page.cellsPerRow) * page.cellSize;
+
+	uint8_t* pageLevel = page.pixels.ptrw();
+	const uint8_t* cellLevel = preparedCell.pixels.data();
+	int32_t pageLevelSize = this->m_pageSize;
+	int32_t cellLevelSize = preparedCell.cellSize;
+
+	// Only the cell's footprint is touched on each level, the mips come filtered from prepare_cell
+	for (int32_t level = 0; level <= preparedCell.mipLevels; level++) {
+		const size_t pageStride = static_cast<size_t>(pageLevelSize) * ATLAS_CHANNEL_COUNT;
+		const size_t cellStride = static_cast<size_t>(cellLevelSize) * ATLAS_CHANNEL_COUNT;
+		uint8_t* destination = pageLevel + (cellY >> level) * pageStride + (cellX >> level) * ATLAS_CHANNEL_COUNT;
+		for (int32_t y = 0; y < cellLevelSize; y++) {
+			memcpy(destination + y * pageStride, cellLevel + y * cellStride, cellStride);
+		}
+
+		pageLevel += pageStride * pageLevelSize;
+		cellLevel += cellStride * cellLevelSize;
+		pageLevelSize = std::max(1, pageLevelSize >> 1);
+		cellLevelSize = std::max(1, cellLevelSize >> 1);
+	}
+	page.dirty = true;
+}
@@ -0,0 +1,122 @@
+#ifndef CESIUM_OVERLAY_ATLAS_H
+#define CESIUM_OVERLAY_ATLAS_H
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/image_texture.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/rect2.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "scene/resources/image_texture.h"
+#endif
+
+#include "CesiumGltf/ImageAsset.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct OverlayAtlasHandle_t {
+	int32_t page = -1;
+	int32_t cell = -1;
+
+	bool is_valid() const {
+		return this->page >= 0 && this->cell >= 0;
+	}
+};
+
+/// @brief A tile laid out as a whole atlas cell (edges replicated up to the cell bounds) followed by its sampled mip levels
+struct OverlayAtlasCell_t {
+	int32_t cellSize = 0;
+	/// @brief Mip levels stored after the base level
+	int32_t mipLevels = 0;
+	std::vector<uint8_t> pixels;
+};
+
+/// @brief What prepareRasterInMainThread hands to cesium for every raster overlay tile
+struct OverlayTextureResource_t {
+	Ref<Texture2D> texture;
+	/// @brief Normalized region of the texture that holds this raster tile
+	Rect2 uvRect = Rect2(0, 0, 1, 1);
+	OverlayAtlasHandle_t atlasHandle;
+	/// @brief Deepest mip level the tile may be sampled from, negative for no limit
+	real_t maxLod = -1.0;
+};
+
+/**
+ * @brief Packs raster overlay tiles into large shared texture pages
+ * Each page is split in equally sized cells (one size class per page), every cell holds a tile
+ * plus a border that replicates its edges, so mipmapped sampling does not bleed between neighbours.
+ * The border is a power of two and cells start on multiples of it, down to mip level log2(border) every cell covers
+ * whole texels and keeps at least one texel of border. Tiles are only sampled down to that level (see maxLod), so a cell's
+ * mips only depend on its own texels: they are filtered by prepare_cell on the load threads and copied level by level into the page.
+ * @note Not thread safe (except for the static functions), meant to be used from the thread that drives Tileset::updateView
+ */
+class CesiumOverlayAtlas {
+public:
+	static constexpr int32_t DEFAULT_PAGE_SIZE = 2048;
+	static constexpr int32_t DEFAULT_BORDER = 4;
+	/// @brief A 2048 page with its chain is ~22 MB, uploading one per frame bounds what a single frame pays for new tiles
+	static constexpr int32_t DEFAULT_PAGE_UPLOADS_PER_FRAME = 1;
+
+	explicit CesiumOverlayAtlas(int32_t pageSize = DEFAULT_PAGE_SIZE, int32_t border = DEFAULT_BORDER, int32_t pageUploadsPerFrame = DEFAULT_PAGE_UPLOADS_PER_FRAME);
+
+	/// @brief Whether allocate would accept the image, safe to call from any thread
+	static bool is_packable(const CesiumGltf::ImageAsset& image, int32_t pageSize = DEFAULT_PAGE_SIZE, int32_t border = DEFAULT_BORDER);
+
+	/// @brief Builds the bordered cell and its sampled mips for the image, nullptr if it is not packable. Safe to call from any thread
+	static std::unique_ptr<OverlayAtlasCell_t> prepare_cell(const CesiumGltf::ImageAsset& image, int32_t pageSize = DEFAULT_PAGE_SIZE, int32_t border = DEFAULT_BORDER);
+
+	/// @brief Copies the prepared cell into a free cell of a page, returns false if the image cannot be packed (format or size)
+	/// @param preparedCell Result of prepare_cell for this image, built here when null
+	bool allocate(const CesiumGltf::ImageAsset& image, const OverlayAtlasCell_t* preparedCell, OverlayTextureResource_t* outResource);
+
+	void release(const OverlayAtlasHandle_t& handle);
+
+	/// @brief Uploads the pages written since their last upload, call once per frame
+	/// @note Godot has no sub-region texture upload, so a dirty page is uploaded whole, at most once per frame and within the
+	/// per frame page budget. Pages over the budget stay dirty and go first on the next frame; until then their new cells show
+	/// whatever the texture held there before
+	void flush();
+
+	/// @brief Occupancy and fragmentation figures, exposed to GDScript through the tileset
+	Dictionary get_statistics() const;
+
+private:
+	struct Page_t {
+		/// @brief Base level followed by its mip chain
+		PackedByteArray pixels;
+		Ref<ImageTexture> texture;
+		int32_t cellSize = 0;
+		int32_t cellsPerRow = 0;
+		std::vector<int32_t> freeCells;
+		/// @brief Texel area of the tile stored in each cell, 0 when the cell is free
+		std::vector<int64_t> usedArea;
+		int32_t usedCells = 0;
+		/// @brief Cells were written since the last upload
+		bool dirty = false;
+	};
+
+	/// @brief Size class of the image plus the border on both sides, a multiple of the border
+	static int32_t get_cell_size(const CesiumGltf::ImageAsset& image, int32_t border);
+
+	/// @brief log2 of the border, the deepest level that never samples a neighbouring cell
+	static int32_t get_max_mip_level(int32_t border);
+
+	int32_t find_or_create_page(int32_t cellSize);
+
+	void write_cell(Page_t& page, int32_t cell, const OverlayAtlasCell_t& preparedCell);
+
+	std::vector<Page_t> m_pages;
+	int32_t m_pageSize;
+	int32_t m_border;
+	int32_t m_maxMipLevel;
+	int32_t m_pageUploadsPerFrame;
+	/// @brief Pages uploaded since the last flush, creating a page uploads it too
+	int32_t m_pageUploadsThisFrame = 0;
+	/// @brief Where the next flush starts looking for dirty pages, so a busy page does not starve the others
+	int32_t m_nextFlushPage = 0;
+};
+
+#endif // !CESIUM_OVERLAY_ATLAS_H
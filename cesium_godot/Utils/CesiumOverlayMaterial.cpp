@@ -0,0 +1,215 @@
+#include "CesiumOverlayMaterial.h"
+
+#if defined(CESIUM_GD_EXT)
+#include "godot_cpp/variant/array.hpp"
+#include "godot_cpp/variant/packed_float32_array.hpp"
+#include "godot_cpp/variant/packed_int32_array.hpp"
+#include "godot_cpp/core/error_macros.hpp"
+#endif
+
+constexpr const char* COMPOSITE_SHADER_HEADER = R"(
+shader_type spatial;
+render_mode $RENDER_MODE;
+
+uniform vec4 albedo : source_color = vec4(1.0);
+uniform sampler2D base_texture : source_color, filter_linear_mipmap, repeat_disable;
+uniform bool has_base_texture = false;
+uniform float roughness = 1.0;
+uniform float specular = 0.5;
+uniform float metallic = 0.0;
+uniform float alpha_scissor_threshold = 0.5;
+uniform float alpha_antialiasing_edge = 0.3;
+
+uniform int layer_count = 0;
+uniform sampler2D overlay_textures[$LAYER_COUNT] : source_color, filter_linear_mipmap, repeat_disable;
+// xy = scale, zw = translation, as given by cesium for the raster tile
+uniform vec4 overlay_transforms[$LAYER_COUNT];
+// xy = origin, zw = size of the tile inside its (possibly shared) texture
+uniform vec4 overlay_rects[$LAYER_COUNT];
+uniform float overlay_alphas[$LAYER_COUNT];
+uniform int overlay_uv_channels[$LAYER_COUNT];
+// Deepest mip level each layer may sample, negative for no limit
+uniform float overlay_max_lods[$LAYER_COUNT];
+
+vec4 sample_layer(sampler2D layerTexture, vec4 layerTransform, vec4 layerRect, int uvChannel, float maxLod, vec2 uv0, vec2 uv1) {
+	vec2 uv = uvChannel == 0 ? uv0 : uv1;
+	uv = vec2(uv.x * layerTransform.x + layerTransform.z, 1.0 - (uv.y * layerTransform.y + layerTransform.w));
+	// Level of detail from the unclamped coordinates, the clamp below would flatten the derivatives at the tile's edges
+	vec2 texelUv = (layerRect.xy + uv * layerRect.zw) * vec2(textureSize(layerTexture, 0));
+	vec2 texelDx = dFdx(texelUv);
+	vec2 texelDy = dFdy(texelUv);
+	float lod = max(0.5 * log2(max(dot(texelDx, texelDx), dot(texelDy, texelDy))), 0.0);
+	// Past maxLod an atlas cell's border is gone and filtering would pull in its neighbours
+	lod = maxLod < 0.0 ? lod : min(lod, maxLod);
+	// Clamp before remapping so atlas tiles never read their neighbours
+	uv = layerRect.xy + clamp(uv, vec2(0.0), vec2(1.0)) * layerRect.zw;
+	return textureLod(layerTexture, uv, lod);
+}
+
+void fragment() {
+	vec4 color = albedo;
+	if (has_base_texture) {
+		color *= texture(base_texture, UV);
+	}
+)";
+
+constexpr const char* COMPOSITE_SHADER_LAYER = R"(
+	if (layer_count > $LAYER) {
+		vec4 layer = sample_layer(overlay_textures[$LAYER], overlay_transforms[$LAYER], overlay_rects[$LAYER], overlay_uv_channels[$LAYER], overlay_max_lods[$LAYER], UV, UV2);
+		color.rgb = mix(color.rgb, layer.rgb, layer.a * overlay_alphas[$LAYER]);
+	}
+)";
+
+constexpr const char* COMPOSITE_SHADER_FOOTER = R"(
+	ALBEDO = color.rgb;
+	ROUGHNESS = roughness;
+	SPECULAR = specular;
+	METALLIC = metallic;
+)";
+
+// Overlays only tint the surface, its coverage comes from the glTF material alone
+constexpr const char* COMPOSITE_SHADER_ALPHA = R"(
+	ALPHA = color.a;
+)";
+
+constexpr const char* COMPOSITE_SHADER_ALPHA_SCISSOR = R"(
+	ALPHA_SCISSOR_THRESHOLD = alpha_scissor_threshold;
+)";
+
+constexpr const char* COMPOSITE_SHADER_ALPHA_TO_COVERAGE = R"(
+	ALPHA_ANTIALIASING_EDGE = alpha_antialiasing_edge;
+	ALPHA_TEXTURE_COORDINATE = has_base_texture ? UV * vec2(textureSize(base_texture, 0)) : UV;
+)";
+
+Ref<ShaderMaterial> CesiumOverlayMaterial::create_composite_material(const Ref<StandardMaterial3D>& baseMaterial)
+{
+	Ref<ShaderMaterial> material = memnew(ShaderMaterial);
+	material->set_shader(get_composite_shader(get_shader_variant(baseMaterial)));
+
+	if (baseMaterial.is_null()) {
+		return material;
+	}
+
+	Ref<Texture2D> baseTexture = baseMaterial->get_texture(BaseMaterial3D::TEXTURE_ALBEDO);
+	material->set_shader_parameter("albedo", baseMaterial->get_albedo());
+	material->set_shader_parameter("has_base_texture", baseTexture.is_valid());
+	if (baseTexture.is_valid()) {
+		material->set_shader_parameter("base_texture", baseTexture);
+	}
+	material->set_shader_parameter("roughness", baseMaterial->get_roughness());
+	material->set_shader_parameter("specular", baseMaterial->get_specular());
+	material->set_shader_parameter("metallic", baseMaterial->get_metallic());
+	material->set_shader_parameter("alpha_scissor_threshold", baseMaterial->get_alpha_scissor_threshold());
+	material->set_shader_parameter("alpha_antialiasing_edge", baseMaterial->get_alpha_antialiasing_edge());
+	return material;
+}
+
+void CesiumOverlayMaterial::apply_layers(const Ref<ShaderMaterial>& material, const OverlayLayerArray_t& layers)
+{
+	ERR_FAIL_COND_MSG(material.is_null(), "Cannot apply overlay layers to a null material");
+
+	// Pack the active layers so the shader only has to walk the first layer_count entries
+	Array textures;
+	// Flattened vec4 arrays, 4 floats per layer
+	PackedFloat32Array transforms;
+	PackedFloat32Array rects;
+	PackedFloat32Array alphas;
+	PackedInt32Array uvChannels;
+	PackedFloat32Array maxLods;
+
+	for (const OverlayLayer_t& layer : layers) {
+		if (!layer.active || layer.texture.is_null()) continue;
+		textures.push_back(layer.texture);
+		transforms.push_back(layer.scale.x);
+		transforms.push_back(layer.scale.y);
+		transforms.push_back(layer.translation.x);
+		transforms.push_back(layer.translation.y);
+		rects.push_back(layer.uvRect.position.x);
+		rects.push_back(layer.uvRect.position.y);
+		rects.push_back(layer.uvRect.size.x);
+		rects.push_back(layer.uvRect.size.y);
+		alphas.push_back(layer.alpha);
+		uvChannels.push_back(layer.uvChannel);
+		maxLods.push_back(layer.maxLod);
+	}
+
+	material->set_shader_parameter("layer_count", textures.size());
+	material->set_shader_parameter("overlay_textures", textures);
+	material->set_shader_parameter("overlay_transforms", transforms);
+	material->set_shader_parameter("overlay_rects", rects);
+	material->set_shader_parameter("overlay_alphas", alphas);
+	material->set_shader_parameter("overlay_uv_channels", uvChannels);
+	material->set_shader_parameter("overlay_max_lods", maxLods);
+}
+
+void CesiumOverlayMaterial::release()
+{
+	s_compositeShaders.clear();
+}
+
+uint32_t CesiumOverlayMaterial::get_shader_variant(const Ref<StandardMaterial3D>& baseMaterial)
+{
+	if (baseMaterial.is_null()) return 0;
+	uint32_t variant = 0;
+	if (baseMaterial->get_cull_mode() == BaseMaterial3D::CULL_DISABLED) {
+		variant |= DOUBLE_SIDED;
+	}
+	// Primitives without normals can't be lit
+	if (baseMaterial->get_shading_mode() == BaseMaterial3D::SHADING_MODE_UNSHADED) {
+		variant |= UNSHADED;
+	}
+	switch (baseMaterial->get_transparency()) {
+		case BaseMaterial3D::TRANSPARENCY_DISABLED:
+			break;
+		case BaseMaterial3D::TRANSPARENCY_ALPHA_SCISSOR:
+			variant |= ALPHA_SCISSOR;
+			// Like StandardMaterial3D, alpha to coverage only smooths the edges of a cut out surface
+			if (baseMaterial->get_alpha_antialiasing() != BaseMaterial3D::ALPHA_ANTIALIASING_OFF) {
+				variant |= ALPHA_TO_COVERAGE;
+			}
+			break;
+		default:
+			variant |= ALPHA_BLEND;
+			break;
+	}
+	return variant;
+}
+
+Ref<Shader> CesiumOverlayMaterial::get_composite_shader(uint32_t variant)
+{
+	Ref<Shader>& cachedShader = s_compositeShaders[variant];
+	if (cachedShader.is_valid()) {
+		return cachedShader;
+	}
+
+	String renderMode = (variant & DOUBLE_SIDED) ? "cull_disabled" : "cull_front";
+	if (variant & UNSHADED) {
+		renderMode += ", unshaded";
+	}
+	if (variant & ALPHA_TO_COVERAGE) {
+		renderMode += ", alpha_to_coverage";
+	}
+
+	// Sampler arrays can only be indexed with constants on every backend, so we unroll the layers here
+	String code = String(COMPOSITE_SHADER_HEADER)
+		.replace("$RENDER_MODE", renderMode)
+		.replace("$LAYER_COUNT", itos(MAX_OVERLAY_LAYERS));
+	for (int32_t i = 0; i < MAX_OVERLAY_LAYERS; i++) {
+		code += String(COMPOSITE_SHADER_LAYER).replace("$LAYER", itos(i));
+	}
+	code += COMPOSITE_SHADER_FOOTER;
+	if (variant & (ALPHA_BLEND | ALPHA_SCISSOR)) {
+		code += COMPOSITE_SHADER_ALPHA;
+	}
+	if (variant & ALPHA_SCISSOR) {
+		code += COMPOSITE_SHADER_ALPHA_SCISSOR;
+	}
+	if (variant & ALPHA_TO_COVERAGE) {
+		code += COMPOSITE_SHADER_ALPHA_TO_COVERAGE;
+	}
+	code += "}\n";
+
+	cachedShader = memnew(Shader);
+	cachedShader->set_code(code);
+	return cachedShader;
+}
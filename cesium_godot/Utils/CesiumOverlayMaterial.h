@@ -0,0 +1,74 @@
+#ifndef CESIUM_OVERLAY_MATERIAL_H
+#define CESIUM_OVERLAY_MATERIAL_H
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/classes/shader.hpp>
+#include <godot_cpp/classes/shader_material.hpp>
+#include <godot_cpp/classes/standard_material3d.hpp>
+#include <godot_cpp/classes/texture2d.hpp>
+#include <godot_cpp/variant/rect2.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "scene/resources/material.h"
+#include "scene/resources/shader.h"
+#endif
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+/// @brief Maximum amount of raster overlays that can be composited on a single tile surface
+constexpr int32_t MAX_OVERLAY_LAYERS = 8;
+
+/// @brief Passed to cesium through RasterOverlayOptions::rendererOptions so the renderer knows where to place each overlay
+struct OverlayLayerOptions_t {
+	int32_t layerIndex = 0;
+	real_t alpha = 1.0;
+};
+
+/// @brief State of a single overlay layer bound to a tile
+struct OverlayLayer_t {
+	Ref<Texture2D> texture;
+	Vector2 translation;
+	Vector2 scale = Vector2(1, 1);
+	/// @brief Region of the texture holding this tile, only smaller than the whole texture for atlas pages
+	Rect2 uvRect = Rect2(0, 0, 1, 1);
+	/// @brief Deepest mip level to sample, negative for no limit. Atlas tiles stop where their border runs out
+	real_t maxLod = -1.0;
+	real_t alpha = 1.0;
+	int32_t uvChannel = 0;
+	bool active = false;
+};
+
+using OverlayLayerArray_t = std::array<OverlayLayer_t, MAX_OVERLAY_LAYERS>;
+
+/// @brief Builds the materials that composite every raster overlay of a tile in a single pass
+/// The composite shader mirrors what the glTF material needs from its StandardMaterial3D (culling, transparency, alpha to coverage,
+/// unshaded primitives without normals), one shader is compiled per combination in use
+class CesiumOverlayMaterial {
+public:
+	static Ref<ShaderMaterial> create_composite_material(const Ref<StandardMaterial3D>& baseMaterial);
+
+	static void apply_layers(const Ref<ShaderMaterial>& material, const OverlayLayerArray_t& layers);
+
+	/// @brief Frees the cached shaders, call before the rendering server goes away
+	static void release();
+
+private:
+	enum ShaderVariant : uint32_t {
+		DOUBLE_SIDED = 1 << 0,
+		UNSHADED = 1 << 1,
+		ALPHA_BLEND = 1 << 2,
+		ALPHA_SCISSOR = 1 << 3,
+		ALPHA_TO_COVERAGE = 1 << 4,
+	};
+
+	static uint32_t get_shader_variant(const Ref<StandardMaterial3D>& baseMaterial);
+
+	static Ref<Shader> get_composite_shader(uint32_t variant);
+
+	/// @brief Keyed by ShaderVariant flags
+	static inline std::unordered_map<uint32_t, Ref<Shader>> s_compositeShaders;
+};
+
+#endif // !CESIUM_OVERLAY_MATERIAL_H
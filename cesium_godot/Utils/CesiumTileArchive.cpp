@@ -0,0 +1,274 @@
+#include "CesiumTileArchive.h"
+
+#include <zlib.h>
+#include <zstd.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+constexpr uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+constexpr uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+constexpr uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+constexpr uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06064b50;
+constexpr uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+constexpr uint16_t ZIP64_EXTRA_FIELD_ID = 0x0001;
+
+constexpr size_t LOCAL_HEADER_SIZE = 30;
+constexpr size_t CENTRAL_HEADER_SIZE = 46;
+constexpr size_t END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+constexpr size_t ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE = 56;
+constexpr size_t ZIP64_LOCATOR_SIZE = 20;
+constexpr size_t MAX_COMMENT_SIZE = 0xFFFF;
+
+namespace {
+	// Zip is little endian, read byte by byte so unaligned offsets and big endian hosts are fine
+	uint16_t read_u16(const std::byte* data)
+	{
+		return static_cast<uint16_t>(std::to_integer<uint16_t>(data[0]) | (std::to_integer<uint16_t>(data[1]) << 8));
+	}
+
+	uint32_t read_u32(const std::byte* data)
+	{
+		return static_cast<uint32_t>(read_u16(data)) | (static_cast<uint32_t>(read_u16(data + 2)) << 16);
+	}
+
+	uint64_t read_u64(const std::byte* data)
+	{
+		return static_cast<uint64_t>(read_u32(data)) | (static_cast<uint64_t>(read_u32(data + 4)) << 32);
+	}
+
+	std::string normalize_path(std::string_view path)
+	{
+		while (path.starts_with("./")) path.remove_prefix(2);
+		while (path.starts_with("/")) path.remove_prefix(1);
+		std::string result(path);
+		std::replace(result.begin(), result.end(), '\\', '/');
+		return result;
+	}
+
+	bool inflate_raw(std::span<const std::byte> input, uint8_t* output, size_t outputSize)
+	{
+		z_stream stream{};
+		// Negative window bits, zip entries are raw deflate without the zlib header
+		if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) return false;
+		stream.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(input.data()));
+		stream.next_out = output;
+		int result = Z_OK;
+		size_t remainingIn = input.size();
+		size_t remainingOut = outputSize;
+		// avail_in / avail_out are 32 bits, feed entries larger than that in slices
+		while (result == Z_OK) {
+			const uInt inChunk = static_cast<uInt>(std::min<size_t>(remainingIn, std::numeric_limits<uInt>::max()));
+			const uInt outChunk = static_cast<uInt>(std::min<size_t>(remainingOut, std::numeric_limits<uInt>::max()));
+			stream.avail_in = inChunk;
+			stream.avail_out = outChunk;
+			result = inflate(&stream, Z_NO_FLUSH);
+			remainingIn -= inChunk - stream.avail_in;
+			remainingOut -= outChunk - stream.avail_out;
+		}
+		inflateEnd(&stream);
+		return result == Z_STREAM_END && remainingOut == 0;
+	}
+}
+
+bool CesiumTileArchive::open(const std::string& path, std::string* outError)
+{
+	this->m_entries.clear();
+	this->m_file = std::make_shared<MappedFile>();
+	if (!this->m_file->open(path)) {
+		*outError = "Could not open the archive " + path;
+		this->m_file.reset();
+		return false;
+	}
+	if (!this->read_central_directory(outError)) {
+		*outError += " (" + path + ")";
+		this->m_file.reset();
+		this->m_entries.clear();
+		return false;
+	}
+	return true;
+}
+
+const CesiumTileArchive::Entry_t* CesiumTileArchive::find(std::string_view path) const
+{
+	auto it = this->m_entries.find(normalize_path(path));
+	return it == this->m_entries.end() ? nullptr : &it->second;
+}
+
+std::string CesiumTileArchive::find_root_document() const
+{
+	constexpr std::string_view rootDocuments[] = { "tileset.json", "layer.json" };
+	for (std::string_view document : rootDocuments) {
+		if (this->m_entries.contains(std::string(document))) return std::string(document);
+	}
+	// Archives made by zipping a folder have the whole tileset one level down
+	std::string best;
+	size_t bestDepth = std::numeric_limits<size_t>::max();
+	for (const auto& [entryPath, entry] : this->m_entries) {
+		const size_t slash = entryPath.find_last_of('/');
+		const std::string_view fileName = std::string_view(entryPath).substr(slash == std::string::npos ? 0 : slash + 1);
+		if (fileName != rootDocuments[0] && fileName != rootDocuments[1]) continue;
+		const size_t depth = std::count(entryPath.begin(), entryPath.end(), '/');
+		if (depth < bestDepth || (depth == bestDepth && entryPath < best)) {
+			best = entryPath;
+			bestDepth = depth;
+		}
+	}
+	return best;
+}
+
+std::span<const std::byte> CesiumTileArchive::get_raw_bytes(const Entry_t& entry) const
+{
+	const std::span<const std::byte> archive = this->m_file->get_bytes();
+	if (entry.localHeaderOffset > archive.size() || archive.size() - entry.localHeaderOffset < LOCAL_HEADER_SIZE) return {};
+	const std::byte* header = archive.data() + entry.localHeaderOffset;
+	if (read_u32(header) != LOCAL_HEADER_SIGNATURE) return {};
+	// The local extra field may differ from the central one, only the local header knows where the data starts
+	const uint64_t dataOffset = entry.localHeaderOffset + LOCAL_HEADER_SIZE + read_u16(header + 26) + read_u16(header + 28);
+	if (dataOffset > archive.size() || archive.size() - dataOffset < entry.compressedSize) return {};
+	return archive.subspan(static_cast<size_t>(dataOffset), static_cast<size_t>(entry.compressedSize));
+}
+
+bool CesiumTileArchive::extract(const Entry_t& entry, PackedByteArray* output) const
+{
+	const std::span<const std::byte> raw = this->get_raw_bytes(entry);
+	if (raw.size() != entry.compressedSize) return false;
+	if (output->resize(static_cast<int64_t>(entry.uncompressedSize)) != OK) return false;
+	if (entry.uncompressedSize == 0) return true;
+
+	switch (entry.method) {
+	case CompressionMethod::Stored:
+		if (raw.size() != entry.uncompressedSize) return false;
+		memcpy(output->ptrw(), raw.data(), raw.size());
+		return true;
+	case CompressionMethod::Deflate:
+		return inflate_raw(raw, output->ptrw(), static_cast<size_t>(entry.uncompressedSize));
+	case CompressionMethod::Zstd: {
+		const size_t size = ZSTD_decompress(output->ptrw(), static_cast<size_t>(entry.uncompressedSize), raw.data(), raw.size());
+		return !ZSTD_isError(size) && size == entry.uncompressedSize;
+	}
+	}
+	return false;
+}
+
+std::shared_ptr<const MappedFile> CesiumTileArchive::get_mapped_file() const
+{
+	return this->m_file;
+}
+
+size_t CesiumTileArchive::get_entry_count() const
+{
+	return this->m_entries.size();
+}
+
+bool CesiumTileArchive::read_central_directory(std::string* outError)
+{
+	const std::span<const std::byte> archive = this->m_file->get_bytes();
+	if (archive.size() < END_OF_CENTRAL_DIRECTORY_SIZE) {
+		*outError = "The archive is too small to be a zip file";
+		return false;
+	}
+
+	// The end record sits at the very end, only followed by a comment of up to 64 KiB
+	const size_t searchStart = archive.size() - END_OF_CENTRAL_DIRECTORY_SIZE;
+	const size_t searchEnd = searchStart > MAX_COMMENT_SIZE ? searchStart - MAX_COMMENT_SIZE : 0;
+	size_t endRecordOffset = std::numeric_limits<size_t>::max();
+	for (size_t offset = searchStart + 1; offset-- > searchEnd;) {
+		if (read_u32(archive.data() + offset) == END_OF_CENTRAL_DIRECTORY_SIGNATURE) {
+			endRecordOffset = offset;
+			break;
+		}
+	}
+	if (endRecordOffset == std::numeric_limits<size_t>::max()) {
+		*outError = "No end of central directory record, this is not a zip file";
+		return false;
+	}
+
+	const std::byte* endRecord = archive.data() + endRecordOffset;
+	if (read_u16(endRecord + 4) != 0 || read_u16(endRecord + 6) != 0) {
+		*outError = "Archives split over several files are not supported";
+		return false;
+	}
+	uint64_t entryCount = read_u16(endRecord + 10);
+	uint64_t directorySize = read_u32(endRecord + 12);
+	uint64_t directoryOffset = read_u32(endRecord + 16);
+
+	// Saturated fields mean the real values live in the ZIP64 end record
+	if (entryCount == 0xFFFF || directorySize == 0xFFFFFFFF || directoryOffset == 0xFFFFFFFF) {
+		if (endRecordOffset < ZIP64_LOCATOR_SIZE || read_u32(endRecord - ZIP64_LOCATOR_SIZE) != ZIP64_LOCATOR_SIGNATURE) {
+			*outError = "The ZIP64 end of central directory locator is missing";
+			return false;
+		}
+		const uint64_t zip64RecordOffset = read_u64(endRecord - ZIP64_LOCATOR_SIZE + 8);
+		if (archive.size() < ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE || zip64RecordOffset > archive.size() - ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE ||
+				read_u32(archive.data() + zip64RecordOffset) != ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE) {
+			*outError = "The ZIP64 end of central directory record is damaged";
+			return false;
+		}
+		const std::byte* zip64Record = archive.data() + zip64RecordOffset;
+		entryCount = read_u64(zip64Record + 32);
+		directorySize = read_u64(zip64Record + 40);
+		directoryOffset = read_u64(zip64Record + 48);
+	}
+	if (directoryOffset > archive.size() || archive.size() - directoryOffset < directorySize) {
+		*outError = "The central directory points outside of the archive";
+		return false;
+	}
+
+	this->m_entries.reserve(static_cast<size_t>(std::min<uint64_t>(entryCount, directorySize / CENTRAL_HEADER_SIZE)));
+	const std::byte* cursor = archive.data() + directoryOffset;
+	const std::byte* directoryEnd = cursor + directorySize;
+	for (uint64_t i = 0; i < entryCount; i++) {
+		if (directoryEnd - cursor < static_cast<ptrdiff_t>(CENTRAL_HEADER_SIZE) || read_u32(cursor) != CENTRAL_HEADER_SIGNATURE) {
+			*outError = "The central directory is damaged";
+			return false;
+		}
+		const uint16_t nameLength = read_u16(cursor + 28);
+		const uint16_t extraLength = read_u16(cursor + 30);
+		const uint16_t commentLength = read_u16(cursor + 32);
+		const size_t recordSize = CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+		if (static_cast<size_t>(directoryEnd - cursor) < recordSize) {
+			*outError = "The central directory is damaged";
+			return false;
+		}
+
+		Entry_t entry;
+		entry.method = static_cast<CompressionMethod>(read_u16(cursor + 10));
+		entry.compressedSize = read_u32(cursor + 20);
+		entry.uncompressedSize = read_u32(cursor + 24);
+		entry.localHeaderOffset = read_u32(cursor + 42);
+
+		// The ZIP64 extra field only holds the values whose 32 bit field is saturated, in this order
+		const std::byte* extra = cursor + CENTRAL_HEADER_SIZE + nameLength;
+		const std::byte* extraEnd = extra + extraLength;
+		while (extraEnd - extra >= 4) {
+			const uint16_t fieldId = read_u16(extra);
+			const uint16_t fieldSize = read_u16(extra + 2);
+			const std::byte* field = extra + 4;
+			if (extraEnd - field < fieldSize) break;
+			if (fieldId == ZIP64_EXTRA_FIELD_ID) {
+				const std::byte* fieldEnd = field + fieldSize;
+				if (entry.uncompressedSize == 0xFFFFFFFF && fieldEnd - field >= 8) {
+					entry.uncompressedSize = read_u64(field);
+					field += 8;
+				}
+				if (entry.compressedSize == 0xFFFFFFFF && fieldEnd - field >= 8) {
+					entry.compressedSize = read_u64(field);
+					field += 8;
+				}
+				if (entry.localHeaderOffset == 0xFFFFFFFF && fieldEnd - field >= 8) {
+					entry.localHeaderOffset = read_u64(field);
+				}
+				break;
+			}
+			extra = field + fieldSize;
+		}
+
+		std::string name(reinterpret_cast<const char*>(cursor + CENTRAL_HEADER_SIZE), nameLength);
+		cursor += recordSize;
+		// Folders have entries of their own in most archives, they hold nothing to serve
+		if (name.empty() || name.back() == '/') continue;
+		this->m_entries.insert_or_assign(normalize_path(name), entry);
+	}
+	return true;
+}
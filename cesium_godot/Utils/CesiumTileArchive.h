@@ -0,0 +1,68 @@
+#ifndef CESIUM_TILE_ARCHIVE_H
+#define CESIUM_TILE_ARCHIVE_H
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/variant/packed_byte_array.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "core/variant/variant.h"
+#endif
+
+#include "MappedFile.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief Read-only access to a 3D Tiles archive (3TZ) or any zip holding a tileset, ZIP64 included
+ * The archive is memory mapped and its central directory is read once into a path index, after that lookups and reads
+ * don't lock and may run on any number of threads. Stored entries are views over the mapping, deflate and zstd entries
+ * are decompressed on read
+ */
+class CesiumTileArchive {
+public:
+	enum class CompressionMethod : uint16_t {
+		Stored = 0,
+		Deflate = 8,
+		Zstd = 93
+	};
+
+	struct Entry_t {
+		uint64_t localHeaderOffset = 0;
+		uint64_t compressedSize = 0;
+		uint64_t uncompressedSize = 0;
+		CompressionMethod method = CompressionMethod::Stored;
+	};
+
+	/// @brief Fails when the file is not a zip, spans several disks or its central directory is damaged
+	bool open(const std::string& path, std::string* outError);
+
+	/// @brief Paths are relative to the archive root with forward slashes, nullptr when there's no such file
+	const Entry_t* find(std::string_view path) const;
+
+	/// @brief "tileset.json" at the root as 3TZ mandates, else the shallowest tileset.json / layer.json of the archive
+	std::string find_root_document() const;
+
+	/// @brief The entry's bytes as they are stored in the archive, empty when the entry points outside of it
+	std::span<const std::byte> get_raw_bytes(const Entry_t& entry) const;
+
+	/// @brief Decompresses the entry, false when its method is unsupported or the data is corrupt
+	bool extract(const Entry_t& entry, PackedByteArray* output) const;
+
+	/// @brief The mapping stored entries point into, responses keep it alive
+	std::shared_ptr<const MappedFile> get_mapped_file() const;
+
+	size_t get_entry_count() const;
+
+private:
+	bool read_central_directory(std::string* outError);
+
+	std::shared_ptr<MappedFile> m_file;
+
+	std::unordered_map<std::string, Entry_t> m_entries;
+};
+
+#endif // !CESIUM_TILE_ARCHIVE_H
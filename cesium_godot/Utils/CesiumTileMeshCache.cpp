@@ -0,0 +1,152 @@
+#include "CesiumTileMeshCache.h"
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/classes/base_material3d.hpp>
+#include <godot_cpp/classes/texture2d.hpp>
+#elif defined(CESIUM_GD_MODULE)
+#include "scene/resources/material.h"
+#include "scene/resources/texture.h"
+#endif
+
+#include <cstdint>
+#include <unordered_set>
+
+// Mesh::ARRAY_CUSTOM0 to ARRAY_CUSTOM3, the count itself isn't bound for extensions
+constexpr int32_t CUSTOM_ARRAY_COUNT = 4;
+
+namespace {
+	uint64_t get_vertex_stride(uint64_t format)
+	{
+		uint64_t stride = 0;
+		if (format & Mesh::ARRAY_FORMAT_VERTEX) stride += 12;
+		if (format & Mesh::ARRAY_FORMAT_NORMAL) stride += 4;
+		if (format & Mesh::ARRAY_FORMAT_TANGENT) stride += 4;
+		if (format & Mesh::ARRAY_FORMAT_COLOR) stride += 4;
+		if (format & Mesh::ARRAY_FORMAT_TEX_UV) stride += 8;
+		if (format & Mesh::ARRAY_FORMAT_TEX_UV2) stride += 8;
+		if (format & Mesh::ARRAY_FORMAT_BONES) stride += 8;
+		if (format & Mesh::ARRAY_FORMAT_WEIGHTS) stride += 8;
+		// Feature ids and other custom attributes of converted glTF primitives
+		for (int32_t i = 0; i < CUSTOM_ARRAY_COUNT; i++) {
+			if (!(format & (static_cast<uint64_t>(Mesh::ARRAY_FORMAT_CUSTOM0) << i))) continue;
+			const uint64_t customShift = static_cast<uint64_t>(Mesh::ARRAY_FORMAT_CUSTOM_BASE) + i * static_cast<uint64_t>(Mesh::ARRAY_FORMAT_CUSTOM_BITS);
+			const uint64_t customFormat = (format >> customShift) & static_cast<uint64_t>(Mesh::ARRAY_FORMAT_CUSTOM_MASK);
+			switch (customFormat) {
+			case Mesh::ARRAY_CUSTOM_RGBA_HALF:
+			case Mesh::ARRAY_CUSTOM_RG_FLOAT:
+				stride += 8;
+				break;
+			case Mesh::ARRAY_CUSTOM_RGB_FLOAT:
+				stride += 12;
+				break;
+			case Mesh::ARRAY_CUSTOM_RGBA_FLOAT:
+				stride += 16;
+				break;
+			default:
+				stride += 4;
+				break;
+			}
+		}
+		return stride;
+	}
+
+	/// @brief Base level plus a full mip chain, at 4 bytes per texel
+	uint64_t get_texture_bytes(const Ref<Texture2D>& texture)
+	{
+		return static_cast<uint64_t>(texture->get_width()) * static_cast<uint64_t>(texture->get_height()) * 4 * 4 / 3;
+	}
+}
+
+Ref<ArrayMesh> CesiumTileMeshCache::get(uint64_t key, PackedVector3Array* outCollisionFaces)
+{
+	std::scoped_lock lock(s_mutex);
+	auto it = s_entries.find(key);
+	if (it == s_entries.end()) return Ref<ArrayMesh>();
+	s_lru.splice(s_lru.begin(), s_lru, it->second.lruPosition);
+	*outCollisionFaces = it->second.collisionFaces;
+	return it->second.mesh;
+}
+
+void CesiumTileMeshCache::put(uint64_t key, const Ref<ArrayMesh>& mesh, const PackedVector3Array& collisionFaces)
+{
+	if (mesh.is_null() || !is_enabled()) return;
+	// Walks the surfaces and materials, keep it out of the lock
+	const uint64_t bytes = estimate_bytes(mesh, collisionFaces);
+	const uint64_t maxBytes = s_maxBytes;
+	if (bytes > maxBytes) return;
+
+	std::scoped_lock lock(s_mutex);
+	auto it = s_entries.find(key);
+	if (it != s_entries.end()) {
+		// Two tilesets converted the same tile concurrently, the second one may have collision the first one lacked
+		s_usedBytes -= it->second.bytes;
+		s_lru.erase(it->second.lruPosition);
+		s_entries.erase(it);
+	}
+	evict_to(maxBytes - bytes);
+	s_lru.push_front(key);
+	s_entries.emplace(key, Entry_t{ mesh, collisionFaces, bytes, s_lru.begin() });
+	s_usedBytes += bytes;
+}
+
+void CesiumTileMeshCache::set_max_bytes(uint64_t bytes)
+{
+	s_maxBytes = bytes;
+	std::scoped_lock lock(s_mutex);
+	evict_to(bytes);
+}
+
+uint64_t CesiumTileMeshCache::get_max_bytes()
+{
+	return s_maxBytes;
+}
+
+bool CesiumTileMeshCache::is_enabled()
+{
+	return s_maxBytes > 0;
+}
+
+void CesiumTileMeshCache::clear()
+{
+	std::scoped_lock lock(s_mutex);
+	s_entries.clear();
+	s_lru.clear();
+	s_usedBytes = 0;
+}
+
+uint64_t CesiumTileMeshCache::estimate_bytes(const Ref<ArrayMesh>& mesh, const PackedVector3Array& collisionFaces)
+{
+	uint64_t bytes = static_cast<uint64_t>(collisionFaces.size()) * sizeof(Vector3);
+	// Surfaces converted from the same glTF material share it, count its textures once
+	std::unordered_set<uint64_t> countedTextures;
+	const int32_t surfaceCount = mesh->get_surface_count();
+	for (int32_t i = 0; i < surfaceCount; i++) {
+		const uint64_t vertexCount = static_cast<uint64_t>(mesh->surface_get_array_len(i));
+		const uint64_t vertexStride = get_vertex_stride(mesh->surface_get_format(i));
+		// Every blend shape keeps its own copy of the vertex arrays
+		bytes += vertexCount * vertexStride * (1 + static_cast<uint64_t>(mesh->get_blend_shape_count()));
+		// Godot switches to 16 bit indices when every vertex fits
+		const uint64_t indexSize = vertexCount <= UINT16_MAX ? sizeof(uint16_t) : sizeof(uint32_t);
+		bytes += static_cast<uint64_t>(mesh->surface_get_array_index_len(i)) * indexSize;
+
+		Ref<BaseMaterial3D> material = mesh->surface_get_material(i);
+		if (material.is_null()) continue;
+		// Normal, ORM, emissive and occlusion maps weigh as much as the albedo
+		for (int32_t slot = 0; slot < BaseMaterial3D::TEXTURE_MAX; slot++) {
+			Ref<Texture2D> texture = material->get_texture(static_cast<BaseMaterial3D::TextureParam>(slot));
+			if (texture.is_null() || !countedTextures.insert(texture->get_instance_id()).second) continue;
+			bytes += get_texture_bytes(texture);
+		}
+	}
+	return bytes;
+}
+
+void CesiumTileMeshCache::evict_to(uint64_t maxBytes)
+{
+	while (s_usedBytes > maxBytes && !s_lru.empty()) {
+		auto it = s_entries.find(s_lru.back());
+		s_usedBytes -= it->second.bytes;
+		s_entries.erase(it);
+		s_lru.pop_back();
+	}
+}
@@ -0,0 +1,72 @@
+#ifndef CESIUM_TILE_MESH_CACHE_H
+#define CESIUM_TILE_MESH_CACHE_H
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/classes/array_mesh.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "scene/resources/mesh.h"
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * @brief Process-wide, byte budgeted LRU of converted tiles (mesh, materials, textures and collision triangles)
+ * Tilesets are rebuilt from scratch when their source changes or they re-enter the tree, with this cache the new tileset
+ * picks up the meshes of the previous one instead of converting (or reading from disk) every tile again.
+ * Entries share LocalCacheManager's keys (tile URL, content hash and attribute layout)
+ * @note Accessed from the tile load threads, tiles share the cached meshes, overlays only touch per-instance override materials
+ */
+class CesiumTileMeshCache {
+
+public:
+	static constexpr uint64_t DEFAULT_MAX_BYTES = 512ull * 1024ull * 1024ull;
+
+	/// @brief Null on a miss, a hit becomes the most recently used entry
+	static Ref<ArrayMesh> get(uint64_t key, PackedVector3Array* outCollisionFaces);
+
+	/// @brief Evicts least recently used entries until the new one fits, entries larger than the whole budget are not kept
+	static void put(uint64_t key, const Ref<ArrayMesh>& mesh, const PackedVector3Array& collisionFaces);
+
+	/// @brief 0 disables the cache
+	static void set_max_bytes(uint64_t bytes);
+
+	static uint64_t get_max_bytes();
+
+	static bool is_enabled();
+
+	/// @brief Has to run before the engine shuts down, the entries hold engine resources
+	static void clear();
+
+private:
+	struct Entry_t {
+		Ref<ArrayMesh> mesh;
+		PackedVector3Array collisionFaces;
+		uint64_t bytes;
+		std::list<uint64_t>::iterator lruPosition;
+	};
+
+	/// @brief Vertex (custom attributes and blend shapes included) and index buffers from the surface formats, every texture slot of the materials at 32 bits per texel with mipmaps
+	static uint64_t estimate_bytes(const Ref<ArrayMesh>& mesh, const PackedVector3Array& collisionFaces);
+
+	/// @brief Expects s_mutex to be held
+	static void evict_to(uint64_t maxBytes);
+
+	static inline std::mutex s_mutex;
+
+	/// @brief Most recently used first
+	static inline std::list<uint64_t> s_lru;
+
+	static inline std::unordered_map<uint64_t, Entry_t> s_entries;
+
+	static inline uint64_t s_usedBytes = 0;
+
+	static inline std::atomic<uint64_t> s_maxBytes{ DEFAULT_MAX_BYTES };
+};
+
+#endif // !CESIUM_TILE_MESH_CACHE_H
@@ -0,0 +1,130 @@
+#include "CesiumTilePrefetcher.h"
+
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <limits>
+
+// Weight of the newest velocity sample, smooths out frame time jitter without lagging behind turns too much
+constexpr double VELOCITY_SMOOTHING = 0.2;
+// Below this speed (units per second) the camera is considered parked and nothing is predicted
+constexpr double MIN_PREFETCH_SPEED = 1.0;
+// Gaps longer than this (pauses, hitches, teleports) restart the estimate instead of producing a huge velocity
+constexpr double MAX_SAMPLE_GAP_SECONDS = 0.5;
+constexpr int32_t MAX_STEP_COUNT = 8;
+
+void CesiumTilePrefetcher::add_sample(const glm::dvec3& position, Clock_t::time_point time)
+{
+	if (this->m_hasSample) {
+		const double elapsedSeconds = std::chrono::duration<double>(time - this->m_lastSampleTime).count();
+		if (elapsedSeconds > MAX_SAMPLE_GAP_SECONDS) {
+			this->m_velocity = glm::dvec3(0.0);
+		}
+		else if (elapsedSeconds > 0.0) {
+			const glm::dvec3 sampleVelocity = (position - this->m_lastPosition) / elapsedSeconds;
+			this->m_velocity += (sampleVelocity - this->m_velocity) * VELOCITY_SMOOTHING;
+		}
+	}
+	this->m_lastPosition = position;
+	this->m_lastSampleTime = time;
+	this->m_hasSample = true;
+}
+
+std::vector<PrefetchPose_t> CesiumTilePrefetcher::predict(const glm::dvec3& position, const glm::dvec3& direction, const glm::dvec3& up) const
+{
+	std::vector<PrefetchPose_t> poses;
+	const double speed = glm::length(this->m_velocity);
+	if (speed < MIN_PREFETCH_SPEED) return poses;
+
+	poses.reserve(this->m_stepCount);
+	for (int32_t step = 1; step <= this->m_stepCount; step++) {
+		const double seconds = this->m_lookaheadSeconds * step / this->m_stepCount;
+		PrefetchPose_t pose{ position + this->m_velocity * seconds, direction, up };
+
+		glm::dvec3 routeDirection;
+		if (this->walk_route(position, speed * seconds, &pose.position, &routeDirection)) {
+			pose.direction = routeDirection;
+		}
+		// Keep the up vector orthogonal, the view state builds its frustum from both
+		const glm::dvec3 right = glm::cross(pose.direction, up);
+		if (glm::length(right) > 1e-6) {
+			pose.up = glm::normalize(glm::cross(right, pose.direction));
+		}
+		poses.push_back(pose);
+	}
+	return poses;
+}
+
+void CesiumTilePrefetcher::set_route(std::vector<glm::dvec3> waypoints)
+{
+	this->m_route = std::move(waypoints);
+}
+
+const std::vector<glm::dvec3>& CesiumTilePrefetcher::get_route() const
+{
+	return this->m_route;
+}
+
+void CesiumTilePrefetcher::set_lookahead_seconds(double seconds)
+{
+	this->m_lookaheadSeconds = std::max(0.0, seconds);
+}
+
+double CesiumTilePrefetcher::get_lookahead_seconds() const
+{
+	return this->m_lookaheadSeconds;
+}
+
+void CesiumTilePrefetcher::set_step_count(int32_t steps)
+{
+	this->m_stepCount = std::clamp(steps, 1, MAX_STEP_COUNT);
+}
+
+int32_t CesiumTilePrefetcher::get_step_count() const
+{
+	return this->m_stepCount;
+}
+
+void CesiumTilePrefetcher::reset()
+{
+	this->m_velocity = glm::dvec3(0.0);
+	this->m_hasSample = false;
+}
+
+bool CesiumTilePrefetcher::walk_route(const glm::dvec3& position, double distance, glm::dvec3* outPosition, glm::dvec3* outDirection) const
+{
+	if (this->m_route.size() < 2) return false;
+
+	// Closest point on the polyline
+	size_t segment = 0;
+	double segmentT = 0.0;
+	double closestDistanceSq = std::numeric_limits<double>::max();
+	for (size_t i = 0; i + 1 < this->m_route.size(); i++) {
+		const glm::dvec3 segmentVector = this->m_route[i + 1] - this->m_route[i];
+		const double lengthSq = glm::dot(segmentVector, segmentVector);
+		const double t = lengthSq > 0.0 ? std::clamp(glm::dot(position - this->m_route[i], segmentVector) / lengthSq, 0.0, 1.0) : 0.0;
+		const glm::dvec3 offset = this->m_route[i] + segmentVector * t - position;
+		const double distanceSq = glm::dot(offset, offset);
+		if (distanceSq < closestDistanceSq) {
+			closestDistanceSq = distanceSq;
+			segment = i;
+			segmentT = t;
+		}
+	}
+
+	// Walk forward, clamping at the end of the route
+	for (size_t i = segment; i + 1 < this->m_route.size(); i++) {
+		const glm::dvec3 segmentVector = this->m_route[i + 1] - this->m_route[i];
+		const double segmentLength = glm::length(segmentVector);
+		if (segmentLength <= 0.0) continue;
+		const double remaining = segmentLength * (1.0 - segmentT);
+		*outDirection = segmentVector / segmentLength;
+		if (distance <= remaining || i + 2 == this->m_route.size()) {
+			const double t = std::min(1.0, segmentT + distance / segmentLength);
+			*outPosition = this->m_route[i] + segmentVector * t;
+			return true;
+		}
+		distance -= remaining;
+		segmentT = 0.0;
+	}
+	return false;
+}
@@ -0,0 +1,71 @@
+#ifndef CESIUM_TILE_PREFETCHER_H
+#define CESIUM_TILE_PREFETCHER_H
+
+#include <glm/vec3.hpp>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/// @brief Camera pose a tileset should have loaded by the time the camera gets there
+struct PrefetchPose_t {
+	glm::dvec3 position;
+	glm::dvec3 direction;
+	glm::dvec3 up;
+};
+
+/**
+ * @brief Predicts where the camera is heading so its tiles can be requested ahead of time
+ * Without a route the camera velocity is estimated from the positions fed every frame and extrapolated linearly.
+ * With a route (known flight paths, scripted cameras) the camera is projected onto it and walked forward at its current speed,
+ * looking along the route
+ * @note Works in whatever space the tileset builds its view states in, ECEF when georeferenced
+ */
+class CesiumTilePrefetcher {
+public:
+	using Clock_t = std::chrono::steady_clock;
+
+	static constexpr double DEFAULT_LOOKAHEAD_SECONDS = 4.0;
+	static constexpr int32_t DEFAULT_STEP_COUNT = 2;
+
+	/// @brief Feeds the camera position of this frame
+	void add_sample(const glm::dvec3& position, Clock_t::time_point time);
+
+	/// @brief Poses ahead of the camera, at lookahead * (i / steps) seconds for every step
+	std::vector<PrefetchPose_t> predict(const glm::dvec3& position, const glm::dvec3& direction, const glm::dvec3& up) const;
+
+	/// @brief Replaces extrapolation with a fixed path, an empty route goes back to extrapolating
+	void set_route(std::vector<glm::dvec3> waypoints);
+
+	const std::vector<glm::dvec3>& get_route() const;
+
+	void set_lookahead_seconds(double seconds);
+
+	double get_lookahead_seconds() const;
+
+	void set_step_count(int32_t steps);
+
+	int32_t get_step_count() const;
+
+	/// @brief Forgets the velocity estimate, e.g. after a teleport
+	void reset();
+
+private:
+	/// @brief Position on the route lookahead meters past the point closest to position, with the route direction there
+	bool walk_route(const glm::dvec3& position, double distance, glm::dvec3* outPosition, glm::dvec3* outDirection) const;
+
+	std::vector<glm::dvec3> m_route;
+
+	glm::dvec3 m_lastPosition{ 0.0 };
+
+	glm::dvec3 m_velocity{ 0.0 };
+
+	Clock_t::time_point m_lastSampleTime{};
+
+	bool m_hasSample = false;
+
+	double m_lookaheadSeconds = DEFAULT_LOOKAHEAD_SECONDS;
+
+	int32_t m_stepCount = DEFAULT_STEP_COUNT;
+};
+
+#endif // !CESIUM_TILE_PREFETCHER_H
@@ -0,0 +1,338 @@
+#include "CurlBandwidthGovernor.h"
+
+#include <curl/curl.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Buckets hold up to this many seconds of budget, so short idle periods can be caught up in a burst
+constexpr double BURST_SECONDS = 1.0;
+// Longest the engines sleep while something is queued, the buckets are refilled on every pump
+constexpr int32_t MAX_PUMP_WAIT_MS = 100;
+
+constexpr size_t PRIORITY_COUNT = static_cast<size_t>(CurlRequestPriority::Count);
+
+namespace {
+	using Clock_t = std::chrono::steady_clock;
+
+	struct TokenBucket_t {
+		double rate = 0.0;
+		double tokens = 0.0;
+		Clock_t::time_point lastRefill = Clock_t::now();
+
+		bool is_limited() const {
+			return this->rate > 0.0;
+		}
+
+		double get_capacity() const {
+			return std::max(this->rate * BURST_SECONDS, 1.0);
+		}
+
+		void set_rate(double newRate) {
+			this->rate = std::max(0.0, newRate);
+			this->tokens = this->get_capacity();
+			this->lastRefill = Clock_t::now();
+		}
+
+		void refill(Clock_t::time_point now) {
+			if (!this->is_limited()) return;
+			const double elapsedSeconds = std::chrono::duration<double>(now - this->lastRefill).count();
+			this->tokens = std::min(this->get_capacity(), this->tokens + elapsedSeconds * this->rate);
+			this->lastRefill = now;
+		}
+
+		bool has(double required) const {
+			return !this->is_limited() || this->tokens >= required;
+		}
+
+		void take(double amount) {
+			if (!this->is_limited()) return;
+			this->tokens -= amount;
+		}
+
+		int64_t get_wait_ms(double required) const {
+			if (this->has(required)) return 0;
+			return static_cast<int64_t>(std::ceil((required - this->tokens) / this->rate * 1000.0));
+		}
+	};
+
+	struct HostState_t {
+		CurlBandwidthGovernor::HostBudget_t budget;
+		TokenBucket_t requests;
+		// Charged after the fact, a transfer may start as long as the byte bucket is not in debt
+		TokenBucket_t bytes;
+		bool hasOwnLimits = false;
+		size_t queued[PRIORITY_COUNT] = {};
+
+		bool can_admit() const {
+			return this->requests.has(1.0) && this->bytes.has(1.0);
+		}
+
+		int64_t get_wait_ms() const {
+			return std::max(this->requests.get_wait_ms(1.0), this->bytes.get_wait_ms(1.0));
+		}
+	};
+
+	struct QueuedTransfer_t {
+		HostState_t* host;
+		const void* owner;
+		CurlBandwidthGovernor::AdmitCallback_t onAdmit;
+	};
+
+	std::mutex s_governorMutex;
+	std::unordered_map<std::string, std::unique_ptr<HostState_t>> s_hosts;
+	std::deque<QueuedTransfer_t> s_queues[PRIORITY_COUNT];
+	TokenBucket_t s_globalRequests;
+	TokenBucket_t s_globalBytes;
+	double s_defaultHostBytesPerSecond = 0.0;
+	double s_defaultHostRequestsPerSecond = 0.0;
+	CurlBandwidthGovernor::Statistics_t s_statistics;
+	std::atomic<int64_t> s_unchargedGlobalBytes{ 0 };
+
+	thread_local CurlRequestPriority t_threadPriority = CurlRequestPriority::Normal;
+
+	bool ends_with(const std::string& value, const char* suffix) {
+		const size_t suffixLength = strlen(suffix);
+		return value.size() >= suffixLength && value.compare(value.size() - suffixLength, suffixLength, suffix) == 0;
+	}
+
+	/// @brief Expects the governor to be locked
+	HostState_t* find_or_add_host(const std::string& host) {
+		auto it = s_hosts.find(host);
+		if (it != s_hosts.end()) return it->second.get();
+
+		auto state = std::make_unique<HostState_t>();
+		state->requests.set_rate(s_defaultHostRequestsPerSecond);
+		state->bytes.set_rate(s_defaultHostBytesPerSecond);
+		HostState_t* result = state.get();
+		s_hosts.emplace(host, std::move(state));
+		return result;
+	}
+
+	bool can_admit_globally() {
+		return s_globalRequests.has(1.0) && s_globalBytes.has(1.0);
+	}
+
+	void admit(HostState_t* host) {
+		host->requests.take(1.0);
+		s_globalRequests.take(1.0);
+		s_statistics.admitted++;
+	}
+
+	/// @brief Brings the buckets up to date, expects the governor to be locked
+	void refill_and_charge() {
+		const Clock_t::time_point now = Clock_t::now();
+		s_globalRequests.refill(now);
+		s_globalBytes.refill(now);
+		const int64_t receivedBytes = s_unchargedGlobalBytes.exchange(0);
+		s_globalBytes.take(static_cast<double>(receivedBytes));
+		s_statistics.receivedBytes += receivedBytes;
+		for (auto& [hostName, host] : s_hosts) {
+			host->requests.refill(now);
+			host->bytes.refill(now);
+			host->bytes.take(static_cast<double>(host->budget.unchargedBytes.exchange(0)));
+		}
+	}
+}
+
+CurlBandwidthGovernor::ScopedPriority::ScopedPriority(CurlRequestPriority priority) : m_previous(t_threadPriority)
+{
+	t_threadPriority = priority;
+}
+
+CurlBandwidthGovernor::ScopedPriority::~ScopedPriority()
+{
+	t_threadPriority = this->m_previous;
+}
+
+CurlRequestPriority CurlBandwidthGovernor::get_thread_priority()
+{
+	return t_threadPriority;
+}
+
+CurlRequestPriority CurlBandwidthGovernor::classify(const std::string& url, CurlRequestPriority hint)
+{
+	if (hint != CurlRequestPriority::Normal) return hint;
+
+	const std::string path = url.substr(0, url.find_first_of("?#"));
+	const bool isMetadata = ends_with(path, ".json") || ends_with(path, ".subtree") || path.find("/v1/assets/") != std::string::npos;
+	return isMetadata ? CurlRequestPriority::High : CurlRequestPriority::Normal;
+}
+
+std::string CurlBandwidthGovernor::get_host(const char* url)
+{
+	CURLU* parsedUrl = curl_url();
+	char* host = nullptr;
+	std::string result;
+	if (parsedUrl != nullptr && curl_url_set(parsedUrl, CURLUPART_URL, url, 0) == CURLUE_OK &&
+			curl_url_get(parsedUrl, CURLUPART_HOST, &host, 0) == CURLUE_OK) {
+		result = host;
+	}
+	curl_free(host);
+	curl_url_cleanup(parsedUrl);
+	return result;
+}
+
+CurlBandwidthGovernor::HostBudget_t* CurlBandwidthGovernor::get_host_budget(const std::string& host)
+{
+	std::scoped_lock lock(s_governorMutex);
+	return &find_or_add_host(host)->budget;
+}
+
+void CurlBandwidthGovernor::submit(const std::string& host, CurlRequestPriority priority, const void* owner, AdmitCallback_t onAdmit)
+{
+	std::scoped_lock lock(s_governorMutex);
+	refill_and_charge();
+	HostState_t* hostState = find_or_add_host(host);
+	const size_t priorityIndex = static_cast<size_t>(priority);
+
+	// Transfers of the same or a higher class that are already waiting go first
+	bool mustWait = !hostState->can_admit() || !can_admit_globally();
+	for (size_t i = 0; i <= priorityIndex && !mustWait; i++) {
+		const bool globallyLimited = s_globalRequests.is_limited() || s_globalBytes.is_limited();
+		mustWait = hostState->queued[i] > 0 || (globallyLimited && !s_queues[i].empty());
+	}
+
+	if (!mustWait) {
+		admit(hostState);
+		onAdmit(true);
+		return;
+	}
+	hostState->queued[priorityIndex]++;
+	s_queues[priorityIndex].push_back({ hostState, owner, std::move(onAdmit) });
+	s_statistics.throttled++;
+}
+
+int32_t CurlBandwidthGovernor::pump()
+{
+	std::scoped_lock lock(s_governorMutex);
+	refill_and_charge();
+
+	int64_t waitMs = MAX_PUMP_WAIT_MS;
+	for (size_t priorityIndex = 0; priorityIndex < PRIORITY_COUNT; priorityIndex++) {
+		std::deque<QueuedTransfer_t>& queue = s_queues[priorityIndex];
+		for (auto it = queue.begin(); it != queue.end();) {
+			if (!can_admit_globally()) {
+				// Lower classes never overtake a higher one on the global budget
+				waitMs = std::min(waitMs, std::max(s_globalRequests.get_wait_ms(1.0), s_globalBytes.get_wait_ms(1.0)));
+				return static_cast<int32_t>(std::max<int64_t>(waitMs, 1));
+			}
+			HostState_t* host = it->host;
+			if (!host->can_admit()) {
+				waitMs = std::min(waitMs, host->get_wait_ms());
+				++it;
+				continue;
+			}
+			admit(host);
+			host->queued[priorityIndex]--;
+			it->onAdmit(true);
+			it = queue.erase(it);
+		}
+	}
+	return static_cast<int32_t>(std::max<int64_t>(waitMs, 1));
+}
+
+void CurlBandwidthGovernor::cancel_owner(const void* owner)
+{
+	std::scoped_lock lock(s_governorMutex);
+	for (size_t priorityIndex = 0; priorityIndex < PRIORITY_COUNT; priorityIndex++) {
+		std::deque<QueuedTransfer_t>& queue = s_queues[priorityIndex];
+		for (auto it = queue.begin(); it != queue.end();) {
+			if (it->owner != owner) {
+				++it;
+				continue;
+			}
+			it->host->queued[priorityIndex]--;
+			it->onAdmit(false);
+			s_statistics.dropped++;
+			it = queue.erase(it);
+		}
+	}
+}
+
+void CurlBandwidthGovernor::charge_bytes(HostBudget_t* budget, int64_t bytes)
+{
+	budget->unchargedBytes += bytes;
+	s_unchargedGlobalBytes += bytes;
+}
+
+int64_t CurlBandwidthGovernor::get_transfer_speed_limit(const std::string& host)
+{
+	std::scoped_lock lock(s_governorMutex);
+	const HostState_t* hostState = find_or_add_host(host);
+	double limit = 0.0;
+	for (double rate : { hostState->bytes.rate, s_globalBytes.rate }) {
+		if (rate > 0.0) {
+			limit = limit > 0.0 ? std::min(limit, rate) : rate;
+		}
+	}
+	return static_cast<int64_t>(limit);
+}
+
+void CurlBandwidthGovernor::set_global_limits(double bytesPerSecond, double requestsPerSecond)
+{
+	std::scoped_lock lock(s_governorMutex);
+	s_globalBytes.set_rate(bytesPerSecond);
+	s_globalRequests.set_rate(requestsPerSecond);
+}
+
+void CurlBandwidthGovernor::set_default_host_limits(double bytesPerSecond, double requestsPerSecond)
+{
+	std::scoped_lock lock(s_governorMutex);
+	s_defaultHostBytesPerSecond = std::max(0.0, bytesPerSecond);
+	s_defaultHostRequestsPerSecond = std::max(0.0, requestsPerSecond);
+	for (auto& [hostName, host] : s_hosts) {
+		if (host->hasOwnLimits) continue;
+		host->bytes.set_rate(s_defaultHostBytesPerSecond);
+		host->requests.set_rate(s_defaultHostRequestsPerSecond);
+	}
+}
+
+void CurlBandwidthGovernor::set_host_limits(const std::string& host, double bytesPerSecond, double requestsPerSecond)
+{
+	std::scoped_lock lock(s_governorMutex);
+	HostState_t* hostState = find_or_add_host(host);
+	hostState->hasOwnLimits = true;
+	hostState->bytes.set_rate(bytesPerSecond);
+	hostState->requests.set_rate(requestsPerSecond);
+}
+
+void CurlBandwidthGovernor::clear_host_limits(const std::string& host)
+{
+	std::scoped_lock lock(s_governorMutex);
+	auto it = s_hosts.find(host);
+	if (it == s_hosts.end()) return;
+	it->second->hasOwnLimits = false;
+	it->second->bytes.set_rate(s_defaultHostBytesPerSecond);
+	it->second->requests.set_rate(s_defaultHostRequestsPerSecond);
+}
+
+CurlBandwidthGovernor::Statistics_t CurlBandwidthGovernor::get_statistics()
+{
+	std::scoped_lock lock(s_governorMutex);
+	Statistics_t statistics = s_statistics;
+	statistics.receivedBytes += s_unchargedGlobalBytes.load();
+	for (size_t priorityIndex = 0; priorityIndex < PRIORITY_COUNT; priorityIndex++) {
+		statistics.queued[priorityIndex] = s_queues[priorityIndex].size();
+	}
+	statistics.globalBytesPerSecond = s_globalBytes.rate;
+	statistics.globalRequestsPerSecond = s_globalRequests.rate;
+	statistics.defaultHostBytesPerSecond = s_defaultHostBytesPerSecond;
+	statistics.defaultHostRequestsPerSecond = s_defaultHostRequestsPerSecond;
+	return statistics;
+}
+
+size_t CurlBandwidthGovernor::get_queued_count(CurlRequestPriority lowestPriority)
+{
+	std::scoped_lock lock(s_governorMutex);
+	size_t count = 0;
+	for (size_t priorityIndex = 0; priorityIndex <= static_cast<size_t>(lowestPriority) && priorityIndex < PRIORITY_COUNT; priorityIndex++) {
+		count += s_queues[priorityIndex].size();
+	}
+	return count;
+}
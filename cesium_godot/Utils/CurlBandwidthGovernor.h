@@ -0,0 +1,109 @@
+#ifndef CURL_BANDWIDTH_GOVERNOR_H
+#define CURL_BANDWIDTH_GOVERNOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/// @brief Admission order of queued transfers, FIFO inside each class
+enum class CurlRequestPriority : uint8_t {
+	/// @brief Tileset / layer json, subtrees and Ion endpoints, traversal stalls until these arrive
+	High,
+	/// @brief Tile content and imagery
+	Normal,
+	/// @brief Speculative work (prefetching, cache seeding), only admitted when nothing else waits
+	Low,
+	Count
+};
+
+/**
+ * @brief Process wide token bucket governor for the asynchronous curl clients
+ * Limits requests per second and bytes per second globally and per host, transfers over budget wait in priority queues
+ * until the buckets refill. Received bytes are charged while they arrive, so a burst of large tiles
+ * holds back new admissions instead of overshooting the cap. With no limits set every transfer is admitted right away
+ */
+class CurlBandwidthGovernor {
+public:
+	/// @brief Called once with true when the transfer may start, or with false if it was dropped (client shutting down)
+	using AdmitCallback_t = std::function<void(bool)>;
+
+	/// @brief Byte counter of a host, handed out once and charged by the transfers' progress callbacks without locking
+	struct HostBudget_t {
+		std::atomic<int64_t> unchargedBytes{ 0 };
+	};
+
+	/// @brief Marks every request issued by this thread while alive, e.g. to push prefetching behind regular loads
+	class ScopedPriority {
+	public:
+		explicit ScopedPriority(CurlRequestPriority priority);
+
+		~ScopedPriority();
+
+		ScopedPriority(const ScopedPriority&) = delete;
+
+		ScopedPriority& operator=(const ScopedPriority&) = delete;
+
+	private:
+		CurlRequestPriority m_previous;
+	};
+
+	static CurlRequestPriority get_thread_priority();
+
+	/// @brief Request header carrying the priority through accessors that continue on another thread (the request cache)
+	/// Added by PriorityAssetAccessor, the network accessor takes it off before the request is sent
+	static constexpr const char* PRIORITY_HEADER = "x-cesium-godot-priority";
+
+	/// @brief Priority class of a request, metadata urls are promoted unless the caller asked for Low
+	static CurlRequestPriority classify(const std::string& url, CurlRequestPriority hint);
+
+	static std::string get_host(const char* url);
+
+	/// @brief Stable for the lifetime of the process
+	static HostBudget_t* get_host_budget(const std::string& host);
+
+	/// @brief Admits the transfer right away when there is budget, otherwise queues it
+	/// @note onAdmit runs with the governor locked, it should only hand the transfer over to its I/O thread
+	static void submit(const std::string& host, CurlRequestPriority priority, const void* owner, AdmitCallback_t onAdmit);
+
+	/// @brief Refills the buckets and admits what fits, returns how long until the next admission may be possible
+	/// Called by every multi engine on each loop iteration
+	static int32_t pump();
+
+	/// @brief Drops the queued transfers of a client that is shutting down, their callbacks get false
+	static void cancel_owner(const void* owner);
+
+	static void charge_bytes(HostBudget_t* budget, int64_t bytes);
+
+	/// @brief Receive speed cap for a single transfer to host, 0 when unlimited
+	static int64_t get_transfer_speed_limit(const std::string& host);
+
+	/// @brief 0 removes the limit
+	static void set_global_limits(double bytesPerSecond, double requestsPerSecond);
+
+	/// @brief Limits every host gets unless it has its own, 0 removes the limit
+	static void set_default_host_limits(double bytesPerSecond, double requestsPerSecond);
+
+	static void set_host_limits(const std::string& host, double bytesPerSecond, double requestsPerSecond);
+
+	static void clear_host_limits(const std::string& host);
+
+	struct Statistics_t {
+		uint64_t admitted = 0;
+		uint64_t throttled = 0;
+		uint64_t dropped = 0;
+		uint64_t receivedBytes = 0;
+		size_t queued[static_cast<size_t>(CurlRequestPriority::Count)] = {};
+		double globalBytesPerSecond = 0.0;
+		double globalRequestsPerSecond = 0.0;
+		double defaultHostBytesPerSecond = 0.0;
+		double defaultHostRequestsPerSecond = 0.0;
+	};
+
+	static Statistics_t get_statistics();
+
+	/// @brief Transfers waiting for admission in the given class or any class above it
+	static size_t get_queued_count(CurlRequestPriority lowestPriority);
+};
+
+#endif // !CURL_BANDWIDTH_GOVERNOR_H
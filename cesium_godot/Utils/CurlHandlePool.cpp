@@ -0,0 +1,119 @@
+#include "CurlHandlePool.h"
+#include "CurlShareContext.h"
+
+#include <algorithm>
+
+CurlHandlePool::CurlHandlePool(uint32_t capacity)
+{
+	this->m_handles.reserve(capacity);
+	this->m_freeHandles.reserve(capacity);
+	for (uint32_t i = 0; i < capacity; i++) {
+		CURL* handle = create_handle();
+		this->m_handles.push_back(handle);
+		this->m_freeHandles.push_back(handle);
+	}
+	std::scoped_lock lock(s_poolsMutex);
+	s_pools.push_back(this);
+}
+
+CurlHandlePool::~CurlHandlePool()
+{
+	{
+		std::scoped_lock lock(s_poolsMutex);
+		std::erase(s_pools, this);
+	}
+	for (CURL* handle : this->m_handles) {
+		curl_easy_cleanup(handle);
+	}
+}
+
+CURL* CurlHandlePool::try_acquire()
+{
+	std::scoped_lock lock(this->m_mutex);
+	CURL* handle = this->pop_free_handle();
+	if (handle == nullptr) {
+		this->m_exhausted++;
+	}
+	return handle;
+}
+
+CURL* CurlHandlePool::acquire()
+{
+	std::unique_lock lock(this->m_mutex);
+	if (this->m_freeHandles.empty()) {
+		this->m_exhausted++;
+		this->m_waiting++;
+		this->m_released.wait(lock, [this] { return !this->m_freeHandles.empty(); });
+		this->m_waiting--;
+	}
+	return this->pop_free_handle();
+}
+
+void CurlHandlePool::release(CURL* handle)
+{
+	{
+		std::scoped_lock lock(this->m_mutex);
+		this->m_freeHandles.push_back(handle);
+	}
+	this->m_released.notify_one();
+}
+
+void CurlHandlePool::add_queued(int32_t delta)
+{
+	this->m_queued += delta;
+}
+
+bool CurlHandlePool::has_queued() const
+{
+	return this->m_queued > 0;
+}
+
+CurlHandlePool::Occupancy_t CurlHandlePool::get_occupancy() const
+{
+	std::scoped_lock lock(this->m_mutex);
+	Occupancy_t occupancy;
+	occupancy.capacity = static_cast<uint32_t>(this->m_handles.size());
+	occupancy.inUse = static_cast<uint32_t>(this->m_handles.size() - this->m_freeHandles.size());
+	occupancy.peakInUse = this->m_peakInUse;
+	occupancy.waiting = this->m_waiting;
+	occupancy.exhausted = this->m_exhausted;
+	occupancy.queued = this->m_queued;
+	return occupancy;
+}
+
+CurlHandlePool::Occupancy_t CurlHandlePool::get_total_occupancy()
+{
+	std::scoped_lock lock(s_poolsMutex);
+	Occupancy_t total;
+	for (const CurlHandlePool* pool : s_pools) {
+		const Occupancy_t occupancy = pool->get_occupancy();
+		total.capacity += occupancy.capacity;
+		total.inUse += occupancy.inUse;
+		total.peakInUse += occupancy.peakInUse;
+		total.waiting += occupancy.waiting;
+		total.exhausted += occupancy.exhausted;
+		total.queued += occupancy.queued;
+	}
+	return total;
+}
+
+CURL* CurlHandlePool::create_handle()
+{
+	CURL* handle = curl_easy_init();
+	curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
+	curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 0L);
+	curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1);
+	curl_easy_setopt(handle, CURLOPT_VERBOSE, 0);
+	CurlShareContext::apply_to_handle(handle);
+	return handle;
+}
+
+CURL* CurlHandlePool::pop_free_handle()
+{
+	if (this->m_freeHandles.empty()) return nullptr;
+	CURL* handle = this->m_freeHandles.back();
+	this->m_freeHandles.pop_back();
+	const uint32_t inUse = static_cast<uint32_t>(this->m_handles.size() - this->m_freeHandles.size());
+	this->m_peakInUse = std::max(this->m_peakInUse, inUse);
+	return handle;
+}
@@ -0,0 +1,84 @@
+#ifndef CURL_HANDLE_POOL_H
+#define CURL_HANDLE_POOL_H
+
+#include <curl/curl.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Fixed set of easy handles owned by one CurlHttpClient
+ * Every handle is created up front and the storage never grows, so a handle stays valid for as long as the pool lives
+ * Callers that can't block (the I/O thread) use try_acquire and queue their transfer themselves,
+ * blocking callers wait in acquire until a handle is released
+ */
+class CurlHandlePool {
+public:
+	struct Occupancy_t {
+		uint32_t capacity = 0;
+		uint32_t inUse = 0;
+		uint32_t peakInUse = 0;
+		/// @brief Threads blocked in acquire
+		uint32_t waiting = 0;
+		/// @brief Attempts parked by their owner after try_acquire failed
+		uint32_t queued = 0;
+		/// @brief Times a caller found the pool exhausted
+		uint64_t exhausted = 0;
+	};
+
+	explicit CurlHandlePool(uint32_t capacity);
+
+	~CurlHandlePool();
+
+	CurlHandlePool(const CurlHandlePool&) = delete;
+
+	CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+
+	/// @brief Null when every handle is taken
+	CURL* try_acquire();
+
+	/// @brief Blocks until a handle is free
+	CURL* acquire();
+
+	void release(CURL* handle);
+
+	/// @brief Bookkeeping for owners that queue instead of blocking, only feeds the statistics and has_queued
+	void add_queued(int32_t delta);
+
+	bool has_queued() const;
+
+	Occupancy_t get_occupancy() const;
+
+	/// @brief Sum over every live pool of the process
+	static Occupancy_t get_total_occupancy();
+
+private:
+	static CURL* create_handle();
+
+	/// @brief Expects m_mutex to be held
+	CURL* pop_free_handle();
+
+	std::vector<CURL*> m_handles;
+
+	std::vector<CURL*> m_freeHandles;
+
+	mutable std::mutex m_mutex;
+
+	std::condition_variable m_released;
+
+	uint32_t m_peakInUse = 0;
+
+	uint32_t m_waiting = 0;
+
+	uint64_t m_exhausted = 0;
+
+	std::atomic<uint32_t> m_queued{ 0 };
+
+	static inline std::mutex s_poolsMutex;
+
+	static inline std::vector<CurlHandlePool*> s_pools;
+};
+
+#endif // !CURL_HANDLE_POOL_H
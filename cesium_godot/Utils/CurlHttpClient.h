@@ -22,66 +22,58 @@ using namespace godot;
 #endif
 
 #include "BRThreadPool.h"
+#include "CurlBandwidthGovernor.h"
+#include "CurlHandlePool.h"
+#include "CurlMultiEngine.h"
+#include "CurlResponseBuffer.h"
+#include "CurlRetryPolicy.h"
+#include "CurlShareContext.h"
 #include <curl/curl.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 
-using HighLevelResponseCallback_t = std::function<void(int32_t, const PackedByteArray&)>;
+using CurlResponseHeaders_t = CurlResponseBuffer::Headers_t;
+using HighLevelResponseCallback_t = std::function<void(int32_t, const PackedByteArray&, const CurlResponseHeaders_t&)>;
 using CesiumHeader_t = std::pair<std::string, std::string>;
 
-struct RequestHandle_t {
-	CURL *curlHandle;
-	bool available;
-
-	RequestHandle_t() : curlHandle(nullptr), available(true) {}
-
-	RequestHandle_t(const RequestHandle_t &other) {
-		this->curlHandle = other.curlHandle;
-		this->available = other.available;
-	}
-
-	RequestHandle_t &operator=(const RequestHandle_t &other) {
-		if (this != &other) {
-			this->curlHandle = other.curlHandle;
-			this->available = other.available;
-		}
-		return *this;
-	}
-
-	void easy_init() {
-		this->curlHandle = curl_easy_init();
-		this->available = true;
-		curl_easy_setopt(this->curlHandle, CURLOPT_SSL_VERIFYPEER, 0L);
-		curl_easy_setopt(this->curlHandle, CURLOPT_SSL_VERIFYHOST, 0L);
-		curl_easy_setopt(this->curlHandle, CURLOPT_FOLLOWLOCATION, 1);
-		curl_easy_setopt(this->curlHandle, CURLOPT_VERBOSE, 0);
-	}
-
-	void easy_cleanup() {
-		curl_easy_cleanup(this->curlHandle);
-	}
-
-	void configure_http_method(HTTPClient::Method method) {
-		switch (method) {
-			case HTTPClient::METHOD_POST:
-				curl_easy_setopt(this->curlHandle, CURLOPT_POST, 1);
-				break;
-			case HTTPClient::METHOD_PUT:
-				curl_easy_setopt(this->curlHandle, CURLOPT_PUT, 1);
-				break;
-			default:
-				break;
-		}
-	}
-
-};
-
 struct MemoryStruct {
 	char *memory;
 	size_t size;
 };
 
+/// @brief One try of a transfer on its own easy handle, retries and hedges each get a new one
+struct CurlAttempt_t {
+	CURL* curlHandle = nullptr;
+	curl_slist* headers = nullptr;
+	CurlResponseBuffer body;
+	CurlMultiEngine::Clock_t::time_point startTime;
+	CurlBandwidthGovernor::HostBudget_t* budget = nullptr;
+	curl_off_t chargedBytes = 0;
+};
+
+/// @brief Everything a transfer driven by the multi engine needs to outlive send_request
+/// @note Only the I/O thread touches it once the first attempt has been handed over
+struct CurlTransfer_t {
+	std::string url;
+	HTTPClient::Method method = HTTPClient::METHOD_GET;
+	std::vector<CesiumHeader_t> headers;
+	HighLevelResponseCallback_t callback;
+	std::string host;
+	CurlRequestPriority priority = CurlRequestPriority::Normal;
+	int32_t retries = 0;
+	bool settled = false;
+	bool hedged = false;
+	std::vector<std::shared_ptr<CurlAttempt_t>> liveAttempts;
+};
+
 /// @brief Wrapper around libcurl, but without worrying about polling constantly
+/// At most N_MAX_HANDLES transfers run at once, attempts beyond that wait for a handle in priority order
 template<uint32_t N_MAX_HANDLES>
 class CurlHttpClient {
 	static_assert(N_MAX_HANDLES <= 100); //Just to handle around 80 handles at once, multiple transfers will happen on the same handle
@@ -92,19 +84,25 @@ public:
 			curl_global_init(CURL_GLOBAL_ALL);
 		}
 		s_activeInstances++;
-		this->m_activeHandles.reserve(N_MAX_HANDLES);
-		//Init all handles
-		for (int32_t i = 0; i < N_MAX_HANDLES; i++) {
-			RequestHandle_t handle{};
-			handle.easy_init();
-			this->m_activeHandles.push_back(handle);
-		}
+		CurlShareContext::acquire();
+		this->m_handlePool = std::make_unique<CurlHandlePool>(N_MAX_HANDLES);
 	}
 
 	~CurlHttpClient() {
-		for (int32_t i = 0; i < this->m_activeHandles.size(); i++) {
-			this->m_activeHandles[i].easy_cleanup();
+		// Pending transfers still reference the handles, fail them before cleaning up
+		this->m_shuttingDown = true;
+		CurlBandwidthGovernor::cancel_owner(this);
+		this->m_multiEngine.stop();
+		// The I/O thread is gone, nothing else touches the queue anymore
+		for (auto& queue : this->m_waitingForHandle) {
+			for (const std::shared_ptr<CurlTransfer_t>& transfer : queue) {
+				this->fail_transfer(transfer);
+				this->m_handlePool->add_queued(-1);
+			}
+			queue.clear();
 		}
+		this->m_handlePool.reset();
+		CurlShareContext::release();
 
 		s_activeInstances--;
 		if (s_activeInstances == 0) {
@@ -114,6 +112,7 @@ public:
 
 	void init_client(size_t maxThreads) {
 		this->m_threadPool.init(maxThreads);
+		this->m_multiEngine.start();
 		std::string systemInfo = OS::get_singleton()->get_name().utf8().get_data();
 		auto architecture = OS::get_singleton()->get_processor_name().utf8().get_data();
 		std::stringstream stream;
@@ -131,51 +130,79 @@ public:
 		this->send_request_same_thread(url, HTTPClient::METHOD_GET, callback, headers);
 	}
 
-	void send_request(const char* url, HTTPClient::Method method, const HighLevelResponseCallback_t& callback, const std::vector<CesiumHeader_t>& headers) {
-		//Get any active handle
-		int32_t handleIdx = this->get_available_handle_index();
-		this->m_activeHandles[handleIdx].available = false;
-		std::string urlCopy = url;
-		this->m_threadPool.enqueue([&, urlCopy, headers, callback, handleIdx] {
-			RequestHandle_t& handle = this->m_activeHandles[handleIdx];
-			handle.configure_http_method(method);
-			long responseCode;
-			PackedByteArray packedData = pull_url(urlCopy.c_str(), handle.curlHandle, &responseCode, headers);
-			//And call the callback methods here
-			callback(responseCode, packedData);
-			handle.available = true;
-		});
+	/// @brief Runs the transfer on the client's multi engine, the callback is invoked on the thread pool
+	/// Every attempt is admitted by CurlBandwidthGovernor first, transient failures of GET / HEAD are retried following CurlRetryPolicy
+	/// and slow GETs may be hedged with a second attempt
+	void send_request(const char* url, HTTPClient::Method method, const HighLevelResponseCallback_t& callback, const std::vector<CesiumHeader_t>& headers, CurlRequestPriority priority = CurlRequestPriority::Normal) {
+		auto transfer = std::make_shared<CurlTransfer_t>();
+		transfer->url = url;
+		transfer->method = method;
+		transfer->headers = headers;
+		transfer->callback = callback;
+		transfer->host = CurlBandwidthGovernor::get_host(url);
+		transfer->priority = CurlBandwidthGovernor::classify(transfer->url, priority);
+		this->request_attempt(transfer);
 	}
 
-
 	void send_request_same_thread(const char *url, HTTPClient::Method method, const HighLevelResponseCallback_t &callback, const std::vector<CesiumHeader_t> &headers) {
-		//Get any active handle
-		int32_t handleIdx = this->get_available_handle_index();
-		this->m_activeHandles[handleIdx].available = false;
-		RequestHandle_t &handle = this->m_activeHandles[handleIdx];
-		handle.configure_http_method(method);
-		long responseCode;
-		PackedByteArray packedData = pull_url(url, handle.curlHandle, &responseCode, headers);
+		CURL* curlHandle = this->m_handlePool->acquire();
+		configure_http_method(curlHandle, method);
+		CurlResponseBuffer responseBuffer;
+		curl_slist* curlHeaders = this->configure_transfer(curlHandle, url, &responseBuffer, headers);
+		CURLcode code = curl_easy_perform(curlHandle);
+		long responseCode = this->finish_transfer(curlHandle, code, curlHeaders);
+		if (code != CURLcode::CURLE_OK) {
+			print_transfer_error(url, code);
+		}
+		this->release_handle(curlHandle);
+		PackedByteArray packedData = code == CURLcode::CURLE_OK ? responseBuffer.take() : PackedByteArray();
+		CurlResponseHeaders_t responseHeaders = code == CURLcode::CURLE_OK ? responseBuffer.take_headers() : CurlResponseHeaders_t();
 		//And call the callback methods here
-		callback(responseCode, packedData);
-		handle.available = true;
+		callback(responseCode, packedData, responseHeaders);
 	}
 
 	void add_default_header(const CesiumHeader_t& header) {
 		this->m_defaultHeaders.emplace_back(header);
 	}
 
+	CurlHandlePool::Occupancy_t get_handle_occupancy() const {
+		return this->m_handlePool->get_occupancy();
+	}
+
 private:
 	static inline uint16_t s_activeInstances = 0;
 
-	PackedByteArray pull_url(const char *url, CURL *handle, long*outStatus , const std::vector<CesiumHeader_t> &headers) {
-		PackedByteArray buffer;
+	static void configure_http_method(CURL* handle, HTTPClient::Method method) {
+		switch (method) {
+			case HTTPClient::METHOD_POST:
+				curl_easy_setopt(handle, CURLOPT_POST, 1);
+				break;
+			case HTTPClient::METHOD_PUT:
+				curl_easy_setopt(handle, CURLOPT_PUT, 1);
+				break;
+			default:
+				// Handles are reused, make sure a previous POST / PUT does not stick
+				curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+				break;
+		}
+	}
+
+	/// @brief Sets up the handle to pull url into buffer, returns the header list that has to live until the transfer is done
+	curl_slist* configure_transfer(CURL *handle, const char *url, CurlResponseBuffer* buffer, const std::vector<CesiumHeader_t> &headers) {
 		//Options stuff
+		buffer->reset(handle);
 		curl_easy_setopt(handle, CURLOPT_URL, url);
-		curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, &CurlHttpClient::write_callback);
-		curl_easy_setopt(handle, CURLOPT_WRITEDATA, &buffer);
+		curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, &CurlResponseBuffer::write_callback);
+		curl_easy_setopt(handle, CURLOPT_WRITEDATA, buffer);
+		curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, &CurlResponseBuffer::header_callback);
+		curl_easy_setopt(handle, CURLOPT_HEADERDATA, buffer);
 		curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
-
+		curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, static_cast<long>(CurlRetryPolicy::get_request_timeout_ms()));
+		curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(CurlRetryPolicy::get_connect_timeout_ms()));
+		// Governed attempts turn these back on, handles are shared with the blocking path
+		curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 1L);
+		curl_easy_setopt(handle, CURLOPT_MAX_RECV_SPEED_LARGE, static_cast<curl_off_t>(0));
+		CurlShareContext::apply_to_request(handle, url);
 
 		curl_slist* curlHeaders = nullptr;
 		for (const CesiumHeader_t& h : headers)
@@ -185,59 +212,215 @@ private:
 			curlHeaders = curl_slist_append(curlHeaders, strHeader.c_str());
 		}
 
-		for (const CesiumHeader_t& h : headers) {
+		// Then add default headers
+		for (const CesiumHeader_t& h : this->m_defaultHeaders) {
 			std::string strHeader = h.first + ": ";
 			strHeader += h.second;
 			curlHeaders = curl_slist_append(curlHeaders, strHeader.c_str());
 		}
-		
-		// Then add default headers
 
 		curl_easy_setopt(handle, CURLOPT_HTTPHEADER, curlHeaders);
+		return curlHeaders;
+	}
 
-		//Perform the request		
-		CURLcode code = curl_easy_perform(handle);
-		//Then from the result we can do error handling
+	/// @brief Frees the transfer's headers and returns its status code, 0 if the transfer itself failed
+	long finish_transfer(CURL *handle, CURLcode code, curl_slist* curlHeaders) {
+		curl_slist_free_all(curlHeaders);
 		if (code != CURLcode::CURLE_OK) {
-			ERR_PRINT(String("Could not make request to: ") + url + String(" error: ") + itos(code));
-			return PackedByteArray();
+			return 0;
 		}
 
-		curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, outStatus);
-		curl_slist_free_all(curlHeaders);
-		return buffer;
+		long status = 0;
+		curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+		// file:// and other non HTTP protocols report no status, a successful transfer there is a plain OK
+		if (status == 0) {
+			status = HTTPClient::ResponseCode::RESPONSE_OK;
+		}
+		return status;
 	}
 
-	static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
-		auto *vectorBuffer = reinterpret_cast<PackedByteArray*>(userp);
-		char *contentCStr = reinterpret_cast<char *>(contents);
-		size_t realSize = size * nmemb;
+	static void print_transfer_error(const char* url, CURLcode code) {
+		// Cancelled hedges and transfers aborted on shutdown are expected
+		if (code == CURLcode::CURLE_ABORTED_BY_CALLBACK) return;
+		ERR_PRINT(String("Could not make request to: ") + url + String(" error: ") + itos(code));
+	}
 
-		for (size_t i = 0; i < realSize; i++) {
-			vectorBuffer->push_back(contentCStr[i]);
+	/// @brief Waits for the governor to admit a new attempt, the attempt itself always starts on the I/O thread
+	void request_attempt(const std::shared_ptr<CurlTransfer_t>& transfer) {
+		if (this->m_shuttingDown) {
+			this->schedule_admission(transfer, false);
+			return;
 		}
-	
-		return realSize;
+		CurlBandwidthGovernor::submit(transfer->host, transfer->priority, this, [this, transfer](bool admitted) {
+			this->schedule_admission(transfer, admitted);
+		});
 	}
 
-	int32_t get_available_handle_index() {
-		for (int32_t i = 0; i < this->m_activeHandles.size(); i++)
-		{
-			const RequestHandle_t &handle = this->m_activeHandles.at(i);
-			if (handle.available) {
-				return i;
+	void schedule_admission(const std::shared_ptr<CurlTransfer_t>& transfer, bool admitted) {
+		this->m_multiEngine.schedule(CurlMultiEngine::Clock_t::now(), [this, transfer, admitted] {
+			if (transfer->settled) return;
+			if (admitted) {
+				this->start_attempt(transfer);
+				return;
+			}
+			// Dropped on shutdown, a live attempt of a hedged pair settles the transfer on its own
+			if (!transfer->liveAttempts.empty()) return;
+			this->fail_transfer(transfer);
+		});
+	}
+
+	void fail_transfer(const std::shared_ptr<CurlTransfer_t>& transfer) {
+		transfer->settled = true;
+		this->m_threadPool.enqueue([callback = transfer->callback] {
+			callback(0, PackedByteArray(), CurlResponseHeaders_t());
+		});
+	}
+
+	/// @brief Starts on curlHandle when the caller already holds one, otherwise takes one from the pool
+	void start_attempt(const std::shared_ptr<CurlTransfer_t>& transfer, CURL* curlHandle = nullptr) {
+		// The I/O thread must never block, park the attempt until a handle comes back
+		if (curlHandle == nullptr) {
+			curlHandle = this->m_handlePool->try_acquire();
+		}
+		if (curlHandle == nullptr) {
+			// Count first and look again, a handle released by a blocking caller in between would otherwise not wake the queue
+			this->m_handlePool->add_queued(1);
+			curlHandle = this->m_handlePool->try_acquire();
+			if (curlHandle == nullptr) {
+				this->m_waitingForHandle[static_cast<size_t>(transfer->priority)].push_back(transfer);
+				return;
+			}
+			this->m_handlePool->add_queued(-1);
+		}
+
+		auto attempt = std::make_shared<CurlAttempt_t>();
+		attempt->curlHandle = curlHandle;
+		configure_http_method(attempt->curlHandle, transfer->method);
+		attempt->headers = this->configure_transfer(attempt->curlHandle, transfer->url.c_str(), &attempt->body, transfer->headers);
+		attempt->startTime = CurlMultiEngine::Clock_t::now();
+
+		// Received bytes are charged to the governor as they arrive
+		attempt->budget = CurlBandwidthGovernor::get_host_budget(transfer->host);
+		curl_easy_setopt(attempt->curlHandle, CURLOPT_NOPROGRESS, 0L);
+		curl_easy_setopt(attempt->curlHandle, CURLOPT_XFERINFOFUNCTION, &CurlHttpClient::charge_received_bytes);
+		curl_easy_setopt(attempt->curlHandle, CURLOPT_XFERINFODATA, attempt.get());
+		curl_easy_setopt(attempt->curlHandle, CURLOPT_MAX_RECV_SPEED_LARGE, static_cast<curl_off_t>(CurlBandwidthGovernor::get_transfer_speed_limit(transfer->host)));
+		transfer->liveAttempts.push_back(attempt);
+
+		this->m_multiEngine.add_transfer(attempt->curlHandle, [this, transfer, attempt](CURL* curlHandle, CURLcode code) {
+			this->on_attempt_done(transfer, attempt, code);
+		});
+
+		// Only the first attempt of an idempotent request is duplicated, the clock starts once it actually runs
+		const bool isFirstAttempt = transfer->retries == 0 && !transfer->hedged;
+		const int64_t hedgeDelayMs = isFirstAttempt && transfer->method == HTTPClient::METHOD_GET ? CurlRetryPolicy::get_hedge_delay_ms() : -1;
+		if (hedgeDelayMs < 0) return;
+		this->m_multiEngine.schedule(CurlMultiEngine::Clock_t::now() + std::chrono::milliseconds(hedgeDelayMs), [this, transfer] {
+			if (transfer->settled || transfer->hedged || transfer->retries > 0) return;
+			transfer->hedged = true;
+			this->request_attempt(transfer);
+		});
+	}
+
+	static int charge_received_bytes(void* userData, curl_off_t downloadTotal, curl_off_t downloadNow, curl_off_t uploadTotal, curl_off_t uploadNow) {
+		auto* attempt = reinterpret_cast<CurlAttempt_t*>(userData);
+		if (downloadNow > attempt->chargedBytes) {
+			CurlBandwidthGovernor::charge_bytes(attempt->budget, downloadNow - attempt->chargedBytes);
+			attempt->chargedBytes = downloadNow;
+		}
+		return 0;
+	}
+
+	/// @brief Runs on the I/O thread, settles the transfer or decides whether to try again
+	void on_attempt_done(const std::shared_ptr<CurlTransfer_t>& transfer, const std::shared_ptr<CurlAttempt_t>& attempt, CURLcode code) {
+		std::erase(transfer->liveAttempts, attempt);
+		long responseCode = this->finish_transfer(attempt->curlHandle, code, attempt->headers);
+		attempt->headers = nullptr;
+		const int64_t retryAfterMs = attempt->body.get_retry_after_ms();
+		const bool decodeFailed = attempt->body.has_decode_failed();
+		PackedByteArray body = code == CURLcode::CURLE_OK ? attempt->body.take() : PackedByteArray();
+		CurlResponseHeaders_t responseHeaders = code == CURLcode::CURLE_OK ? attempt->body.take_headers() : CurlResponseHeaders_t();
+		this->release_handle(attempt->curlHandle);
+		if (transfer->settled) return;
+
+		// A POST / PUT may have taken effect before it failed, only idempotent requests are sent again
+		const bool idempotent = transfer->method == HTTPClient::METHOD_GET || transfer->method == HTTPClient::METHOD_HEAD;
+		const bool retryable = idempotent && CurlRetryPolicy::is_retryable(code, responseCode, decodeFailed);
+		if (retryable) {
+			// The other attempt of a hedged pair may still make it
+			if (!transfer->liveAttempts.empty()) return;
+			if (transfer->retries < CurlRetryPolicy::get_max_retries()) {
+				transfer->retries++;
+				const int64_t delayMs = CurlRetryPolicy::compute_backoff_ms(transfer->retries, retryAfterMs);
+				this->m_multiEngine.schedule(CurlMultiEngine::Clock_t::now() + std::chrono::milliseconds(delayMs), [this, transfer] {
+					this->request_attempt(transfer);
+				});
+				return;
+			}
+		}
+		else if (code == CURLcode::CURLE_OK && responseCode < 400) {
+			const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(CurlMultiEngine::Clock_t::now() - attempt->startTime);
+			CurlRetryPolicy::record_latency(latency.count());
+		}
+
+		transfer->settled = true;
+		if (code != CURLcode::CURLE_OK) {
+			print_transfer_error(transfer->url.c_str(), code);
+		}
+		// The loser of a hedged pair is not needed anymore, cancelling it settles through this same method
+		std::vector<std::shared_ptr<CurlAttempt_t>> losers = transfer->liveAttempts;
+		for (const std::shared_ptr<CurlAttempt_t>& loser : losers) {
+			this->m_multiEngine.cancel_transfer(loser->curlHandle);
+		}
+
+		// Keep the I/O thread free, response processing happens on the workers
+		this->m_threadPool.enqueue([body = std::move(body), responseHeaders = std::move(responseHeaders), callback = transfer->callback, responseCode] {
+			callback(responseCode, body, responseHeaders);
+		});
+	}
+
+	/// @brief Hands the handle back and lets the highest priority waiting attempt have it
+	void release_handle(CURL* curlHandle) {
+		this->m_handlePool->release(curlHandle);
+		if (!this->m_handlePool->has_queued()) return;
+		// Deferred, this may run inside a completion callback of the multi engine or on a blocking caller's thread
+		this->m_multiEngine.schedule(CurlMultiEngine::Clock_t::now(), [this] {
+			this->start_waiting_attempts();
+		});
+	}
+
+	/// @brief Runs on the I/O thread
+	void start_waiting_attempts() {
+		for (auto& queue : this->m_waitingForHandle) {
+			while (!queue.empty()) {
+				// A hedge whose twin already won
+				if (queue.front()->settled) {
+					queue.pop_front();
+					this->m_handlePool->add_queued(-1);
+					continue;
+				}
+				CURL* curlHandle = this->m_handlePool->try_acquire();
+				if (curlHandle == nullptr) return;
+				std::shared_ptr<CurlTransfer_t> transfer = std::move(queue.front());
+				queue.pop_front();
+				this->m_handlePool->add_queued(-1);
+				this->start_attempt(transfer, curlHandle);
 			}
 		}
-		RequestHandle_t handle{};
-		handle.easy_init();
-		this->m_activeHandles.push_back(handle);
-		return this->m_activeHandles.size() - 1;
 	}
 
 	//Have a thread pool for some batches of requests
 	BRThreadPool m_threadPool;
 	std::vector<CesiumHeader_t> m_defaultHeaders;
-	std::vector<RequestHandle_t> m_activeHandles;
+	/// @brief Created after curl_global_init and CurlShareContext::acquire, freed before they are undone
+	std::unique_ptr<CurlHandlePool> m_handlePool;
+	/// @brief Attempts admitted by the governor that found every handle busy, one queue per priority class
+	/// @note Only touched by the I/O thread
+	std::array<std::deque<std::shared_ptr<CurlTransfer_t>>, static_cast<size_t>(CurlRequestPriority::Count)> m_waitingForHandle;
+	/// @brief Single I/O thread driving every transfer sent through send_request
+	CurlMultiEngine m_multiEngine;
+	/// @brief Set by the destructor, retries and hedges are no longer submitted to the governor
+	std::atomic<bool> m_shuttingDown{ false };
 };
 
 #endif // HIGH_LEVEL_HTTP_CLIENT
@@ -0,0 +1,206 @@
+#include "CurlMultiEngine.h"
+#include "CurlBandwidthGovernor.h"
+#include "CurlShareContext.h"
+
+#include <algorithm>
+
+#if defined(CESIUM_GD_EXT)
+#include "godot_cpp/core/error_macros.hpp"
+#include "godot_cpp/variant/string.hpp"
+using namespace godot;
+#endif
+
+// Upper bound for a poll when nothing happens, wakeups cut it short whenever a transfer is queued
+constexpr int32_t POLL_TIMEOUT_MS = 100;
+
+CurlMultiEngine::CurlMultiEngine()
+{
+	this->m_multiHandle = curl_multi_init();
+}
+
+CurlMultiEngine::~CurlMultiEngine()
+{
+	this->stop();
+	curl_multi_cleanup(this->m_multiHandle);
+}
+
+void CurlMultiEngine::start()
+{
+	if (this->m_running.exchange(true)) return;
+	this->m_ioThread = std::thread([this] { this->run(); });
+}
+
+void CurlMultiEngine::stop()
+{
+	if (!this->m_running.exchange(false)) return;
+	curl_multi_wakeup(this->m_multiHandle);
+	if (this->m_ioThread.joinable()) {
+		this->m_ioThread.join();
+	}
+	// Scheduled retries may queue new transfers and aborted transfers may schedule more work, settle everything
+	bool hasWork = true;
+	while (hasWork) {
+		this->run_scheduled_tasks(true);
+		this->abort_all_transfers();
+		std::scoped_lock lock(this->m_scheduleMutex, this->m_pendingMutex);
+		hasWork = !this->m_scheduledTasks.empty() || !this->m_pendingTransfers.empty();
+	}
+}
+
+void CurlMultiEngine::add_transfer(CURL* easyHandle, CompletionCallback_t onComplete)
+{
+	{
+		std::scoped_lock lock(this->m_pendingMutex);
+		this->m_pendingTransfers.push_back({ easyHandle, std::move(onComplete) });
+	}
+	this->m_activeTransferCount++;
+	curl_multi_wakeup(this->m_multiHandle);
+}
+
+void CurlMultiEngine::schedule(Clock_t::time_point due, std::function<void()> task)
+{
+	{
+		std::scoped_lock lock(this->m_scheduleMutex);
+		this->m_scheduledTasks.push({ due, std::move(task) });
+	}
+	curl_multi_wakeup(this->m_multiHandle);
+}
+
+void CurlMultiEngine::cancel_transfer(CURL* easyHandle)
+{
+	CompletionCallback_t onComplete;
+	auto it = this->m_activeTransfers.find(easyHandle);
+	if (it != this->m_activeTransfers.end()) {
+		curl_multi_remove_handle(this->m_multiHandle, easyHandle);
+		onComplete = std::move(it->second);
+		this->m_activeTransfers.erase(it);
+	}
+	else {
+		// Not started yet, it may still be waiting in the queue
+		std::scoped_lock lock(this->m_pendingMutex);
+		auto pendingIt = std::find_if(this->m_pendingTransfers.begin(), this->m_pendingTransfers.end(), [easyHandle](const PendingTransfer_t& transfer) {
+			return transfer.easyHandle == easyHandle;
+		});
+		if (pendingIt == this->m_pendingTransfers.end()) return;
+		onComplete = std::move(pendingIt->onComplete);
+		this->m_pendingTransfers.erase(pendingIt);
+	}
+	this->m_activeTransferCount--;
+	onComplete(easyHandle, CURLE_ABORTED_BY_CALLBACK);
+}
+
+size_t CurlMultiEngine::get_active_transfer_count() const
+{
+	return this->m_activeTransferCount.load();
+}
+
+void CurlMultiEngine::run()
+{
+	uint32_t appliedSettings = CurlShareContext::get_settings_generation();
+	CurlShareContext::apply_to_multi(this->m_multiHandle);
+
+	while (this->m_running.load()) {
+		// Connection limits can be changed from GDScript while we're streaming
+		if (appliedSettings != CurlShareContext::get_settings_generation()) {
+			appliedSettings = CurlShareContext::get_settings_generation();
+			CurlShareContext::apply_to_multi(this->m_multiHandle);
+		}
+		this->start_pending_transfers();
+
+		int runningHandles = 0;
+		CURLMcode code = curl_multi_perform(this->m_multiHandle, &runningHandles);
+		if (code != CURLM_OK) {
+			ERR_PRINT(String("curl_multi_perform failed: ") + curl_multi_strerror(code));
+		}
+
+		this->complete_finished_transfers();
+		// Every engine pumps the shared governor, queued transfers hop back to their own engine once admitted
+		const int32_t timeoutMs = std::min(this->run_scheduled_tasks(false), CurlBandwidthGovernor::pump());
+
+		code = curl_multi_poll(this->m_multiHandle, nullptr, 0, timeoutMs, nullptr);
+		if (code != CURLM_OK) {
+			ERR_PRINT(String("curl_multi_poll failed: ") + curl_multi_strerror(code));
+		}
+	}
+}
+
+void CurlMultiEngine::start_pending_transfers()
+{
+	std::vector<PendingTransfer_t> pending;
+	{
+		std::scoped_lock lock(this->m_pendingMutex);
+		pending.swap(this->m_pendingTransfers);
+	}
+
+	for (PendingTransfer_t& transfer : pending) {
+		CURLMcode code = curl_multi_add_handle(this->m_multiHandle, transfer.easyHandle);
+		if (code != CURLM_OK) {
+			ERR_PRINT(String("Could not start transfer: ") + curl_multi_strerror(code));
+			this->m_activeTransferCount--;
+			transfer.onComplete(transfer.easyHandle, CURLE_FAILED_INIT);
+			continue;
+		}
+		this->m_activeTransfers.emplace(transfer.easyHandle, std::move(transfer.onComplete));
+	}
+}
+
+void CurlMultiEngine::complete_finished_transfers()
+{
+	int messagesLeft = 0;
+	while (CURLMsg* message = curl_multi_info_read(this->m_multiHandle, &messagesLeft)) {
+		if (message->msg != CURLMSG_DONE) continue;
+
+		CURL* easyHandle = message->easy_handle;
+		const CURLcode result = message->data.result;
+		curl_multi_remove_handle(this->m_multiHandle, easyHandle);
+
+		auto it = this->m_activeTransfers.find(easyHandle);
+		if (it == this->m_activeTransfers.end()) continue;
+		CompletionCallback_t onComplete = std::move(it->second);
+		this->m_activeTransfers.erase(it);
+		this->m_activeTransferCount--;
+		onComplete(easyHandle, result);
+	}
+}
+
+void CurlMultiEngine::abort_all_transfers()
+{
+	// Only called once the I/O thread is gone, nothing else touches the multi handle anymore
+	// Callbacks may cancel their siblings, so detach the map before calling them
+	std::unordered_map<CURL*, CompletionCallback_t> active;
+	active.swap(this->m_activeTransfers);
+	for (auto& [easyHandle, onComplete] : active) {
+		curl_multi_remove_handle(this->m_multiHandle, easyHandle);
+		onComplete(easyHandle, CURLE_ABORTED_BY_CALLBACK);
+	}
+
+	std::vector<PendingTransfer_t> pending;
+	{
+		std::scoped_lock lock(this->m_pendingMutex);
+		pending.swap(this->m_pendingTransfers);
+	}
+	for (PendingTransfer_t& transfer : pending) {
+		transfer.onComplete(transfer.easyHandle, CURLE_ABORTED_BY_CALLBACK);
+	}
+	this->m_activeTransferCount = 0;
+}
+
+int32_t CurlMultiEngine::run_scheduled_tasks(bool force)
+{
+	while (true) {
+		std::function<void()> task;
+		{
+			std::scoped_lock lock(this->m_scheduleMutex);
+			if (this->m_scheduledTasks.empty()) return POLL_TIMEOUT_MS;
+			const Clock_t::time_point now = Clock_t::now();
+			const ScheduledTask_t& next = this->m_scheduledTasks.top();
+			if (!force && next.due > now) {
+				const auto untilDue = std::chrono::duration_cast<std::chrono::milliseconds>(next.due - now).count() + 1;
+				return static_cast<int32_t>(std::min<int64_t>(untilDue, POLL_TIMEOUT_MS));
+			}
+			task = std::move(const_cast<ScheduledTask_t&>(next).task);
+			this->m_scheduledTasks.pop();
+		}
+		task();
+	}
+}
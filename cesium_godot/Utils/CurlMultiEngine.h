@@ -0,0 +1,96 @@
+#ifndef CURL_MULTI_ENGINE_H
+#define CURL_MULTI_ENGINE_H
+
+#include <curl/curl.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Drives many concurrent easy handles from a single I/O thread through curl_multi
+ * Callers configure an easy handle, hand it over with add_transfer and get it back in the completion callback,
+ * which runs on the I/O thread, so it should only hand the result over to a worker and return
+ */
+class CurlMultiEngine {
+public:
+	using CompletionCallback_t = std::function<void(CURL*, CURLcode)>;
+	using Clock_t = std::chrono::steady_clock;
+
+	CurlMultiEngine();
+
+	~CurlMultiEngine();
+
+	CurlMultiEngine(const CurlMultiEngine&) = delete;
+
+	CurlMultiEngine& operator=(const CurlMultiEngine&) = delete;
+
+	/// @brief Spawns the I/O thread, transfers added before this call are started right away
+	void start();
+
+	/// @brief Joins the I/O thread, transfers still pending complete with CURLE_ABORTED_BY_CALLBACK
+	void stop();
+
+	/// @brief Queues a configured easy handle, safe to call from any thread
+	void add_transfer(CURL* easyHandle, CompletionCallback_t onComplete);
+
+	/// @brief Runs task on the I/O thread once due has passed (retries, hedges), safe to call from any thread
+	/// @note Tasks still waiting when the engine stops run right away, so whatever they start gets aborted like any other transfer
+	void schedule(Clock_t::time_point due, std::function<void()> task);
+
+	/// @brief Stops a transfer early, its callback gets CURLE_ABORTED_BY_CALLBACK. Only call it from the I/O thread (completion callbacks or scheduled tasks)
+	void cancel_transfer(CURL* easyHandle);
+
+	size_t get_active_transfer_count() const;
+
+private:
+	struct PendingTransfer_t {
+		CURL* easyHandle;
+		CompletionCallback_t onComplete;
+	};
+
+	struct ScheduledTask_t {
+		Clock_t::time_point due;
+		std::function<void()> task;
+
+		bool operator>(const ScheduledTask_t& other) const {
+			return this->due > other.due;
+		}
+	};
+
+	void run();
+
+	void start_pending_transfers();
+
+	void complete_finished_transfers();
+
+	void abort_all_transfers();
+
+	/// @brief Runs the due tasks (all of them if force is set), returns how long the I/O thread may sleep before the next one
+	int32_t run_scheduled_tasks(bool force);
+
+	CURLM* m_multiHandle = nullptr;
+
+	std::thread m_ioThread;
+
+	std::atomic<bool> m_running{ false };
+
+	std::atomic<size_t> m_activeTransferCount{ 0 };
+
+	std::mutex m_pendingMutex;
+
+	std::vector<PendingTransfer_t> m_pendingTransfers;
+
+	std::mutex m_scheduleMutex;
+
+	std::priority_queue<ScheduledTask_t, std::vector<ScheduledTask_t>, std::greater<ScheduledTask_t>> m_scheduledTasks;
+
+	/// @brief Only touched by the I/O thread
+	std::unordered_map<CURL*, CompletionCallback_t> m_activeTransfers;
+};
+
+#endif // !CURL_MULTI_ENGINE_H
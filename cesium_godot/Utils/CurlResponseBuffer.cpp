@@ -0,0 +1,265 @@
+#include "CurlResponseBuffer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+
+// Enough slabs to cover a few large chunked responses in flight without holding on to too much memory
+constexpr size_t MAX_POOLED_SLABS = 64;
+
+namespace {
+	std::mutex s_slabPoolMutex;
+	std::vector<std::unique_ptr<uint8_t[]>> s_slabPool;
+}
+
+CurlResponseBuffer::~CurlResponseBuffer()
+{
+	this->release_slabs();
+}
+
+void CurlResponseBuffer::reset(CURL* curlHandle)
+{
+	this->release_slabs();
+	this->m_curlHandle = curlHandle;
+	this->m_data = PackedByteArray();
+	this->m_size = 0;
+	this->m_lengthChecked = false;
+	this->m_presized = false;
+	this->m_headers.clear();
+	this->m_decoder.reset();
+	this->m_formatKnown = false;
+	this->m_decodeFailed = false;
+	this->m_sniffSize = 0;
+}
+
+bool CurlResponseBuffer::receive(const uint8_t* data, size_t size)
+{
+	if (!this->m_formatKnown) {
+		// Usually the whole magic number is in the first chunk and can be read in place
+		if (this->m_sniffSize == 0 && size >= CurlStreamDecoder::SNIFF_SIZE) {
+			return this->start_decoding(data, size);
+		}
+		const size_t toCopy = std::min(size, CurlStreamDecoder::SNIFF_SIZE - this->m_sniffSize);
+		memcpy(this->m_sniff + this->m_sniffSize, data, toCopy);
+		this->m_sniffSize += toCopy;
+		data += toCopy;
+		size -= toCopy;
+		if (this->m_sniffSize < CurlStreamDecoder::SNIFF_SIZE) return true;
+		if (!this->start_decoding(this->m_sniff, this->m_sniffSize)) return false;
+	}
+
+	if (this->m_decoder != nullptr) {
+		return this->m_decoder->write(data, size, *this);
+	}
+	this->append(data, size);
+	return true;
+}
+
+bool CurlResponseBuffer::start_decoding(const uint8_t* prefix, size_t size)
+{
+	this->m_formatKnown = true;
+	const CurlStreamDecoder::Format format = CurlStreamDecoder::detect(prefix, size);
+	if (format != CurlStreamDecoder::Format::Identity) {
+		this->m_decoder = std::make_unique<CurlStreamDecoder>(format);
+		// The Content-Length describes the compressed size, let the decoder size the body instead
+		this->m_lengthChecked = true;
+		return this->m_decoder->write(prefix, size, *this);
+	}
+	this->append(prefix, size);
+	return true;
+}
+
+void CurlResponseBuffer::reserve(size_t size)
+{
+	if (this->m_size > 0 || this->m_presized || size == 0) return;
+	this->m_data.resize(static_cast<int64_t>(size));
+	this->m_presized = true;
+	this->m_lengthChecked = true;
+}
+
+void CurlResponseBuffer::append(const uint8_t* data, size_t size)
+{
+	if (!this->m_lengthChecked) {
+		this->presize_from_content_length();
+	}
+
+	if (this->m_presized) {
+		// Compressed responses report the encoded length, grow geometrically if the decoded body is larger
+		const size_t required = this->m_size + size;
+		if (required > static_cast<size_t>(this->m_data.size())) {
+			this->m_data.resize(std::max(required, static_cast<size_t>(this->m_data.size()) * 2));
+		}
+		memcpy(this->m_data.ptrw() + this->m_size, data, size);
+		this->m_size = required;
+		return;
+	}
+
+	while (size > 0) {
+		const size_t slabOffset = this->m_size % SLAB_SIZE;
+		if (slabOffset == 0 && this->m_size / SLAB_SIZE == this->m_slabs.size()) {
+			this->m_slabs.emplace_back(acquire_slab());
+		}
+		const size_t toCopy = std::min(size, SLAB_SIZE - slabOffset);
+		memcpy(this->m_slabs.back().get() + slabOffset, data, toCopy);
+		this->m_size += toCopy;
+		data += toCopy;
+		size -= toCopy;
+	}
+}
+
+PackedByteArray CurlResponseBuffer::take()
+{
+	// Bodies shorter than any magic number never left the sniff buffer
+	if (!this->m_formatKnown && this->m_sniffSize > 0) {
+		this->m_formatKnown = true;
+		this->append(this->m_sniff, this->m_sniffSize);
+	}
+
+	PackedByteArray result;
+	if (this->m_presized) {
+		this->m_data.resize(this->m_size);
+		result = this->m_data;
+		this->m_data = PackedByteArray();
+	}
+	else if (this->m_size > 0) {
+		result.resize(this->m_size);
+		uint8_t* destination = result.ptrw();
+		size_t remaining = this->m_size;
+		for (const Slab_t& slab : this->m_slabs) {
+			const size_t toCopy = std::min(remaining, SLAB_SIZE);
+			memcpy(destination, slab.get(), toCopy);
+			destination += toCopy;
+			remaining -= toCopy;
+		}
+		this->release_slabs();
+	}
+	this->m_size = 0;
+	return result;
+}
+
+size_t CurlResponseBuffer::size() const
+{
+	return this->m_size;
+}
+
+size_t CurlResponseBuffer::write_callback(void* contents, size_t size, size_t nmemb, void* userp)
+{
+	auto* buffer = reinterpret_cast<CurlResponseBuffer*>(userp);
+	const size_t realSize = size * nmemb;
+	// Anything short of realSize makes curl fail the transfer with CURLE_WRITE_ERROR
+	if (!buffer->receive(reinterpret_cast<const uint8_t*>(contents), realSize)) {
+		buffer->m_decodeFailed = true;
+		return 0;
+	}
+	return realSize;
+}
+
+const CurlResponseBuffer::Headers_t& CurlResponseBuffer::get_headers() const
+{
+	return this->m_headers;
+}
+
+CurlResponseBuffer::Headers_t CurlResponseBuffer::take_headers()
+{
+	Headers_t headers = std::move(this->m_headers);
+	this->m_headers.clear();
+	return headers;
+}
+
+bool CurlResponseBuffer::has_decode_failed() const
+{
+	return this->m_decodeFailed;
+}
+
+int64_t CurlResponseBuffer::get_retry_after_ms() const
+{
+	auto it = this->m_headers.find("retry-after");
+	if (it == this->m_headers.end()) return -1;
+	const std::string& value = it->second;
+
+	// Either delay-seconds or an HTTP date
+	if (!value.empty() && value.size() <= 9 && std::all_of(value.begin(), value.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+		return std::stoll(value) * 1000;
+	}
+	const time_t retryAt = curl_getdate(value.c_str(), nullptr);
+	if (retryAt < 0) return -1;
+	return std::max<int64_t>(0, static_cast<int64_t>(retryAt - time(nullptr)) * 1000);
+}
+
+size_t CurlResponseBuffer::header_callback(char* buffer, size_t size, size_t nitems, void* userp)
+{
+	auto* responseBuffer = reinterpret_cast<CurlResponseBuffer*>(userp);
+	const size_t realSize = size * nitems;
+	responseBuffer->parse_header(buffer, realSize);
+	return realSize;
+}
+
+void CurlResponseBuffer::parse_header(const char* line, size_t length)
+{
+	// Redirects and interim responses deliver several header blocks, only the last one counts
+	if (length >= 5 && strncmp(line, "HTTP/", 5) == 0) {
+		this->m_headers.clear();
+		return;
+	}
+
+	const char* separator = static_cast<const char*>(memchr(line, ':', length));
+	if (separator == nullptr || separator == line) return;
+
+	std::string name(line, separator);
+	std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	std::string value(separator + 1, line + length);
+	const size_t first = value.find_first_not_of(" \t\r\n");
+	const size_t last = value.find_last_not_of(" \t\r\n");
+	value = first == std::string::npos ? std::string() : value.substr(first, last - first + 1);
+
+	auto [it, inserted] = this->m_headers.try_emplace(std::move(name), value);
+	if (!inserted) {
+		it->second += ", ";
+		it->second += value;
+	}
+}
+
+void CurlResponseBuffer::presize_from_content_length()
+{
+	this->m_lengthChecked = true;
+	if (this->m_curlHandle == nullptr) return;
+
+	curl_off_t contentLength = -1;
+	if (curl_easy_getinfo(this->m_curlHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength) != CURLE_OK || contentLength <= 0) {
+		return;
+	}
+	this->m_data.resize(static_cast<int64_t>(contentLength));
+	this->m_presized = true;
+}
+
+void CurlResponseBuffer::release_slabs()
+{
+	for (Slab_t& slab : this->m_slabs) {
+		recycle_slab(std::move(slab));
+	}
+	this->m_slabs.clear();
+}
+
+CurlResponseBuffer::Slab_t CurlResponseBuffer::acquire_slab()
+{
+	{
+		std::scoped_lock lock(s_slabPoolMutex);
+		if (!s_slabPool.empty()) {
+			Slab_t slab = std::move(s_slabPool.back());
+			s_slabPool.pop_back();
+			return slab;
+		}
+	}
+	return Slab_t(new uint8_t[SLAB_SIZE]);
+}
+
+void CurlResponseBuffer::recycle_slab(Slab_t&& slab)
+{
+	std::scoped_lock lock(s_slabPoolMutex);
+	if (s_slabPool.size() >= MAX_POOLED_SLABS) return;
+	s_slabPool.emplace_back(std::move(slab));
+}
@@ -0,0 +1,121 @@
+#ifndef CURL_RESPONSE_BUFFER_H
+#define CURL_RESPONSE_BUFFER_H
+
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/variant/packed_byte_array.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "core/variant/variant.h"
+#endif
+
+#include "CurlStreamDecoder.h"
+#include <curl/curl.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Collects a response body written by curl
+ * When the server sends a Content-Length the final array is allocated once and written in place.
+ * Otherwise (chunked transfers) the body is gathered in slabs borrowed from a process wide pool
+ * and copied once into an exactly sized array when the transfer is done.
+ * Bodies that are compressed as content (gzip / zstd magic) are decoded on the fly, see CurlStreamDecoder.
+ * Decoding happens inside curl's write callback, for transfers of the multi engine that is the client's single I/O thread,
+ * which is why the decoders stream with bounded scratch buffers instead of inflating whole bodies at once.
+ * The headers of the final response (after redirects) are captured as well, names lower cased
+ */
+class CurlResponseBuffer {
+public:
+	static constexpr size_t SLAB_SIZE = 256 * 1024;
+
+	/// @brief Header name (lower case) to value, repeated headers are joined with ", "
+	using Headers_t = std::map<std::string, std::string>;
+
+	CurlResponseBuffer() = default;
+
+	~CurlResponseBuffer();
+
+	CurlResponseBuffer(const CurlResponseBuffer&) = delete;
+
+	CurlResponseBuffer& operator=(const CurlResponseBuffer&) = delete;
+
+	/// @brief Prepares the buffer for a new transfer on the given handle
+	void reset(CURL* curlHandle);
+
+	/// @brief Raw bytes from curl, decoded first when the body turns out to be compressed. False when decoding failed
+	bool receive(const uint8_t* data, size_t size);
+
+	/// @brief Adds decoded bytes to the body
+	void append(const uint8_t* data, size_t size);
+
+	/// @brief Sizes the body up front when the final size is known (e.g. from a zstd frame header)
+	void reserve(size_t size);
+
+	/// @brief Hands out the body, the buffer is empty afterwards
+	PackedByteArray take();
+
+	size_t size() const;
+
+	const Headers_t& get_headers() const;
+
+	/// @brief Hands out the captured headers, the buffer keeps none afterwards
+	Headers_t take_headers();
+
+	/// @brief Whether the transfer was failed (CURLE_WRITE_ERROR) because its body could not be decoded
+	/// @note A truncated or corrupted compressed body is worth another try, unlike other write errors
+	bool has_decode_failed() const;
+
+	/// @brief Delay the server asked for through Retry-After, negative when it sent none
+	int64_t get_retry_after_ms() const;
+
+	/// @brief CURLOPT_WRITEFUNCTION, expects a CurlResponseBuffer as CURLOPT_WRITEDATA
+	static size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp);
+
+	/// @brief CURLOPT_HEADERFUNCTION, expects a CurlResponseBuffer as CURLOPT_HEADERDATA
+	static size_t header_callback(char* buffer, size_t size, size_t nitems, void* userp);
+
+private:
+	using Slab_t = std::unique_ptr<uint8_t[]>;
+
+	void presize_from_content_length();
+
+	bool start_decoding(const uint8_t* prefix, size_t size);
+
+	void parse_header(const char* line, size_t length);
+
+	void release_slabs();
+
+	static Slab_t acquire_slab();
+
+	static void recycle_slab(Slab_t&& slab);
+
+	CURL* m_curlHandle = nullptr;
+
+	PackedByteArray m_data;
+
+	size_t m_size = 0;
+
+	bool m_lengthChecked = false;
+
+	bool m_presized = false;
+
+	Headers_t m_headers;
+
+	/// @brief Null for plain bodies
+	std::unique_ptr<CurlStreamDecoder> m_decoder;
+
+	bool m_formatKnown = false;
+
+	bool m_decodeFailed = false;
+
+	/// @brief First bytes, only used when curl hands them over in pieces smaller than the magic numbers
+	uint8_t m_sniff[CurlStreamDecoder::SNIFF_SIZE] = {};
+
+	size_t m_sniffSize = 0;
+
+	std::vector<Slab_t> m_slabs;
+};
+
+#endif // !CURL_RESPONSE_BUFFER_H
@@ -0,0 +1,155 @@
+#include "CurlRetryPolicy.h"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <random>
+
+// Recent successful transfers the hedge threshold is computed from
+constexpr size_t LATENCY_WINDOW_SIZE = 256;
+// Below this many samples the percentile is too noisy to hedge on
+constexpr size_t MIN_LATENCY_SAMPLES = 32;
+// Backoff exponent cap, keeps the shift well defined for large retry counts
+constexpr int32_t MAX_BACKOFF_EXPONENT = 16;
+
+namespace {
+	std::mutex s_latencyMutex;
+	std::array<int64_t, LATENCY_WINDOW_SIZE> s_latencies{};
+	size_t s_latencyCount = 0;
+	size_t s_latencyCursor = 0;
+
+	int64_t random_up_to(int64_t maximum) {
+		thread_local std::mt19937_64 generator{ std::random_device{}() };
+		std::uniform_int_distribution<int64_t> distribution(0, std::max<int64_t>(0, maximum));
+		return distribution(generator);
+	}
+}
+
+bool CurlRetryPolicy::is_retryable(CURLcode code, long status, bool decodeFailed /*= false*/)
+{
+	switch (code) {
+		case CURLE_OK:
+			return status == 429 || (status >= 500 && status <= 599 && status != 501);
+		case CURLE_OPERATION_TIMEDOUT:
+		case CURLE_COULDNT_CONNECT:
+		case CURLE_COULDNT_RESOLVE_HOST:
+		case CURLE_SEND_ERROR:
+		case CURLE_RECV_ERROR:
+		case CURLE_GOT_NOTHING:
+		case CURLE_PARTIAL_FILE:
+		case CURLE_HTTP2:
+		case CURLE_HTTP2_STREAM:
+			return true;
+		case CURLE_WRITE_ERROR:
+			// A body cut short in transit fails to decode, a rejected write for any other reason would fail again
+			return decodeFailed;
+		default:
+			return false;
+	}
+}
+
+int64_t CurlRetryPolicy::compute_backoff_ms(int32_t retry, int64_t retryAfterMs)
+{
+	const int32_t exponent = std::clamp(retry - 1, 0, MAX_BACKOFF_EXPONENT);
+	const int64_t ceiling = std::min<int64_t>(static_cast<int64_t>(s_baseDelayMs.load()) << exponent, s_maxDelayMs.load());
+	// Full jitter, spreads the retries of tiles that failed together
+	const int64_t delay = random_up_to(ceiling);
+	// A Retry-After of hours would park the tile for good, the configured maximum wins
+	return std::max(delay, std::min<int64_t>(retryAfterMs, s_maxDelayMs.load()));
+}
+
+void CurlRetryPolicy::record_latency(int64_t latencyMs)
+{
+	std::scoped_lock lock(s_latencyMutex);
+	s_latencies[s_latencyCursor] = latencyMs;
+	s_latencyCursor = (s_latencyCursor + 1) % LATENCY_WINDOW_SIZE;
+	s_latencyCount = std::min(s_latencyCount + 1, LATENCY_WINDOW_SIZE);
+}
+
+int64_t CurlRetryPolicy::get_hedge_delay_ms()
+{
+	if (!s_hedgingEnabled.load()) return -1;
+
+	std::array<int64_t, LATENCY_WINDOW_SIZE> samples;
+	size_t sampleCount = 0;
+	{
+		std::scoped_lock lock(s_latencyMutex);
+		sampleCount = s_latencyCount;
+		std::copy_n(s_latencies.begin(), sampleCount, samples.begin());
+	}
+	if (sampleCount < MIN_LATENCY_SAMPLES) return -1;
+
+	const size_t rank = std::min(sampleCount - 1, static_cast<size_t>(s_hedgePercentile.load() * sampleCount));
+	std::nth_element(samples.begin(), samples.begin() + rank, samples.begin() + sampleCount);
+	return std::max<int64_t>(samples[rank], DEFAULT_HEDGE_MIN_DELAY_MS);
+}
+
+void CurlRetryPolicy::set_max_retries(int32_t retries)
+{
+	s_maxRetries = std::max(0, retries);
+}
+
+int32_t CurlRetryPolicy::get_max_retries()
+{
+	return s_maxRetries.load();
+}
+
+void CurlRetryPolicy::set_base_delay_ms(int32_t delay)
+{
+	s_baseDelayMs = std::max(1, delay);
+}
+
+int32_t CurlRetryPolicy::get_base_delay_ms()
+{
+	return s_baseDelayMs.load();
+}
+
+void CurlRetryPolicy::set_max_delay_ms(int32_t delay)
+{
+	s_maxDelayMs = std::max(1, delay);
+}
+
+int32_t CurlRetryPolicy::get_max_delay_ms()
+{
+	return s_maxDelayMs.load();
+}
+
+void CurlRetryPolicy::set_hedging_enabled(bool enabled)
+{
+	s_hedgingEnabled = enabled;
+}
+
+bool CurlRetryPolicy::is_hedging_enabled()
+{
+	return s_hedgingEnabled.load();
+}
+
+void CurlRetryPolicy::set_hedge_percentile(double percentile)
+{
+	s_hedgePercentile = std::clamp(percentile, 0.5, 0.999);
+}
+
+double CurlRetryPolicy::get_hedge_percentile()
+{
+	return s_hedgePercentile.load();
+}
+
+void CurlRetryPolicy::set_request_timeout_ms(int32_t timeout)
+{
+	s_requestTimeoutMs = std::max(0, timeout);
+}
+
+int32_t CurlRetryPolicy::get_request_timeout_ms()
+{
+	return s_requestTimeoutMs.load();
+}
+
+void CurlRetryPolicy::set_connect_timeout_ms(int32_t timeout)
+{
+	s_connectTimeoutMs = std::max(0, timeout);
+}
+
+int32_t CurlRetryPolicy::get_connect_timeout_ms()
+{
+	return s_connectTimeoutMs.load();
+}
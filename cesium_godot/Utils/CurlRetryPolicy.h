@@ -0,0 +1,76 @@
+#ifndef CURL_RETRY_POLICY_H
+#define CURL_RETRY_POLICY_H
+
+#include <curl/curl.h>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Process wide retry and hedging settings of the asynchronous curl clients
+ * Failed GET / HEAD transfers (5xx, 429, timeouts, dropped connections and bodies that failed to decode) are retried with
+ * exponential backoff and full jitter, a Retry-After sent by the server acts as the lower bound of the delay, up to the maximum delay.
+ * When hedging is enabled a GET that takes longer than the observed latency percentile gets a duplicate transfer,
+ * the first one to finish wins and the other one is cancelled
+ */
+class CurlRetryPolicy {
+public:
+	static constexpr int32_t DEFAULT_MAX_RETRIES = 3;
+	static constexpr int32_t DEFAULT_BASE_DELAY_MS = 200;
+	static constexpr int32_t DEFAULT_MAX_DELAY_MS = 10000;
+	static constexpr int32_t DEFAULT_HEDGE_MIN_DELAY_MS = 50;
+	static constexpr double DEFAULT_HEDGE_PERCENTILE = 0.95;
+
+	/// @brief decodeFailed tells a body that failed to decode apart from the other causes of CURLE_WRITE_ERROR
+	static bool is_retryable(CURLcode code, long status, bool decodeFailed = false);
+
+	/// @brief Delay before the given retry (1 based), retryAfterMs is what the server asked for or a negative value
+	/// @note Never more than the maximum delay, whatever the server asked for
+	static int64_t compute_backoff_ms(int32_t retry, int64_t retryAfterMs);
+
+	/// @brief Feeds the latency window hedging thresholds are computed from, only successful transfers should be recorded
+	static void record_latency(int64_t latencyMs);
+
+	/// @brief Delay after which a duplicate transfer should be started, negative when hedging is disabled or there is not enough data yet
+	static int64_t get_hedge_delay_ms();
+
+	static void set_max_retries(int32_t retries);
+
+	static int32_t get_max_retries();
+
+	static void set_base_delay_ms(int32_t delay);
+
+	static int32_t get_base_delay_ms();
+
+	static void set_max_delay_ms(int32_t delay);
+
+	static int32_t get_max_delay_ms();
+
+	static void set_hedging_enabled(bool enabled);
+
+	static bool is_hedging_enabled();
+
+	/// @brief Latency percentile (0-1) a transfer has to exceed before it is hedged
+	static void set_hedge_percentile(double percentile);
+
+	static double get_hedge_percentile();
+
+	/// @brief 0 disables the timeout, timed out transfers are retried like any other transient failure
+	static void set_request_timeout_ms(int32_t timeout);
+
+	static int32_t get_request_timeout_ms();
+
+	static void set_connect_timeout_ms(int32_t timeout);
+
+	static int32_t get_connect_timeout_ms();
+
+private:
+	static inline std::atomic<int32_t> s_maxRetries{ DEFAULT_MAX_RETRIES };
+	static inline std::atomic<int32_t> s_baseDelayMs{ DEFAULT_BASE_DELAY_MS };
+	static inline std::atomic<int32_t> s_maxDelayMs{ DEFAULT_MAX_DELAY_MS };
+	static inline std::atomic<bool> s_hedgingEnabled{ false };
+	static inline std::atomic<double> s_hedgePercentile{ DEFAULT_HEDGE_PERCENTILE };
+	static inline std::atomic<int32_t> s_requestTimeoutMs{ 0 };
+	static inline std::atomic<int32_t> s_connectTimeoutMs{ 10000 };
+};
+
+#endif // !CURL_RETRY_POLICY_H
@@ -0,0 +1,141 @@
+#include "CurlShareContext.h"
+
+#if defined(CESIUM_GD_EXT)
+#include "godot_cpp/core/error_macros.hpp"
+using namespace godot;
+#endif
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <shared_mutex>
+
+namespace {
+	std::mutex s_shareMutex;
+	CURLSH* s_shareHandle = nullptr;
+	int32_t s_shareUsers = 0;
+
+	// One lock per kind of shared data, curl asks for them independently
+	std::array<std::mutex, CURL_LOCK_DATA_LAST> s_dataLocks;
+
+	std::shared_mutex s_http2HostsMutex;
+	std::vector<std::string> s_http2Hosts;
+}
+
+void CurlShareContext::acquire()
+{
+	std::scoped_lock lock(s_shareMutex);
+	if (s_shareUsers++ > 0) return;
+
+	s_shareHandle = curl_share_init();
+	ERR_FAIL_NULL_MSG(s_shareHandle, "Could not create the curl share object, connections will not be shared");
+	curl_share_setopt(s_shareHandle, CURLSHOPT_LOCKFUNC, &CurlShareContext::lock_data);
+	curl_share_setopt(s_shareHandle, CURLSHOPT_UNLOCKFUNC, &CurlShareContext::unlock_data);
+	curl_share_setopt(s_shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	curl_share_setopt(s_shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	// Not the connection cache: a shared one is owned by whichever multi handle touched it last, HTTP/2 multiplexing
+	// and the per multi connection limits both break across I/O threads. Every client keeps its own warm connections
+}
+
+void CurlShareContext::release()
+{
+	std::scoped_lock lock(s_shareMutex);
+	if (--s_shareUsers > 0) return;
+	if (s_shareHandle != nullptr) {
+		curl_share_cleanup(s_shareHandle);
+		s_shareHandle = nullptr;
+	}
+}
+
+void CurlShareContext::apply_to_handle(CURL* easyHandle)
+{
+	std::scoped_lock lock(s_shareMutex);
+	if (s_shareHandle == nullptr) return;
+	curl_easy_setopt(easyHandle, CURLOPT_SHARE, s_shareHandle);
+}
+
+void CurlShareContext::apply_to_request(CURL* easyHandle, const char* url)
+{
+	if (is_http2_host(url)) {
+		curl_easy_setopt(easyHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+		// Wait for a connection that can multiplex instead of opening a new one right away
+		curl_easy_setopt(easyHandle, CURLOPT_PIPEWAIT, 1L);
+		return;
+	}
+	curl_easy_setopt(easyHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_NONE);
+	curl_easy_setopt(easyHandle, CURLOPT_PIPEWAIT, 0L);
+}
+
+void CurlShareContext::apply_to_multi(CURLM* multiHandle)
+{
+	curl_multi_setopt(multiHandle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+	curl_multi_setopt(multiHandle, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(s_maxConnectionsPerHost.load()));
+	curl_multi_setopt(multiHandle, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(s_maxTotalConnections.load()));
+}
+
+void CurlShareContext::set_http2_hosts(const std::vector<std::string>& hosts)
+{
+	std::unique_lock lock(s_http2HostsMutex);
+	s_http2Hosts = hosts;
+}
+
+std::vector<std::string> CurlShareContext::get_http2_hosts()
+{
+	std::shared_lock lock(s_http2HostsMutex);
+	return s_http2Hosts;
+}
+
+void CurlShareContext::set_max_connections_per_host(int32_t count)
+{
+	s_maxConnectionsPerHost = std::max(0, count);
+	s_settingsGeneration++;
+}
+
+int32_t CurlShareContext::get_max_connections_per_host()
+{
+	return s_maxConnectionsPerHost.load();
+}
+
+void CurlShareContext::set_max_total_connections(int32_t count)
+{
+	s_maxTotalConnections = std::max(0, count);
+	s_settingsGeneration++;
+}
+
+int32_t CurlShareContext::get_max_total_connections()
+{
+	return s_maxTotalConnections.load();
+}
+
+uint32_t CurlShareContext::get_settings_generation()
+{
+	return s_settingsGeneration.load();
+}
+
+bool CurlShareContext::is_http2_host(const char* url)
+{
+	std::shared_lock lock(s_http2HostsMutex);
+	if (s_http2Hosts.empty()) return false;
+	if (std::find(s_http2Hosts.begin(), s_http2Hosts.end(), "*") != s_http2Hosts.end()) return true;
+
+	CURLU* parsedUrl = curl_url();
+	char* host = nullptr;
+	bool isHttp2Host = false;
+	if (curl_url_set(parsedUrl, CURLUPART_URL, url, 0) == CURLUE_OK &&
+			curl_url_get(parsedUrl, CURLUPART_HOST, &host, 0) == CURLUE_OK) {
+		isHttp2Host = std::find(s_http2Hosts.begin(), s_http2Hosts.end(), host) != s_http2Hosts.end();
+	}
+	curl_free(host);
+	curl_url_cleanup(parsedUrl);
+	return isHttp2Host;
+}
+
+void CurlShareContext::lock_data(CURL* handle, curl_lock_data data, curl_lock_access access, void* userPtr)
+{
+	s_dataLocks[data].lock();
+}
+
+void CurlShareContext::unlock_data(CURL* handle, curl_lock_data data, void* userPtr)
+{
+	s_dataLocks[data].unlock();
+}
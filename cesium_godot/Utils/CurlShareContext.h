@@ -0,0 +1,67 @@
+#ifndef CURL_SHARE_CONTEXT_H
+#define CURL_SHARE_CONTEXT_H
+
+#include <curl/curl.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Process wide curl share object (DNS cache and TLS sessions)
+ * Every CurlHttpClient attaches its easy handles to it, so the tileset accessor, token troubleshooting and
+ * the document container all reuse the same resolved hosts and resume the same TLS sessions. Connections stay with
+ * the client's own multi handle
+ * @note Connection settings can be changed at any time, multi handles pick them up on their next poll. The limits apply
+ * to each multi handle (one per CurlHttpClient), a host can see up to the limit times the number of clients
+ */
+class CurlShareContext {
+public:
+	static constexpr int32_t DEFAULT_MAX_CONNECTIONS_PER_HOST = 32;
+
+	/// @brief Reference counted with the clients, the share object is created by the first one and freed by the last one
+	static void acquire();
+
+	static void release();
+
+	/// @brief Attaches a freshly created easy handle to the share object
+	static void apply_to_handle(CURL* easyHandle);
+
+	/// @brief Per request settings that depend on the host, currently HTTP/2 multiplexing
+	static void apply_to_request(CURL* easyHandle, const char* url);
+
+	/// @brief Connection limits of a multi handle, call again whenever get_settings_generation changes
+	static void apply_to_multi(CURLM* multiHandle);
+
+	/// @brief Hosts that should negotiate HTTP/2 and wait to multiplex over an existing connection, "*" matches every host
+	static void set_http2_hosts(const std::vector<std::string>& hosts);
+
+	static std::vector<std::string> get_http2_hosts();
+
+	/// @brief Per multi handle, 0 removes the limit
+	static void set_max_connections_per_host(int32_t count);
+
+	static int32_t get_max_connections_per_host();
+
+	/// @brief Per multi handle, 0 removes the limit
+	static void set_max_total_connections(int32_t count);
+
+	static int32_t get_max_total_connections();
+
+	static uint32_t get_settings_generation();
+
+private:
+	static bool is_http2_host(const char* url);
+
+	static void lock_data(CURL* handle, curl_lock_data data, curl_lock_access access, void* userPtr);
+
+	static void unlock_data(CURL* handle, curl_lock_data data, void* userPtr);
+
+	static inline std::atomic<int32_t> s_maxConnectionsPerHost{ DEFAULT_MAX_CONNECTIONS_PER_HOST };
+
+	static inline std::atomic<int32_t> s_maxTotalConnections{ 0 };
+
+	static inline std::atomic<uint32_t> s_settingsGeneration{ 0 };
+};
+
+#endif // !CURL_SHARE_CONTEXT_H
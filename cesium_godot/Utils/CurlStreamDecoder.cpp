@@ -0,0 +1,129 @@
+#include "CurlStreamDecoder.h"
+#include "CurlResponseBuffer.h"
+
+#include <zlib.h>
+#include <zstd.h>
+#include <algorithm>
+#include <array>
+
+// Decoded output is staged in chunks of this size before being appended to the response
+constexpr size_t DECODE_CHUNK_SIZE = 64 * 1024;
+// 15 bits of window plus 16 selects the gzip wrapper
+constexpr int GZIP_WINDOW_BITS = 15 + 16;
+
+constexpr std::array<uint8_t, 3> GZIP_MAGIC = { 0x1F, 0x8B, 0x08 };
+constexpr std::array<uint8_t, 4> ZSTD_MAGIC = { 0x28, 0xB5, 0x2F, 0xFD };
+
+struct CurlStreamDecoder::State_t {
+	z_stream zStream{};
+	bool zStreamReady = false;
+	bool gzipMemberEnded = false;
+	ZSTD_DStream* zstdStream = nullptr;
+	bool sizeHintApplied = false;
+	std::array<uint8_t, DECODE_CHUNK_SIZE> chunk;
+};
+
+CurlStreamDecoder::Format CurlStreamDecoder::detect(const uint8_t* prefix, size_t size)
+{
+	if (size >= GZIP_MAGIC.size() && std::equal(GZIP_MAGIC.begin(), GZIP_MAGIC.end(), prefix)) {
+		return Format::Gzip;
+	}
+	if (size >= ZSTD_MAGIC.size() && std::equal(ZSTD_MAGIC.begin(), ZSTD_MAGIC.end(), prefix)) {
+		return Format::Zstd;
+	}
+	return Format::Identity;
+}
+
+CurlStreamDecoder::CurlStreamDecoder(Format format) : m_format(format), m_state(std::make_unique<State_t>())
+{
+	if (format == Format::Gzip) {
+		this->m_state->zStreamReady = inflateInit2(&this->m_state->zStream, GZIP_WINDOW_BITS) == Z_OK;
+	}
+	else if (format == Format::Zstd) {
+		this->m_state->zstdStream = ZSTD_createDStream();
+		ZSTD_initDStream(this->m_state->zstdStream);
+	}
+}
+
+CurlStreamDecoder::~CurlStreamDecoder()
+{
+	if (this->m_state->zStreamReady) {
+		inflateEnd(&this->m_state->zStream);
+	}
+	ZSTD_freeDStream(this->m_state->zstdStream);
+}
+
+bool CurlStreamDecoder::write(const uint8_t* data, size_t size, CurlResponseBuffer& output)
+{
+	switch (this->m_format) {
+		case Format::Gzip:
+			return this->write_gzip(data, size, output);
+		case Format::Zstd:
+			return this->write_zstd(data, size, output);
+		default:
+			output.append(data, size);
+			return true;
+	}
+}
+
+CurlStreamDecoder::Format CurlStreamDecoder::get_format() const
+{
+	return this->m_format;
+}
+
+bool CurlStreamDecoder::write_gzip(const uint8_t* data, size_t size, CurlResponseBuffer& output)
+{
+	State_t& state = *this->m_state;
+	if (!state.zStreamReady) return false;
+
+	z_stream& stream = state.zStream;
+	stream.next_in = const_cast<Bytef*>(data);
+	stream.avail_in = static_cast<uInt>(size);
+	// Keep going while there is input left or the last chunk filled up (inflate may hold more output)
+	do {
+		if (state.gzipMemberEnded) {
+			if (stream.avail_in == 0) break;
+			// Concatenated gzip members are valid, start over on the next one
+			if (inflateReset(&stream) != Z_OK) return false;
+			state.gzipMemberEnded = false;
+		}
+		stream.next_out = state.chunk.data();
+		stream.avail_out = static_cast<uInt>(state.chunk.size());
+		const int result = inflate(&stream, Z_NO_FLUSH);
+		if (result == Z_STREAM_END) {
+			state.gzipMemberEnded = true;
+		}
+		else if (result != Z_OK && result != Z_BUF_ERROR) {
+			return false;
+		}
+		output.append(state.chunk.data(), state.chunk.size() - stream.avail_out);
+		if (result == Z_BUF_ERROR) break;
+	} while (stream.avail_in > 0 || stream.avail_out == 0);
+	return true;
+}
+
+bool CurlStreamDecoder::write_zstd(const uint8_t* data, size_t size, CurlResponseBuffer& output)
+{
+	State_t& state = *this->m_state;
+	if (state.zstdStream == nullptr) return false;
+
+	// Frames usually carry their decoded size, size the response exactly instead of growing it
+	if (!state.sizeHintApplied) {
+		state.sizeHintApplied = true;
+		const unsigned long long contentSize = ZSTD_getFrameContentSize(data, size);
+		if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN && contentSize != ZSTD_CONTENTSIZE_ERROR) {
+			output.reserve(static_cast<size_t>(contentSize));
+		}
+	}
+
+	ZSTD_inBuffer input{ data, size, 0 };
+	while (true) {
+		ZSTD_outBuffer chunk{ state.chunk.data(), state.chunk.size(), 0 };
+		const size_t result = ZSTD_decompressStream(state.zstdStream, &chunk, &input);
+		if (ZSTD_isError(result)) return false;
+		output.append(state.chunk.data(), chunk.pos);
+		// Done once the input is consumed and the decoder did not fill the whole chunk (nothing left buffered)
+		if (input.pos == input.size && chunk.pos < chunk.size) break;
+	}
+	return true;
+}
@@ -0,0 +1,55 @@
+#ifndef CURL_STREAM_DECODER_H
+#define CURL_STREAM_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class CurlResponseBuffer;
+
+/**
+ * @brief Decompresses a response body while it arrives, for payloads that are compressed as content
+ * (gzipped terrain and json stored pre-compressed on static hosts, zstd frames) rather than through Content-Encoding,
+ * which curl already decodes on its own. The decoded bytes go straight into the response buffer,
+ * so the compressed body is never held in full and GunzipAssetAccessor finds nothing left to inflate
+ */
+class CurlStreamDecoder {
+public:
+	enum class Format : uint8_t {
+		Identity,
+		Gzip,
+		Zstd
+	};
+
+	/// @brief Bytes needed to tell the formats apart
+	static constexpr size_t SNIFF_SIZE = 4;
+
+	/// @brief Identity when the first bytes of the body match no known magic number
+	static Format detect(const uint8_t* prefix, size_t size);
+
+	explicit CurlStreamDecoder(Format format);
+
+	~CurlStreamDecoder();
+
+	CurlStreamDecoder(const CurlStreamDecoder&) = delete;
+
+	CurlStreamDecoder& operator=(const CurlStreamDecoder&) = delete;
+
+	/// @brief Decodes a chunk into output, false if the stream is corrupt
+	bool write(const uint8_t* data, size_t size, CurlResponseBuffer& output);
+
+	Format get_format() const;
+
+private:
+	struct State_t;
+
+	bool write_gzip(const uint8_t* data, size_t size, CurlResponseBuffer& output);
+
+	bool write_zstd(const uint8_t* data, size_t size, CurlResponseBuffer& output);
+
+	Format m_format;
+
+	std::unique_ptr<State_t> m_state;
+};
+
+#endif // !CURL_STREAM_DECODER_H
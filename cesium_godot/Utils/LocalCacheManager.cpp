@@ -1,4 +1,179 @@
 #include "LocalCacheManager.h"
 
-void LocalCacheManager::write_render_resource(uint8_t *data, uint32_t size, size_t hashedId) {
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/resource_loader.hpp>
+#include <godot_cpp/classes/resource_saver.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+#elif defined(CESIUM_GD_MODULE)
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/resource_loader.h"
+#include "core/io/resource_saver.h"
+#endif
+
+#include <algorithm>
+#include <vector>
+
+// Bump whenever the layout of the converted meshes changes, older entries are then ignored and pruned away
+constexpr int64_t RENDER_CACHE_VERSION = 1;
+constexpr const char* VERSION_META = "cesium_render_cache_version";
+constexpr const char* KEY_META = "cesium_render_cache_key";
+constexpr const char* COLLISION_META = "cesium_render_cache_collision";
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+namespace {
+	uint64_t fnv1a(const uint8_t* data, size_t size, uint64_t hash)
+	{
+		for (size_t i = 0; i < size; i++) {
+			hash ^= data[i];
+			hash *= FNV_PRIME;
+		}
+		return hash;
+	}
+}
+
+uint64_t LocalCacheManager::compute_render_key(const std::string& url, std::span<const std::byte> content, const std::string& layout)
+{
+	// Separators keep shifting bytes from one part to the next from producing the same key
+	const uint8_t separator = 0;
+	uint64_t hash = fnv1a(reinterpret_cast<const uint8_t*>(url.data()), url.size(), FNV_OFFSET_BASIS);
+	hash = fnv1a(&separator, 1, hash);
+	hash = fnv1a(reinterpret_cast<const uint8_t*>(layout.data()), layout.size(), hash);
+	hash = fnv1a(&separator, 1, hash);
+	hash = fnv1a(reinterpret_cast<const uint8_t*>(content.data()), content.size(), hash);
+	// 0 is reserved for "not cacheable"
+	return hash == 0 ? 1 : hash;
+}
+
+Ref<ArrayMesh> LocalCacheManager::read_render_resource(uint64_t key, PackedVector3Array* outCollisionFaces)
+{
+	const String path = get_entry_path(key);
+	if (!FileAccess::file_exists(path)) return Ref<ArrayMesh>();
+
+	// Ignore the resource cache, in-memory reuse goes through CesiumTileMeshCache and its byte budget
+	Ref<ArrayMesh> mesh = ResourceLoader::get_singleton()->load(path, "ArrayMesh", ResourceLoader::CACHE_MODE_IGNORE);
+	if (mesh.is_null()) return Ref<ArrayMesh>();
+
+	const bool isCurrent = static_cast<int64_t>(mesh->get_meta(VERSION_META, -1)) == RENDER_CACHE_VERSION &&
+		static_cast<int64_t>(mesh->get_meta(KEY_META, 0)) == static_cast<int64_t>(key);
+	if (!isCurrent) return Ref<ArrayMesh>();
+
+	*outCollisionFaces = mesh->get_meta(COLLISION_META, PackedVector3Array());
+	mesh->remove_meta(VERSION_META);
+	mesh->remove_meta(KEY_META);
+	mesh->remove_meta(COLLISION_META);
+	return mesh;
+}
+
+void LocalCacheManager::write_render_resource(uint64_t key, const Ref<ArrayMesh>& mesh, const PackedVector3Array& collisionFaces)
+{
+	ERR_FAIL_COND(mesh.is_null());
+	const String directory = get_directory();
+	if (!DirAccess::dir_exists_absolute(directory)) {
+		DirAccess::make_dir_recursive_absolute(directory);
+	}
+
+	// The metadata rides along in the same file and is taken off again right away, the mesh is not in use yet
+	mesh->set_meta(VERSION_META, RENDER_CACHE_VERSION);
+	mesh->set_meta(KEY_META, static_cast<int64_t>(key));
+	if (collisionFaces.size() > 0) {
+		mesh->set_meta(COLLISION_META, collisionFaces);
+	}
+
+	const String path = get_entry_path(key);
+	// Concurrent loads of the same tile may race here, each one writes its own temporary file
+	static std::atomic<uint64_t> s_temporaryCounter{ 0 };
+	const String temporaryPath = path.get_basename() + "-" + String::num_uint64(s_temporaryCounter.fetch_add(1), 16) + ".tmp.res";
+	const Error err = ResourceSaver::get_singleton()->save(mesh, temporaryPath, ResourceSaver::FLAG_COMPRESS);
+
+	mesh->remove_meta(VERSION_META);
+	mesh->remove_meta(KEY_META);
+	mesh->remove_meta(COLLISION_META);
+
+	if (err != Error::OK) {
+		DirAccess::remove_absolute(temporaryPath);
+		ERR_PRINT(String("Could not write render cache entry ") + path + String(" error: ") + itos(err));
+		return;
+	}
+	if (DirAccess::rename_absolute(temporaryPath, path) != Error::OK) {
+		DirAccess::remove_absolute(temporaryPath);
+	}
+}
+
+void LocalCacheManager::prune_render_resources()
+{
+	if (s_pruned.exchange(true)) return;
+	const String cachePath = get_directory();
+	if (!DirAccess::dir_exists_absolute(cachePath)) return;
+
+	struct Entry_t {
+		String path;
+		uint64_t size;
+		uint64_t modifiedTime;
+	};
+
+	const PackedStringArray files = DirAccess::get_files_at(cachePath);
+	std::vector<Entry_t> entries;
+	entries.reserve(files.size());
+	uint64_t totalBytes = 0;
+	for (int64_t i = 0; i < files.size(); i++) {
+		const String path = cachePath.path_join(files[i]);
+		// Leftovers of writes interrupted by a crash or a kill
+		if (path.ends_with(".tmp.res")) {
+			DirAccess::remove_absolute(path);
+			continue;
+		}
+		Ref<FileAccess> file = FileAccess::open(path, FileAccess::READ);
+		if (file.is_null()) continue;
+		const uint64_t size = file->get_length();
+		entries.push_back({ path, size, FileAccess::get_modified_time(path) });
+		totalBytes += size;
+	}
+
+	const uint64_t maxBytes = s_maxRenderCacheBytes;
+	if (totalBytes <= maxBytes) return;
+
+	// Entries are never rewritten on a hit, so this evicts the ones written first
+	std::sort(entries.begin(), entries.end(), [](const Entry_t& a, const Entry_t& b) {
+		return a.modifiedTime < b.modifiedTime;
+	});
+	for (const Entry_t& entry : entries) {
+		if (totalBytes <= maxBytes) break;
+		if (DirAccess::remove_absolute(entry.path) == Error::OK) {
+			totalBytes -= entry.size;
+		}
+	}
+}
+
+void LocalCacheManager::set_max_render_cache_bytes(uint64_t bytes)
+{
+	s_maxRenderCacheBytes = bytes;
+}
+
+uint64_t LocalCacheManager::get_max_render_cache_bytes()
+{
+	return s_maxRenderCacheBytes;
+}
+
+void LocalCacheManager::set_directory(const String& directory)
+{
+	std::scoped_lock lock(s_directoryMutex);
+	if (s_directory == directory) return;
+	s_directory = directory;
+	s_pruned = false;
+}
+
+String LocalCacheManager::get_directory()
+{
+	std::scoped_lock lock(s_directoryMutex);
+	return s_directory;
+}
+
+String LocalCacheManager::get_entry_path(uint64_t key)
+{
+	return get_directory().path_join(String::num_uint64(key, 16) + ".res");
 }
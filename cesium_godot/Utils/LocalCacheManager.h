@@ -1,15 +1,66 @@
 #ifndef LOCAL_CACHE_MANAGER_H
 #define LOCAL_CACHE_MANAGER_H
 
+#if defined(CESIUM_GD_EXT)
+#include <godot_cpp/classes/array_mesh.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+using namespace godot;
+#elif defined(CESIUM_GD_MODULE)
+#include "scene/resources/mesh.h"
+#endif
+
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
 
+/**
+ * @brief Disk cache of tiles already converted to Godot resources (meshes, materials, textures and collision triangles)
+ * The request cache only holds the raw tile payloads, so a warm start would otherwise convert every tile again.
+ * Entries are keyed by tile URL and content hash, a tile that changed on the server simply misses
+ * @note Reads and writes happen on the tile load threads, every entry is written to a temporary file and renamed in place
+ */
 class LocalCacheManager {
 
 public:
-	void write_render_resource(uint8_t* data, uint32_t size, size_t hashedId);
+	/// @brief Used until a tileset derives the directory from the request cache path
+	static constexpr const char* DEFAULT_RENDER_CACHE_PATH = "user://cache/render";
+
+	static constexpr uint64_t DEFAULT_MAX_RENDER_CACHE_BYTES = 1024ull * 1024ull * 1024ull;
+
+	/// @brief layout identifies anything besides the payload that changes the conversion, e.g. the overlay texture coordinates cesium-native adds
+	static uint64_t compute_render_key(const std::string& url, std::span<const std::byte> content, const std::string& layout);
+
+	/// @brief Null on a miss, outCollisionFaces is left empty when the entry was written without collision
+	static Ref<ArrayMesh> read_render_resource(uint64_t key, PackedVector3Array* outCollisionFaces);
+
+	static void write_render_resource(uint64_t key, const Ref<ArrayMesh>& mesh, const PackedVector3Array& collisionFaces);
+
+	/// @brief Deletes the oldest entries until the cache fits in the byte budget, runs once per process
+	static void prune_render_resources();
+
+	static void set_max_render_cache_bytes(uint64_t bytes);
+
+	static uint64_t get_max_render_cache_bytes();
+
+	/// @brief Godot path of the directory holding the entries, a new directory is pruned again
+	static void set_directory(const String& directory);
+
+	static String get_directory();
 
 private:
+	static String get_entry_path(uint64_t key);
+
+	/// @brief Guards s_directory, entries are read and written from the tile load threads
+	static inline std::mutex s_directoryMutex;
+
+	static inline String s_directory = DEFAULT_RENDER_CACHE_PATH;
+
+	static inline std::atomic<uint64_t> s_maxRenderCacheBytes{ DEFAULT_MAX_RENDER_CACHE_BYTES };
 
+	static inline std::atomic<bool> s_pruned{ false };
 };
 
 #endif // LOCAL_CACHE_MANAGER_H
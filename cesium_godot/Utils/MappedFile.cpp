@@ -0,0 +1,142 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+namespace {
+	/// @brief Paths come in as UTF-8 (globalize_path), the ANSI file APIs would read them in the system code page
+	std::wstring to_wide_path(const std::string& path)
+	{
+		const int length = MultiByteToWideChar(CP_UTF8, 0, path.data(), static_cast<int>(path.size()), nullptr, 0);
+		if (length <= 0) return std::wstring();
+		std::wstring widePath(static_cast<size_t>(length), L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, path.data(), static_cast<int>(path.size()), widePath.data(), length);
+		return widePath;
+	}
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+	this->close();
+}
+
+bool MappedFile::open(const std::string& path)
+{
+	this->close();
+#ifdef _WIN32
+	// Writers append to and replace the file while it is mapped, share everything
+	const std::wstring widePath = to_wide_path(path);
+	if (widePath.empty()) return false;
+	HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+	this->m_fileHandle = file;
+	this->m_open = true;
+	if (fileSize.QuadPart == 0) return true;
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		this->close();
+		return false;
+	}
+	this->m_mappingHandle = mapping;
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		this->close();
+		return false;
+	}
+	this->m_data = static_cast<const std::byte*>(view);
+	this->m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	const int fileDescriptor = ::open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0) return false;
+	struct stat fileStat;
+	if (fstat(fileDescriptor, &fileStat) != 0) {
+		::close(fileDescriptor);
+		return false;
+	}
+	this->m_fileDescriptor = fileDescriptor;
+	this->m_open = true;
+	if (fileStat.st_size == 0) return true;
+
+	void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+	if (view == MAP_FAILED) {
+		this->close();
+		return false;
+	}
+	this->m_data = static_cast<const std::byte*>(view);
+	this->m_size = static_cast<size_t>(fileStat.st_size);
+#endif
+	return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (this->m_data != nullptr) {
+		UnmapViewOfFile(this->m_data);
+	}
+	if (this->m_mappingHandle != nullptr) {
+		CloseHandle(this->m_mappingHandle);
+		this->m_mappingHandle = nullptr;
+	}
+	if (this->m_fileHandle != nullptr) {
+		CloseHandle(this->m_fileHandle);
+		this->m_fileHandle = nullptr;
+	}
+#else
+	if (this->m_data != nullptr) {
+		munmap(const_cast<std::byte*>(this->m_data), this->m_size);
+	}
+	if (this->m_fileDescriptor >= 0) {
+		::close(this->m_fileDescriptor);
+		this->m_fileDescriptor = -1;
+	}
+#endif
+	this->m_data = nullptr;
+	this->m_size = 0;
+	this->m_open = false;
+}
+
+bool MappedFile::is_open() const
+{
+	return this->m_open;
+}
+
+std::span<const std::byte> MappedFile::get_bytes() const
+{
+	return std::span<const std::byte>(this->m_data, this->m_size);
+}
+
+void MappedFile::advise_will_need() const
+{
+	if (this->m_data == nullptr) return;
+#ifdef _WIN32
+#if _WIN32_WINNT >= 0x0602
+	WIN32_MEMORY_RANGE_ENTRY range{ const_cast<std::byte*>(this->m_data), this->m_size };
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+	posix_madvise(const_cast<std::byte*>(this->m_data), this->m_size, POSIX_MADV_WILLNEED);
+#endif
+}
+
+size_t MappedFile::size() const
+{
+	return this->m_size;
+}
@@ -0,0 +1,54 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ * The file may keep growing while it is mapped, bytes appended afterwards only become visible after mapping it again
+ */
+class MappedFile {
+public:
+	MappedFile() = default;
+
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/// @brief Maps the file as it is right now, closing any previous mapping first. Empty files are open but map nothing
+	bool open(const std::string& path);
+
+	/// @brief Has to be called before the file is truncated or replaced (Windows refuses both while a view is open)
+	void close();
+
+	bool is_open() const;
+
+	std::span<const std::byte> get_bytes() const;
+
+	/// @brief Asks the OS to start reading the mapped pages in, so the thread touching them later rarely faults on the disk
+	void advise_will_need() const;
+
+	size_t size() const;
+
+private:
+	const std::byte* m_data = nullptr;
+
+	size_t m_size = 0;
+
+	bool m_open = false;
+
+#ifdef _WIN32
+	void* m_fileHandle = nullptr;
+
+	void* m_mappingHandle = nullptr;
+#else
+	int m_fileDescriptor = -1;
+#endif
+};
+
+#endif // !MAPPED_FILE_H
@@ -6,12 +6,17 @@
 #include "Models/CesiumGDTileset.h"
 #include "Models/CesiumHTTPRequestNode.h"
 #include "Utils/CesiumDebugUtils.h"
+#include "Utils/CesiumNetwork.h"
 #include "Models/CesiumGlobe.h"
 #include "Models/CesiumGDRasterOverlay.h"
+#include "Models/CesiumGDUrlRasterOverlay.h"
 #include "Models/CesiumGDPanel.h"
 #include "Models/CesiumGDConfig.h"
+#include "Models/CesiumCacheSeeder.h"
 #include "Utils/CesiumGDAssetBuilder.h"
-#include "Utils/TokenTroubleShooting.h"		
+#include "Utils/TokenTroubleShooting.h"
+#include "Utils/CesiumOverlayMaterial.h"
+#include "Utils/CesiumTileMeshCache.h"		
 #include "godot_cpp/classes/engine.hpp"
 #include <cstdio>
 
@@ -35,13 +40,20 @@ void initialize_cesium_godot_module(ModuleInitializationLevel p_level) {
 	ClassDB::register_class<Cesium3DTileset>();
 	ClassDB::register_class<CesiumHTTPRequestNode>();
 	ClassDB::register_class<CesiumDebugUtils>();
+	ClassDB::register_class<CesiumNetwork>();
 	ClassDB::register_class<CesiumGDPanel>();
+	ClassDB::register_abstract_class<CesiumRasterOverlay>();
 	ClassDB::register_class<CesiumIonRasterOverlay>();
+	ClassDB::register_abstract_class<CesiumUrlRasterOverlay>();
+	ClassDB::register_class<CesiumUrlTemplateRasterOverlay>();
+	ClassDB::register_class<CesiumTileMapServiceRasterOverlay>();
+	ClassDB::register_class<CesiumWebMapTileServiceRasterOverlay>();
 	ClassDB::register_class<CesiumGDConfig>();
 	ClassDB::register_class<DocumentContainer>();
 	ClassDB::register_class<CesiumGDAssetBuilder>();
 	ClassDB::register_class<TokenTroubleshooting>();
 	ClassDB::register_class<Cesium3DTile>();
+	ClassDB::register_class<CesiumCacheSeeder>();
 	
 	ClassDB::register_class<CesiumGDCreditSystem>(true);
 	ClassDB::bind_integer_constant("CesiumGeoreference", "OriginType", "CartographicOrigin", (int32_t)CesiumGeoreference::OriginType::CartographicOrigin);
@@ -49,7 +61,11 @@ void initialize_cesium_godot_module(ModuleInitializationLevel p_level) {
 }
 
 void uninitialize_cesium_godot_module(ModuleInitializationLevel p_level) {
-	//Hey there, hello, we don't do anything here actually
+	if (p_level != ModuleInitializationLevel::MODULE_INITIALIZATION_LEVEL_SCENE)
+		return;
+	// Cached tile meshes and overlay shaders are engine resources, release them while the engine is still up
+	CesiumTileMeshCache::clear();
+	CesiumOverlayMaterial::release();
 }
 
 extern "C" {